@@ -2,23 +2,290 @@
 
 /* Retrieving values from number structs */
 inline int GetInt(VyNumber** num){
-	return ((IntNum*) NumberToSubtype(num))->i;	
+	return ((IntNum*) NumberToSubtype(num))->i;
 }
 inline double GetDouble(VyNumber** num){
-	return ((RealNum*) NumberToSubtype(num))->d;	
+	return ((RealNum*) NumberToSubtype(num))->d;
 }
 inline VyNumber** GetImaginary(VyNumber** num){
-	return ((ComplexNum*) NumberToSubtype(num))->imaginary;	
+	return ((ComplexNum*) NumberToSubtype(num))->imaginary;
 }
 inline VyNumber** GetReal(VyNumber** num){
 	return ((ComplexNum*) NumberToSubtype(num))->real;
 }
-inline int GetDenominator(VyNumber** num){
-	return ((RatioNum*) NumberToSubtype(num))->denominator;	
+inline VyNumber** GetDenominator(VyNumber** num){
+	return ((RatioNum*) NumberToSubtype(num))->denominator;
 }
-inline int GetNumerator(VyNumber** num){
+inline VyNumber** GetNumerator(VyNumber** num){
 	return ((RatioNum*) NumberToSubtype(num))->numerator;
 }
+inline BigIntNum* GetBigInt(VyNumber** num){
+	return (BigIntNum*) NumberToSubtype(num);
+}
+
+/* Whether a number is an integer (fixnum or bignum) */
+int IsInteger(VyNumber** num){
+	return (num[0]->type == INT || num[0]->type == BIGINT);
+}
+
+/* Convert any non-complex number to a double */
+double NumberToDouble(VyNumber** num){
+	switch(num[0]->type){
+		case INT:
+			return (double)(GetInt(num));
+		case REAL:
+			return GetDouble(num);
+		case BIGINT:
+			return BigToDouble(GetBigInt(num));
+		case RATIO:
+			return NumberToDouble(GetNumerator(num)) / NumberToDouble(GetDenominator(num));
+		default:
+			return 0;
+	}
+}
+
+/***** Exact integer arithmetic. Fixnum operands are done with machine arithmetic, and only fall back to bignums on overflow *****/
+
+/* View any integer as a bignum; fixnums use the given limb as storage, so nothing is allocated */
+static void IntegerToBig(VyNumber** num, BigIntNum* big, VyLimb* limb){
+	if(num[0]->type == INT){
+		BigFromIntView(big, GetInt(num), limb);
+	}
+	else{
+		*big = *GetBigInt(num);
+	}
+}
+
+/* The sign of an integer: -1, 0, or 1 */
+int IntegerSign(VyNumber** num){
+	if(num[0]->type == INT){
+		int i = GetInt(num);
+		return (i > 0) - (i < 0);
+	}
+	return GetBigInt(num)->sign;
+}
+
+/* Add two integers */
+VyNumber** IntegerAdd(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		return CreateInteger((long long)(GetInt(one)) + GetInt(two));
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig, result;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	BigAdd(&result, &oneBig, &twoBig);
+	return CreateIntegerFromBig(&result);
+}
+
+/* Subtract two integers */
+VyNumber** IntegerSubtract(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		return CreateInteger((long long)(GetInt(one)) - GetInt(two));
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig, result;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	BigSubtract(&result, &oneBig, &twoBig);
+	return CreateIntegerFromBig(&result);
+}
+
+/* Multiply two integers (the product of two fixnums always fits in a long long) */
+VyNumber** IntegerMultiply(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		return CreateInteger((long long)(GetInt(one)) * GetInt(two));
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig, result;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	BigMultiply(&result, &oneBig, &twoBig);
+	return CreateIntegerFromBig(&result);
+}
+
+/* Truncating integer division (the divisor must not be zero) */
+VyNumber** IntegerQuotient(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		return CreateInteger((long long)(GetInt(one)) / GetInt(two));
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig, result;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	BigDivMod(&result, NULL, &oneBig, &twoBig);
+	return CreateIntegerFromBig(&result);
+}
+
+/* The greatest common divisor of two integers (always non-negative) */
+VyNumber** IntegerGcd(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		long long a = GetInt(one);
+		long long b = GetInt(two);
+		return CreateInteger(BinaryGcd(a < 0 ? -a : a, b < 0 ? -b : b));
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig, result;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	BigGcd(&result, &oneBig, &twoBig);
+	return CreateIntegerFromBig(&result);
+}
+
+/* Compare two integers */
+int IntegerCompare(VyNumber** one, VyNumber** two){
+	if(one[0]->type == INT && two[0]->type == INT){
+		int a = GetInt(one);
+		int b = GetInt(two);
+		return (a > b) - (a < b);
+	}
+
+	VyLimb oneLimb, twoLimb;
+	BigIntNum oneBig, twoBig;
+	IntegerToBig(one, &oneBig, &oneLimb);
+	IntegerToBig(two, &twoBig, &twoLimb);
+	return BigCompare(&oneBig, &twoBig);
+}
+
+/* Negate an integer (negating the smallest fixnum overflows into a bignum) */
+VyNumber** IntegerNegate(VyNumber** num){
+	if(num[0]->type == INT){
+		return CreateInteger(-(long long)(GetInt(num)));
+	}
+
+	BigIntNum result;
+	BigCopy(&result, GetBigInt(num));
+	result.sign = -result.sign;
+	return CreateIntegerFromBig(&result);
+}
+
+/***** Exact ratio arithmetic. An integer behaves as a ratio with a denominator of one *****/
+
+/* If a number is a fixnum or a ratio of fixnums, find its numerator and denominator */
+static int SmallRatioParts(VyNumber** num, long long* numerator, long long* denominator){
+	if(num[0]->type == INT){
+		*numerator = GetInt(num);
+		*denominator = 1;
+		return 1;
+	}
+	if(num[0]->type == RATIO && GetNumerator(num)[0]->type == INT && GetDenominator(num)[0]->type == INT){
+		*numerator = GetInt(GetNumerator(num));
+		*denominator = GetInt(GetDenominator(num));
+		return 1;
+	}
+	return 0;
+}
+
+/* Find the numerator and denominator of any integer or ratio */
+static void RatioParts(VyNumber** num, VyNumber*** numerator, VyNumber*** denominator){
+	if(num[0]->type == RATIO){
+		*numerator = GetNumerator(num);
+		*denominator = GetDenominator(num);
+	}
+	else{
+		*numerator = num;
+		*denominator = CreateInt(1);
+	}
+}
+
+/* Add two ratios: a/b + c/d = (ad + cb)/bd */
+VyNumber** RatioAdd(VyNumber** one, VyNumber** two){
+	/* With fixnum parts, every intermediate value stays below 2^63 */
+	long long a, b, c, d;
+	if(SmallRatioParts(one, &a, &b) && SmallRatioParts(two, &c, &d)){
+		return CreateRatioFromLongs(a * d + c * b, b * d);
+	}
+
+	VyNumber** oneNumerator;
+	VyNumber** oneDenominator;
+	VyNumber** twoNumerator;
+	VyNumber** twoDenominator;
+	RatioParts(one, &oneNumerator, &oneDenominator);
+	RatioParts(two, &twoNumerator, &twoDenominator);
+
+	VyNumber** numerator = IntegerAdd(IntegerMultiply(oneNumerator, twoDenominator), IntegerMultiply(twoNumerator, oneDenominator));
+	VyNumber** denominator = IntegerMultiply(oneDenominator, twoDenominator);
+	return CreateRatio(numerator, denominator);
+}
+
+/* Multiply two ratios: (a/b)(c/d) = ac/bd */
+VyNumber** RatioMultiply(VyNumber** one, VyNumber** two){
+	long long a, b, c, d;
+	if(SmallRatioParts(one, &a, &b) && SmallRatioParts(two, &c, &d)){
+		return CreateRatioFromLongs(a * c, b * d);
+	}
+
+	VyNumber** oneNumerator;
+	VyNumber** oneDenominator;
+	VyNumber** twoNumerator;
+	VyNumber** twoDenominator;
+	RatioParts(one, &oneNumerator, &oneDenominator);
+	RatioParts(two, &twoNumerator, &twoDenominator);
+
+	return CreateRatio(IntegerMultiply(oneNumerator, twoNumerator), IntegerMultiply(oneDenominator, twoDenominator));
+}
+
+/* Divide two ratios: (a/b)/(c/d) = ad/bc (the divisor must not be zero) */
+VyNumber** RatioDivide(VyNumber** one, VyNumber** two){
+	long long a, b, c, d;
+	if(SmallRatioParts(one, &a, &b) && SmallRatioParts(two, &c, &d)){
+		return CreateRatioFromLongs(a * d, b * c);
+	}
+
+	VyNumber** oneNumerator;
+	VyNumber** oneDenominator;
+	VyNumber** twoNumerator;
+	VyNumber** twoDenominator;
+	RatioParts(one, &oneNumerator, &oneDenominator);
+	RatioParts(two, &twoNumerator, &twoDenominator);
+
+	return CreateRatio(IntegerMultiply(oneNumerator, twoDenominator), IntegerMultiply(oneDenominator, twoNumerator));
+}
+
+/* Compare two ratios by cross multiplying (denominators are always positive) */
+int RatioCompare(VyNumber** one, VyNumber** two){
+	long long a, b, c, d;
+	if(SmallRatioParts(one, &a, &b) && SmallRatioParts(two, &c, &d)){
+		long long left = a * d;
+		long long right = c * b;
+		return (left > right) - (left < right);
+	}
+
+	VyNumber** oneNumerator;
+	VyNumber** oneDenominator;
+	VyNumber** twoNumerator;
+	VyNumber** twoDenominator;
+	RatioParts(one, &oneNumerator, &oneDenominator);
+	RatioParts(two, &twoNumerator, &twoDenominator);
+
+	return IntegerCompare(IntegerMultiply(oneNumerator, twoDenominator), IntegerMultiply(twoNumerator, oneDenominator));
+}
+
+/* Compare two non-complex numbers. Exact numbers are compared exactly, and reals as doubles */
+int CompareNumbers(VyNumber** one, VyNumber** two){
+	int typeOne = one[0]->type;
+	int typeTwo = two[0]->type;
+
+	if(typeOne == INT && typeTwo == INT){
+		int a = GetInt(one);
+		int b = GetInt(two);
+		return (a > b) - (a < b);
+	}
+	if(typeOne == REAL || typeTwo == REAL){
+		double a = NumberToDouble(one);
+		double b = NumberToDouble(two);
+		return (a > b) - (a < b);
+	}
+	if(typeOne == RATIO || typeTwo == RATIO){
+		return RatioCompare(one, two);
+	}
+	return IntegerCompare(one, two);
+}
 
 /* Clone a number */
 VyNumber** CloneNumber(VyNumber** num){
@@ -29,6 +296,14 @@ VyNumber** CloneNumber(VyNumber** num){
 			return CreateReal(GetDouble(num));
 		case COMPLEX:
 			return CreateComplex(CloneNumber(GetReal(num)), CloneNumber(GetImaginary(num)));
+		case RATIO:
+			return CreateRatio(GetNumerator(num), GetDenominator(num));
+		case BIGINT:
+			{
+				BigIntNum copy;
+				BigCopy(&copy, GetBigInt(num));
+				return CreateIntegerFromBig(&copy);
+			}
 		default:
 			return NULL;
 	}
@@ -37,30 +312,28 @@ VyNumber** CloneNumber(VyNumber** num){
 /* Negate a number */
 VyNumber** NegateNumber(VyNumber** num){
 	/* Use the number type to decide what to do */
-	num = CloneNumber(num);
-	
 	int numType = num[0]->type;
 
-	/* Negate the number */
-	if(numType == INT){
-		IntNum* i = NumberToSubtype(num);
-		i->i *= -1;	
+	if(numType == INT || numType == BIGINT){
+		return IntegerNegate(num);
 	}
 	if(numType == REAL){
-		RealNum* rNum = NumberToSubtype(num);
-		rNum->d *= -1;	
+		return CreateReal(-GetDouble(num));
 	}
 	if(numType == COMPLEX){
-		ComplexNum* cNum = NumberToSubtype(num);
-		cNum->real = NegateNumber(GetReal(num));	
-		cNum->imaginary = NegateNumber(GetImaginary(num));	
+		return CreateComplex(NegateNumber(GetReal(num)), NegateNumber(GetImaginary(num)));
 	}
 	if(numType == RATIO){
-		RatioNum* ratNum = NumberToSubtype(num);
-		ratNum->numerator *= -1;	
+		/* The ratio is already in lowest terms, so only the numerator needs to change */
+		VyNumber** numerator = IntegerNegate(GetNumerator(num));
+		VyNumber** ratio = CreateNumber(RATIO);
+		RatioNum* ratNum = NumberToSubtype(ratio);
+		ratNum->numerator = numerator;
+		ratNum->denominator = GetDenominator(num);
+		return ratio;
 	}
 
-	return num;
+	return NULL;
 }
 
 /* Check whether the number equals 0 */
@@ -69,21 +342,22 @@ int EqualsZero(VyNumber** num){
 	if((num[0]->type == INT     && GetInt(num)       == 0)
 			||(num[0]->type == REAL    && GetDouble(num)    == 0)
 			||(num[0]->type == COMPLEX && EqualsZero(GetReal(num)) && EqualsZero(GetImaginary(num)))
-			||(num[0]->type == RATIO   && GetNumerator(num) == 0)){ 
-		return 1;	
+			||(num[0]->type == RATIO   && EqualsZero(GetNumerator(num)))
+			||(num[0]->type == BIGINT  && GetBigInt(num)->sign == 0)){
+		return 1;
 	}
 	else {
-		return 0;	
+		return 0;
 	}
 }
 
 /* Reduce a number to its best type (i.e. no complex numbers with 0i, no doubles with 0's after the decimal point, etc */
 void ReduceNumber(VyNumber** num){
-	/* Check that, if it is a double, it isnt an int in disguise */
+	/* Check that, if it is a double, it isnt an int in disguise (that also fits in an int) */
 	if(num[0]->type == REAL){
 		double d = GetDouble(num);
 		/* If it is, change it to an int */
-		if(d == (int)(d)){
+		if(d >= -2147483648.0 && d <= 2147483647.0 && d == (int)(d)){
 			num[0]->type = INT;
 
 			IntNum* iNum = NumberToSubtype(num);
@@ -94,7 +368,7 @@ void ReduceNumber(VyNumber** num){
 	/* Check that, if it is a complex number, the imaginary part isn't 0 */
 	else if(num[0]->type == COMPLEX){
 		if(EqualsZero(GetImaginary(num))){
-			/* Make it equal the real part */
+			/* Make it equal the real part (all the other number types fit into the space of a complex number) */
 			VyNumber** realPart = GetReal(num);
 			num[0]->type = realPart[0]->type;
 
@@ -105,16 +379,22 @@ void ReduceNumber(VyNumber** num){
 				case REAL:
 					((RealNum*)(NumberToSubtype(num)))->d = GetDouble(realPart);
 					break;
+				case RATIO:
+					*((RatioNum*)(NumberToSubtype(num))) = *((RatioNum*)(NumberToSubtype(realPart)));
+					break;
+				case BIGINT:
+					*((BigIntNum*)(NumberToSubtype(num))) = *GetBigInt(realPart);
+					break;
 			}
 
-			
+
 		}
 	}
 }
 
 /* A utility function for multiplying two numbers known to be complex */
 VyNumber** MultiplyComplexNumbers(VyNumber** c1, VyNumber** c2){
-	/* Multiplying complex numbers: 
+	/* Multiplying complex numbers:
 	 *   (a + bi)(x + yi) =
 	 * = ax + ayi + xbi + byi^2
 	 * = ax - by + ayi + xbi
@@ -138,7 +418,7 @@ VyNumber** MultiplyComplexNumbers(VyNumber** c1, VyNumber** c2){
 
 /* Get the complex conjugate of a number */
 VyNumber** ComplexConjugate(VyNumber** num){
-	VyNumber** conjugate = CreateComplex(GetReal(num), NegateNumber(GetImaginary(num)));	
+	VyNumber** conjugate = CreateComplex(GetReal(num), NegateNumber(GetImaginary(num)));
 	return conjugate;
 }
 
@@ -163,7 +443,7 @@ VyNumber** DivideByComplex(VyNumber** one, VyNumber** two){
 
 /* Raise a complex number to a power */
 VyNumber** ComplexExponent(VyNumber** cmplex, VyNumber** exp){
-	/* Not yet implemented  */		
+	/* Not yet implemented  */
 	return NULL;
 }
 
@@ -172,75 +452,53 @@ VyNumber** AddNumbers(VyNumber** one, VyNumber** two){
 	/* Type conversions (in order of precedence):
 	 * 	Complex + Anything = Complex, unless imaginary part = 0
 	 * 	Real + Anything = Real
-	 * 	Ratio + Ratio or Ratio + Int = Ratio
-	 * 	Int + Anything = Anything
+	 * 	Ratio + Ratio or Ratio + Int = Ratio, unless the result is an integer
+	 * 	Int + Int = Int (promoted to a bignum if it overflows)
 	 */
 
 	int typeOne = one[0]->type;
 	int typeTwo = two[0]->type;
 
-	VyNumber** num;
+	/* The common case of two fixnums comes first */
+	if(typeOne == INT && typeTwo == INT){
+		return CreateInteger((long long)(GetInt(one)) + GetInt(two));
+	}
 
-	/* Use the number's types to decide what to do */
-	if(typeOne == INT){
-		int oneInt = GetInt(one);
-		switch(typeTwo){
-			case INT:	
-				/* Int + Int = Int */
-				num = CreateInt(oneInt + GetInt(two));
-				break;
-			case REAL:
-				/* Int + Real = Real */
-				num = CreateReal(oneInt + GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Int + Complex = Complex */
-				num = CreateComplex(AddNumbers(one, GetReal(two)), GetImaginary(two));	
-				break;
-		}
+	/* If both are complex, add the real and imaginary parts */
+	if(typeOne == COMPLEX && typeTwo == COMPLEX){
+		/* Complex + Complex = Complex */
+		return CreateComplex(AddNumbers(GetReal(one), GetReal(two)), AddNumbers(GetImaginary(one), GetImaginary(two)));
+	}
 
+	/* If only one of them is complex, then add the other one to the real part of the complex number */
+	if(typeOne == COMPLEX){
+		return CreateComplex(AddNumbers(GetReal(one), two), GetImaginary(one));
 	}
-	else if(typeOne == REAL){
-		double oneDouble = GetDouble(one);
-		switch(typeTwo){
-			case INT:	
-				/* Real + Int = Real */
-				num = CreateReal(oneDouble + GetInt(two));
-				break;
-			case REAL:
-				/* Real + Real = Real */
-				num = CreateReal(oneDouble + GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Real + Complex = Real */
-				num = CreateComplex(AddNumbers(one, GetReal(two)), GetImaginary(two));	
-				break;
-		}		
-	}
-	else if(typeOne == COMPLEX){
-		VyNumber** oneReal = GetReal(one);
-		VyNumber** oneImaginary = GetImaginary(one);
-		switch(typeTwo){
-			/* If both are complex, add the real and imaginary parts */
-			case COMPLEX:
-				/* Complex + Complex = Complex */
-				num = CreateComplex(AddNumbers(oneReal, GetReal(two)), AddNumbers(oneImaginary, GetImaginary(two)));	
-				break;
-				/* If only the first one is complex, then add the second one to the real part of the complex number */
-			case INT:	
-			case REAL:
-				/* Complex + (Int|Real) = Complex */
-				num = CreateComplex(AddNumbers(oneReal, two), oneImaginary);
-				break;
-		}	
+	if(typeTwo == COMPLEX){
+		return CreateComplex(AddNumbers(one, GetReal(two)), GetImaginary(two));
 	}
 
-	return num;
+	/* Real + Anything = Real */
+	if(typeOne == REAL || typeTwo == REAL){
+		return CreateReal(NumberToDouble(one) + NumberToDouble(two));
+	}
+
+	/* Ratio + (Ratio|Int) = Ratio */
+	if(typeOne == RATIO || typeTwo == RATIO){
+		return RatioAdd(one, two);
+	}
+
+	return IntegerAdd(one, two);
 }
 
 /* Subtract two numbers */
 VyNumber** SubtractNumbers(VyNumber** one, VyNumber** two){
-	/* Just add the first number and the negated second number */	
+	/* Avoid creating the negated number for the common case of fixnums */
+	if(one[0]->type == INT && two[0]->type == INT){
+		return CreateInteger((long long)(GetInt(one)) - GetInt(two));
+	}
+
+	/* Otherwise, just add the first number and the negated second number */
 	return AddNumbers(one, NegateNumber(two));
 }
 
@@ -249,61 +507,44 @@ VyNumber** MultiplyNumbers(VyNumber** one, VyNumber** two){
 	/* Type conversions (in order of precedence):
 	 * 	Complex * Anything = Complex, unless imaginary part = 0
 	 * 	Real * Anything = Real
-	 * 	Ratio * Ratio or Ratio * Int = Ratio
-	 * 	Int * Anything = Anything
+	 * 	Ratio * Ratio or Ratio * Int = Ratio, unless the result is an integer
+	 * 	Int * Int = Int (promoted to a bignum if it overflows)
 	 */
 
 	int oneType = one[0]->type;
 	int twoType = two[0]->type;
 
+	/* The common case of two fixnums comes first */
+	if(oneType == INT && twoType == INT){
+		return CreateInteger((long long)(GetInt(one)) * GetInt(two));
+	}
+
 	VyNumber** num;
 
 	/* Determine what to do based on the types of the numbers */
-	if(oneType == INT){
-		switch(twoType){
-			case INT:
-				/* Int * Int = Int */
-				num = CreateInt(GetInt(one) * GetInt(two));
-				break;
-			case REAL:
-				/* Int * Real = Real */
-				num = CreateReal(GetInt(one) * GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Int * Complex = Complex */
-				num = CreateComplex(MultiplyNumbers(one, GetReal(two)), MultiplyNumbers(one, GetImaginary(two)));
-				break;
-		}
-	}
-	else if(oneType == REAL){
-		switch(twoType){
-			case INT:
-				/* Real * Int = Real */
-				num = CreateReal(GetDouble(one) * GetInt(two));
-				break;
-			case REAL:
-				/* Real * Real = Real */
-				num = CreateReal(GetDouble(one) * GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Real * Complex = Complex */
-				num = CreateComplex(MultiplyNumbers(one, GetReal(two)), MultiplyNumbers(one, GetImaginary(two)));
-				break;
-		}
+	if(oneType == COMPLEX && twoType == COMPLEX){
+		/* Call the utility function */
+		/* Complex * Complex = Complex */
+		num = MultiplyComplexNumbers(one, two);
 	}
 	else if(oneType == COMPLEX){
-		switch(twoType){
-			case INT:
-			case REAL:
-				/* (Int|Real) * Complex = Complex */
-				num = CreateComplex(MultiplyNumbers(GetReal(one), two), MultiplyNumbers(GetImaginary(one), two));
-				break;
-			case COMPLEX:
-				/* Call the utility function */
-				/* Complex * Complex = Complex */
-				num = MultiplyComplexNumbers(one, two);
-				break;
-		}
+		/* Complex * Anything = Complex */
+		num = CreateComplex(MultiplyNumbers(GetReal(one), two), MultiplyNumbers(GetImaginary(one), two));
+	}
+	else if(twoType == COMPLEX){
+		/* Anything * Complex = Complex */
+		num = CreateComplex(MultiplyNumbers(one, GetReal(two)), MultiplyNumbers(one, GetImaginary(two)));
+	}
+	else if(oneType == REAL || twoType == REAL){
+		/* Real * Anything = Real */
+		num = CreateReal(NumberToDouble(one) * NumberToDouble(two));
+	}
+	else if(oneType == RATIO || twoType == RATIO){
+		/* Ratio * (Ratio|Int) = Ratio */
+		num = RatioMultiply(one, two);
+	}
+	else{
+		num = IntegerMultiply(one, two);
 	}
 
 	/* Multiplication may induce some wrong types, so reduce the number to its best type: */
@@ -319,59 +560,36 @@ VyNumber** DivideNumbers(VyNumber** one, VyNumber** two){
 	 * 	Complex / Anything = Complex, unless imaginary part = 0
 	 * 	Real / Anything = Real
 	 * 	Ratio / Ratio or Ratio / Int = Ratio
-	 * 	Int / Int = Ratio
-	 * 	Int / Anything = Real
+	 * 	Int / Int = Ratio (or an Int, if the division is exact)
+	 *
+	 * Dividing an exact number by an exact zero is an error, which the caller must check for.
 	 */
-	
+
 	int oneType = one[0]->type;
 	int twoType = two[0]->type;
-	
+
 	VyNumber** num;
 
 	/* Determine what to do based on the types of the numbers */
-	if(oneType == INT){
-		switch(twoType){
-			case INT:
-				/* Int / Int = Real */
-				num = RatioToReal(CreateRatio(GetInt(one) , GetInt(two)));
-				break;
-			case REAL:
-				/* Int / Real = Real */
-				num = CreateReal(GetInt(one) / GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Int / Complex = Complex */
-				num = DivideByComplex(one, two);
-				break;
-		}
-	}
-	else if(oneType == REAL){
-		switch(twoType){
-			case INT:
-				/* Real / Int = Real */
-				num = CreateReal(GetDouble(one) / GetInt(two));
-				break;
-			case REAL:
-				/* Real / Real = Real */
-				num = CreateReal(GetDouble(one) / GetDouble(two));
-				break;
-			case COMPLEX:
-				/* Real / Complex = Complex */
-				num = DivideByComplex(one, two);
-				break;
-		}
+	if(twoType == COMPLEX){
+		/* Anything / Complex = Complex */
+		num = DivideByComplex(one, two);
 	}
 	else if(oneType == COMPLEX){
-		switch(twoType){
-			case INT:
-			case REAL:
-				/* Complex / (Int|Real) = Complex */
-				num = CreateComplex(DivideNumbers(GetReal(one), two), DivideNumbers(GetImaginary(one), two));
-				break;
-			case COMPLEX:
-				/* Complex / Complex = Complex */
-				num = DivideByComplex(one, two);
-		}
+		/* Complex / Anything = Complex */
+		num = CreateComplex(DivideNumbers(GetReal(one), two), DivideNumbers(GetImaginary(one), two));
+	}
+	else if(oneType == REAL || twoType == REAL){
+		/* Real / Anything = Real */
+		num = CreateReal(NumberToDouble(one) / NumberToDouble(two));
+	}
+	else if(oneType == RATIO || twoType == RATIO){
+		/* Ratio / (Ratio|Int) = Ratio */
+		num = RatioDivide(one, two);
+	}
+	else{
+		/* Int / Int = Ratio */
+		num = CreateRatio(one, two);
 	}
 
 	/* Reduce the number to its best type */
@@ -380,6 +598,21 @@ VyNumber** DivideNumbers(VyNumber** one, VyNumber** two){
 	return num;
 }
 
+/* Raise an exact number to a non-negative fixnum power by repeated squaring */
+VyNumber** ExactPower(VyNumber** base, int exponent){
+	VyNumber** result = CreateInt(1);
+	while(exponent > 0){
+		if(exponent & 1){
+			result = MultiplyNumbers(result, base);
+		}
+		exponent >>= 1;
+		if(exponent > 0){
+			base = MultiplyNumbers(base, base);
+		}
+	}
+	return result;
+}
+
 /* Take a power */
 VyNumber** ExponentiateNumber(VyNumber** base, VyNumber** exponent){
 	int baseType = base[0]->type;
@@ -390,31 +623,25 @@ VyNumber** ExponentiateNumber(VyNumber** base, VyNumber** exponent){
 		return (VyNumber**)(-1);
 	}
 
-	VyNumber** num;
+	/* A complex base */
+	if(baseType == COMPLEX){
+		return ComplexExponent(base, exponent);
+	}
 
-	if(baseType == INT){
-		switch(expType){
-			case INT:
-				num =  CreateInt((int)(pow(GetInt(base), GetInt(exponent))));
-				break;
-			case REAL:
-				num =  CreateReal(pow(GetInt(base), GetDouble(exponent)));
-				break;
+	/* Exact numbers raised to fixnum powers stay exact */
+	if(expType == INT && (baseType == INT || baseType == BIGINT || baseType == RATIO)){
+		int power = GetInt(exponent);
+		if(power >= 0){
+			return ExactPower(base, power);
 		}
-	}
-	else if(baseType == REAL){
-		switch(expType){
-			case INT:
-				num =  CreateReal(pow(GetDouble(base), GetInt(exponent)));
-				break;
-			case REAL:
-				num =  CreateReal(pow(GetDouble(base), GetDouble(exponent)));
-				break;
+
+		/* Negative powers are the reciprocal, but zero has no reciprocal */
+		if(EqualsZero(base)){
+			return CreateReal(pow(0.0, power));
 		}
-	}
-	else if(baseType == COMPLEX){
-			num = ComplexExponent(base, exponent);	
+		return DivideNumbers(CreateInt(1), ExactPower(base, -power));
 	}
 
-	return num;
+	/* Everything else is done with doubles */
+	return CreateReal(pow(NumberToDouble(base), NumberToDouble(exponent)));
 }
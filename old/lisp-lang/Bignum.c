@@ -0,0 +1,816 @@
+#include "Vyion.h"
+
+/* Operands smaller than this many limbs use schoolbook multiplication */
+#define KARATSUBA_THRESHOLD 32
+
+/* Operands at least this many limbs long use Toom-3 multiplication */
+#define TOOM3_THRESHOLD 128
+
+/***** Functions that operate on raw magnitudes (arrays of limbs, least significant first) *****/
+
+/* Find the size of a magnitude without its leading zero limbs */
+static int TrimLimbs(const VyLimb* a, int n){
+	while(n > 0 && a[n - 1] == 0){
+		n--;
+	}
+	return n;
+}
+
+/* Compare two magnitudes */
+static int CompareMagnitudes(const VyLimb* a, int an, const VyLimb* b, int bn){
+	an = TrimLimbs(a, an);
+	bn = TrimLimbs(b, bn);
+	if(an != bn){
+		return (an > bn) ? 1 : -1;
+	}
+
+	int i;
+	for(i = an - 1; i >= 0; i--){
+		if(a[i] != b[i]){
+			return (a[i] > b[i]) ? 1 : -1;
+		}
+	}
+	return 0;
+}
+
+/* Add two magnitudes (r needs room for one more limb than the larger operand, and may alias a or b) */
+static int AddMagnitudes(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	/* Make sure a is the longer one */
+	if(an < bn){
+		const VyLimb* temp = a;
+		a = b;
+		b = temp;
+		int tempSize = an;
+		an = bn;
+		bn = tempSize;
+	}
+
+	VyDoubleLimb carry = 0;
+	int i;
+	for(i = 0; i < bn; i++){
+		carry += (VyDoubleLimb)(a[i]) + b[i];
+		r[i] = (VyLimb)(carry);
+		carry >>= LIMB_BITS;
+	}
+	for(; i < an; i++){
+		carry += a[i];
+		r[i] = (VyLimb)(carry);
+		carry >>= LIMB_BITS;
+	}
+	r[an] = (VyLimb)(carry);
+
+	return TrimLimbs(r, an + 1);
+}
+
+/* Subtract magnitude b from magnitude a, which must be at least as large (r needs an limbs, and may alias a) */
+static int SubtractMagnitudes(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	bn = TrimLimbs(b, bn);
+
+	VyDoubleLimb borrow = 0;
+	int i;
+	for(i = 0; i < bn; i++){
+		VyDoubleLimb diff = (VyDoubleLimb)(a[i]) - b[i] - borrow;
+		r[i] = (VyLimb)(diff);
+		borrow = (diff >> LIMB_BITS) & 1;
+	}
+	for(; i < an; i++){
+		VyDoubleLimb diff = (VyDoubleLimb)(a[i]) - borrow;
+		r[i] = (VyLimb)(diff);
+		borrow = (diff >> LIMB_BITS) & 1;
+	}
+
+	return TrimLimbs(r, an);
+}
+
+/* Add b into r in place (r must be large enough to absorb the carry) */
+static void AddIntoMagnitude(VyLimb* r, int rn, const VyLimb* b, int bn){
+	VyDoubleLimb carry = 0;
+	int i;
+	for(i = 0; i < bn; i++){
+		carry += (VyDoubleLimb)(r[i]) + b[i];
+		r[i] = (VyLimb)(carry);
+		carry >>= LIMB_BITS;
+	}
+	for(; carry != 0 && i < rn; i++){
+		carry += r[i];
+		r[i] = (VyLimb)(carry);
+		carry >>= LIMB_BITS;
+	}
+}
+
+/* Subtract b from r in place (r must be at least as large as b) */
+static void SubtractFromMagnitude(VyLimb* r, int rn, const VyLimb* b, int bn){
+	bn = TrimLimbs(b, bn);
+
+	VyDoubleLimb borrow = 0;
+	int i;
+	for(i = 0; i < bn; i++){
+		VyDoubleLimb diff = (VyDoubleLimb)(r[i]) - b[i] - borrow;
+		r[i] = (VyLimb)(diff);
+		borrow = (diff >> LIMB_BITS) & 1;
+	}
+	for(; borrow != 0 && i < rn; i++){
+		VyDoubleLimb diff = (VyDoubleLimb)(r[i]) - borrow;
+		r[i] = (VyLimb)(diff);
+		borrow = (diff >> LIMB_BITS) & 1;
+	}
+}
+
+/* Multiply a magnitude by a single limb and add another limb to it, in place; returns the new size */
+static int MultiplyAddSmall(VyLimb* r, int rn, VyLimb mul, VyLimb add){
+	VyDoubleLimb carry = add;
+	int i;
+	for(i = 0; i < rn; i++){
+		carry += (VyDoubleLimb)(r[i]) * mul;
+		r[i] = (VyLimb)(carry);
+		carry >>= LIMB_BITS;
+	}
+	if(carry != 0){
+		r[rn] = (VyLimb)(carry);
+		rn++;
+	}
+	return rn;
+}
+
+/* Divide a magnitude by a single limb in place, returning the remainder */
+static VyLimb DivideSmall(VyLimb* r, int rn, VyLimb div){
+	VyDoubleLimb rem = 0;
+	int i;
+	for(i = rn - 1; i >= 0; i--){
+		VyDoubleLimb cur = (rem << LIMB_BITS) | r[i];
+		r[i] = (VyLimb)(cur / div);
+		rem = cur % div;
+	}
+	return (VyLimb)(rem);
+}
+
+static void MultiplyMagnitudes(VyLimb*, const VyLimb*, int, const VyLimb*, int);
+
+/* Schoolbook multiplication (r gets an + bn limbs) */
+static void MultiplySchoolbook(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	memset(r, 0, sizeof(VyLimb) * (an + bn));
+
+	int i, j;
+	for(i = 0; i < an; i++){
+		VyDoubleLimb ai = a[i];
+		if(ai == 0){
+			continue;
+		}
+
+		/* The largest possible value here is (2^32 - 1)^2 + 2(2^32 - 1), which still fits */
+		VyDoubleLimb carry = 0;
+		for(j = 0; j < bn; j++){
+			carry += ai * b[j] + r[i + j];
+			r[i + j] = (VyLimb)(carry);
+			carry >>= LIMB_BITS;
+		}
+		r[i + bn] = (VyLimb)(carry);
+	}
+}
+
+/* Multiply when one operand is at least twice as long as the other, by splitting
+ * the long one into pieces the size of the short one (r gets an + bn limbs) */
+static void MultiplyUnbalanced(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	memset(r, 0, sizeof(VyLimb) * (an + bn));
+	VyLimb* product = malloc(sizeof(VyLimb) * 2 * bn);
+
+	int i;
+	for(i = 0; i < an; i += bn){
+		int chunk = (an - i < bn) ? an - i : bn;
+		MultiplyMagnitudes(product, a + i, chunk, b, bn);
+		AddIntoMagnitude(r + i, an + bn - i, product, chunk + bn);
+	}
+
+	free(product);
+}
+
+/* Karatsuba multiplication, for operands where an >= bn > an/2 (r gets an + bn limbs):
+ *   a = a1 B + a0, b = b1 B + b0
+ *   ab = a1 b1 B^2 + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B + a0 b0
+ */
+static void MultiplyKaratsuba(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	int k = (an + 1) / 2;
+	int a1n = an - k;
+	int b0n = (bn < k) ? bn : k;
+	int b1n = (bn > k) ? bn - k : 0;
+
+	/* The low and high products go straight into the result, which have disjoint ranges */
+	memset(r, 0, sizeof(VyLimb) * (an + bn));
+	MultiplyMagnitudes(r, a, k, b, b0n);
+	if(b1n > 0){
+		MultiplyMagnitudes(r + 2 * k, a + k, a1n, b + k, b1n);
+	}
+
+	/* Sums of the halves */
+	VyLimb* sumA = malloc(sizeof(VyLimb) * (k + 1));
+	VyLimb* sumB = malloc(sizeof(VyLimb) * (k + 1));
+	int sumAn = AddMagnitudes(sumA, a, k, a + k, a1n);
+	int sumBn = AddMagnitudes(sumB, b, b0n, b + k, b1n);
+
+	/* The middle term */
+	int middleN = sumAn + sumBn;
+	VyLimb* middle = malloc(sizeof(VyLimb) * (middleN + 1));
+	MultiplyMagnitudes(middle, sumA, sumAn, sumB, sumBn);
+	SubtractFromMagnitude(middle, middleN, r, k + b0n);
+	if(b1n > 0){
+		SubtractFromMagnitude(middle, middleN, r + 2 * k, a1n + b1n);
+	}
+	AddIntoMagnitude(r + k, an + bn - k, middle, TrimLimbs(middle, middleN));
+
+	free(sumA);
+	free(sumB);
+	free(middle);
+}
+
+/* Make a signed bignum view of part of a magnitude (no memory is allocated) */
+static void MagnitudePiece(BigIntNum* piece, const VyLimb* a, int an, int start, int length){
+	if(start >= an){
+		length = 0;
+	}
+	else if(start + length > an){
+		length = an - start;
+	}
+
+	piece->limbs = (VyLimb*)(a + start);
+	piece->size = (length > 0) ? TrimLimbs(a + start, length) : 0;
+	piece->sign = (piece->size > 0) ? 1 : 0;
+}
+
+/* Exact division of a signed bignum by a small number, in place */
+static void DivideExactSmall(BigIntNum* num, VyLimb div){
+	DivideSmall(num->limbs, num->size, div);
+	num->size = TrimLimbs(num->limbs, num->size);
+	if(num->size == 0){
+		num->sign = 0;
+	}
+}
+
+/* Replace a bignum with the result of an operation, freeing the old value */
+static void ReplaceBig(BigIntNum* dest, BigIntNum* src){
+	BigFree(dest);
+	*dest = *src;
+}
+
+/* Toom-3 multiplication, for balanced operands (r gets an + bn limbs). Each operand is split
+ * into three pieces, evaluated at 0, 1, -1, -2 and infinity, multiplied pointwise, and then
+ * interpolated using Bodrato's sequence. */
+static void MultiplyToom3(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	int k = (an + 2) / 3;
+
+	/* Split into pieces */
+	BigIntNum a0, a1, a2, b0, b1, b2;
+	MagnitudePiece(&a0, a, an, 0, k);
+	MagnitudePiece(&a1, a, an, k, k);
+	MagnitudePiece(&a2, a, an, 2 * k, an);
+	MagnitudePiece(&b0, b, bn, 0, k);
+	MagnitudePiece(&b1, b, bn, k, k);
+	MagnitudePiece(&b2, b, bn, 2 * k, bn);
+
+	/* Evaluate at 1, -1, and -2: p(-2) = 2(p(-1) + p2) - p0 */
+	BigIntNum temp, temp2;
+	BigIntNum pOne, pMinusOne, pMinusTwo, qOne, qMinusOne, qMinusTwo;
+
+	BigAdd(&temp, &a0, &a2);
+	BigAdd(&pOne, &temp, &a1);
+	BigSubtract(&pMinusOne, &temp, &a1);
+	BigFree(&temp);
+	BigAdd(&temp, &pMinusOne, &a2);
+	BigAdd(&temp2, &temp, &temp);
+	BigSubtract(&pMinusTwo, &temp2, &a0);
+	BigFree(&temp);
+	BigFree(&temp2);
+
+	BigAdd(&temp, &b0, &b2);
+	BigAdd(&qOne, &temp, &b1);
+	BigSubtract(&qMinusOne, &temp, &b1);
+	BigFree(&temp);
+	BigAdd(&temp, &qMinusOne, &b2);
+	BigAdd(&temp2, &temp, &temp);
+	BigSubtract(&qMinusTwo, &temp2, &b0);
+	BigFree(&temp);
+	BigFree(&temp2);
+
+	/* Pointwise products */
+	BigIntNum rZero, rOne, rMinusOne, rMinusTwo, rInf;
+	BigMultiply(&rZero, &a0, &b0);
+	BigMultiply(&rOne, &pOne, &qOne);
+	BigMultiply(&rMinusOne, &pMinusOne, &qMinusOne);
+	BigMultiply(&rMinusTwo, &pMinusTwo, &qMinusTwo);
+	BigMultiply(&rInf, &a2, &b2);
+
+	BigFree(&pOne);
+	BigFree(&pMinusOne);
+	BigFree(&pMinusTwo);
+	BigFree(&qOne);
+	BigFree(&qMinusOne);
+	BigFree(&qMinusTwo);
+
+	/* Interpolate to find the coefficients c1, c2, c3 (c0 = r(0) and c4 = r(inf)) */
+	BigIntNum c1, c2, c3;
+
+	/* c3 = (r(-2) - r(1)) / 3 */
+	BigSubtract(&c3, &rMinusTwo, &rOne);
+	DivideExactSmall(&c3, 3);
+
+	/* c1 = (r(1) - r(-1)) / 2 */
+	BigSubtract(&c1, &rOne, &rMinusOne);
+	DivideExactSmall(&c1, 2);
+
+	/* c2 = r(-1) - r(0) */
+	BigSubtract(&c2, &rMinusOne, &rZero);
+
+	/* c3 = (c2 - c3) / 2 + 2 r(inf) */
+	BigSubtract(&temp, &c2, &c3);
+	DivideExactSmall(&temp, 2);
+	BigAdd(&temp2, &temp, &rInf);
+	BigFree(&temp);
+	BigAdd(&temp, &temp2, &rInf);
+	BigFree(&temp2);
+	ReplaceBig(&c3, &temp);
+
+	/* c2 = c2 + c1 - r(inf) */
+	BigAdd(&temp, &c2, &c1);
+	BigSubtract(&temp2, &temp, &rInf);
+	BigFree(&temp);
+	ReplaceBig(&c2, &temp2);
+
+	/* c1 = c1 - c3 */
+	BigSubtract(&temp, &c1, &c3);
+	ReplaceBig(&c1, &temp);
+
+	/* Recompose the result; all the coefficients are non-negative */
+	int rn = an + bn;
+	memset(r, 0, sizeof(VyLimb) * rn);
+	memcpy(r, rZero.limbs, sizeof(VyLimb) * rZero.size);
+	AddIntoMagnitude(r + k, rn - k, c1.limbs, c1.size);
+	AddIntoMagnitude(r + 2 * k, rn - 2 * k, c2.limbs, c2.size);
+	AddIntoMagnitude(r + 3 * k, rn - 3 * k, c3.limbs, c3.size);
+	AddIntoMagnitude(r + 4 * k, rn - 4 * k, rInf.limbs, rInf.size);
+
+	BigFree(&rZero);
+	BigFree(&rOne);
+	BigFree(&rMinusOne);
+	BigFree(&rMinusTwo);
+	BigFree(&rInf);
+	BigFree(&c1);
+	BigFree(&c2);
+	BigFree(&c3);
+}
+
+/* Multiply two magnitudes, choosing the algorithm by size (r gets an + bn limbs and must not alias a or b) */
+static void MultiplyMagnitudes(VyLimb* r, const VyLimb* a, int an, const VyLimb* b, int bn){
+	int resultSize = an + bn;
+	an = TrimLimbs(a, an);
+	bn = TrimLimbs(b, bn);
+
+	/* Make sure a is the longer one */
+	if(an < bn){
+		const VyLimb* temp = a;
+		a = b;
+		b = temp;
+		int tempSize = an;
+		an = bn;
+		bn = tempSize;
+	}
+
+	if(bn == 0){
+		memset(r, 0, sizeof(VyLimb) * resultSize);
+		return;
+	}
+
+	if(bn < KARATSUBA_THRESHOLD){
+		MultiplySchoolbook(r, a, an, b, bn);
+	}
+	else if(2 * bn <= an){
+		MultiplyUnbalanced(r, a, an, b, bn);
+	}
+	else if(bn < TOOM3_THRESHOLD || 3 * bn <= 2 * an){
+		MultiplyKaratsuba(r, a, an, b, bn);
+	}
+	else{
+		MultiplyToom3(r, a, an, b, bn);
+	}
+
+	/* Clear any space that trimming the operands left unused */
+	if(an + bn < resultSize){
+		memset(r + an + bn, 0, sizeof(VyLimb) * (resultSize - an - bn));
+	}
+}
+
+/* Divide magnitude u (m limbs) by magnitude v (n limbs, m >= n, top limb non-zero) using Knuth's algorithm D.
+ * The quotient gets m - n + 1 limbs and the remainder gets n limbs. */
+static void DivideMagnitudes(VyLimb* q, VyLimb* r, const VyLimb* u, int m, const VyLimb* v, int n){
+	int i, j;
+
+	/* A single limb divisor is much simpler */
+	if(n == 1){
+		memcpy(q, u, sizeof(VyLimb) * m);
+		r[0] = DivideSmall(q, m, v[0]);
+		return;
+	}
+
+	/* Normalize so that the top bit of the divisor is set */
+	int shift = __builtin_clz(v[n - 1]);
+	VyLimb* vn = malloc(sizeof(VyLimb) * n);
+	VyLimb* un = malloc(sizeof(VyLimb) * (m + 1));
+
+	for(i = n - 1; i > 0; i--){
+		vn[i] = (v[i] << shift) | (VyLimb)((VyDoubleLimb)(v[i - 1]) >> (LIMB_BITS - shift));
+	}
+	vn[0] = v[0] << shift;
+
+	un[m] = (VyLimb)((VyDoubleLimb)(u[m - 1]) >> (LIMB_BITS - shift));
+	for(i = m - 1; i > 0; i--){
+		un[i] = (u[i] << shift) | (VyLimb)((VyDoubleLimb)(u[i - 1]) >> (LIMB_BITS - shift));
+	}
+	un[0] = u[0] << shift;
+
+	VyDoubleLimb base = (VyDoubleLimb)(1) << LIMB_BITS;
+	for(j = m - n; j >= 0; j--){
+		/* Estimate the quotient digit, and correct the estimate so it is off by at most one */
+		VyDoubleLimb numerator = ((VyDoubleLimb)(un[j + n]) << LIMB_BITS) | un[j + n - 1];
+		VyDoubleLimb qhat = numerator / vn[n - 1];
+		VyDoubleLimb rhat = numerator % vn[n - 1];
+		while(qhat >= base || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[j + n - 2])){
+			qhat--;
+			rhat += vn[n - 1];
+			if(rhat >= base){
+				break;
+			}
+		}
+
+		/* Multiply and subtract */
+		long long borrow = 0;
+		long long t;
+		for(i = 0; i < n; i++){
+			VyDoubleLimb p = qhat * vn[i];
+			t = (long long)(un[i + j]) - borrow - (long long)(p & 0xFFFFFFFFULL);
+			un[i + j] = (VyLimb)(t);
+			borrow = (long long)(p >> LIMB_BITS) - (t >> LIMB_BITS);
+		}
+		t = (long long)(un[j + n]) - borrow;
+		un[j + n] = (VyLimb)(t);
+
+		/* If we subtracted too much, add the divisor back */
+		q[j] = (VyLimb)(qhat);
+		if(t < 0){
+			q[j]--;
+			VyDoubleLimb carry = 0;
+			for(i = 0; i < n; i++){
+				carry += (VyDoubleLimb)(un[i + j]) + vn[i];
+				un[i + j] = (VyLimb)(carry);
+				carry >>= LIMB_BITS;
+			}
+			un[j + n] += (VyLimb)(carry);
+		}
+	}
+
+	/* Unnormalize the remainder */
+	for(i = 0; i < n - 1; i++){
+		r[i] = (un[i] >> shift) | (VyLimb)((VyDoubleLimb)(un[i + 1]) << (LIMB_BITS - shift));
+	}
+	r[n - 1] = un[n - 1] >> shift;
+
+	free(vn);
+	free(un);
+}
+
+/***** Signed bignum functions *****/
+
+/* Set a bignum to zero */
+static void BigZero(BigIntNum* r){
+	r->sign = 0;
+	r->size = 0;
+	r->limbs = NULL;
+}
+
+/* Create a bignum from an unsigned machine word */
+static void BigFromULong(BigIntNum* r, unsigned long long val){
+	r->limbs = malloc(sizeof(VyLimb) * 2);
+	r->limbs[0] = (VyLimb)(val);
+	r->limbs[1] = (VyLimb)(val >> LIMB_BITS);
+	r->size = TrimLimbs(r->limbs, 2);
+	r->sign = (r->size > 0) ? 1 : 0;
+}
+
+/* Create a bignum from a machine integer */
+void BigFromLong(BigIntNum* r, long long val){
+	/* Be careful to not overflow when negating the most negative number */
+	unsigned long long magnitude = (val < 0) ? (unsigned long long)(-(val + 1)) + 1 : (unsigned long long)(val);
+	BigFromULong(r, magnitude);
+	if(val < 0){
+		r->sign = -1;
+	}
+}
+
+/* Create a bignum view of a fixnum */
+void BigFromIntView(BigIntNum* r, int val, VyLimb* limb){
+	r->limbs = limb;
+	if(val == 0){
+		r->sign = 0;
+		r->size = 0;
+		return;
+	}
+
+	limb[0] = (val < 0) ? (VyLimb)(-(long long)(val)) : (VyLimb)(val);
+	r->size = 1;
+	r->sign = (val < 0) ? -1 : 1;
+}
+
+/* Create a bignum from a string of decimal digits, nine digits at a time */
+void BigFromDigits(BigIntNum* r, char* digits, int length){
+	r->limbs = calloc(length / 9 + 2, sizeof(VyLimb));
+	r->size = 0;
+
+	int i = 0;
+	while(i < length){
+		/* Collect up to nine digits into one limb-sized chunk */
+		VyLimb chunk = 0;
+		VyLimb scale = 1;
+		int end = (i + 9 < length) ? i + 9 : length;
+		for(; i < end; i++){
+			chunk = chunk * 10 + (digits[i] - '0');
+			scale *= 10;
+		}
+
+		r->size = MultiplyAddSmall(r->limbs, r->size, scale, 0);
+		r->size = AddMagnitudes(r->limbs, r->limbs, r->size, &chunk, 1);
+	}
+
+	r->size = TrimLimbs(r->limbs, r->size);
+	r->sign = (r->size > 0) ? 1 : 0;
+}
+
+/* Whether a bignum fits into a fixnum */
+int BigFitsInt(BigIntNum* num){
+	if(num->size == 0){
+		return 1;
+	}
+	if(num->size > 1){
+		return 0;
+	}
+
+	if(num->sign > 0){
+		return num->limbs[0] <= 2147483647U;
+	}
+	return num->limbs[0] <= 2147483648U;
+}
+
+/* Whether a bignum fits into a long long */
+int BigFitsLong(BigIntNum* num){
+	if(num->size <= 1){
+		return 1;
+	}
+	if(num->size > 2){
+		return 0;
+	}
+
+	VyDoubleLimb magnitude = ((VyDoubleLimb)(num->limbs[1]) << LIMB_BITS) | num->limbs[0];
+	if(num->sign > 0){
+		return magnitude <= 9223372036854775807ULL;
+	}
+	return magnitude <= 9223372036854775808ULL;
+}
+
+/* Convert a bignum which fits into a long long */
+long long BigToLong(BigIntNum* num){
+	VyDoubleLimb magnitude = 0;
+	if(num->size > 0){
+		magnitude = num->limbs[0];
+	}
+	if(num->size > 1){
+		magnitude |= (VyDoubleLimb)(num->limbs[1]) << LIMB_BITS;
+	}
+
+	if(num->sign < 0){
+		return -(long long)(magnitude - 1) - 1;
+	}
+	return (long long)(magnitude);
+}
+
+/* Convert a bignum to the closest double (using the top three limbs is plenty for 53 bits of precision) */
+double BigToDouble(BigIntNum* num){
+	double result = 0;
+	int i;
+	int lowest = (num->size > 3) ? num->size - 3 : 0;
+	for(i = num->size - 1; i >= lowest; i--){
+		result = result * 4294967296.0 + num->limbs[i];
+	}
+
+	result = ldexp(result, LIMB_BITS * lowest);
+	return (num->sign < 0) ? -result : result;
+}
+
+/* Compare two bignums */
+int BigCompare(BigIntNum* one, BigIntNum* two){
+	if(one->sign != two->sign){
+		return (one->sign > two->sign) ? 1 : -1;
+	}
+
+	int magnitudeComparison = CompareMagnitudes(one->limbs, one->size, two->limbs, two->size);
+	return (one->sign < 0) ? -magnitudeComparison : magnitudeComparison;
+}
+
+/* Copy a bignum */
+void BigCopy(BigIntNum* r, BigIntNum* num){
+	r->sign = num->sign;
+	r->size = num->size;
+	r->limbs = malloc(sizeof(VyLimb) * (num->size + 1));
+	memcpy(r->limbs, num->limbs, sizeof(VyLimb) * num->size);
+}
+
+/* Add two bignums */
+void BigAdd(BigIntNum* r, BigIntNum* one, BigIntNum* two){
+	if(one->sign == 0){
+		BigCopy(r, two);
+		return;
+	}
+	if(two->sign == 0){
+		BigCopy(r, one);
+		return;
+	}
+
+	int larger = (one->size > two->size) ? one->size : two->size;
+	r->limbs = malloc(sizeof(VyLimb) * (larger + 1));
+
+	/* Same signs add magnitudes, different signs subtract the smaller magnitude from the larger */
+	if(one->sign == two->sign){
+		r->size = AddMagnitudes(r->limbs, one->limbs, one->size, two->limbs, two->size);
+		r->sign = one->sign;
+		return;
+	}
+
+	int comparison = CompareMagnitudes(one->limbs, one->size, two->limbs, two->size);
+	if(comparison == 0){
+		r->size = 0;
+		r->sign = 0;
+	}
+	else if(comparison > 0){
+		r->size = SubtractMagnitudes(r->limbs, one->limbs, one->size, two->limbs, two->size);
+		r->sign = one->sign;
+	}
+	else{
+		r->size = SubtractMagnitudes(r->limbs, two->limbs, two->size, one->limbs, one->size);
+		r->sign = two->sign;
+	}
+}
+
+/* Subtract two bignums by adding the negation */
+void BigSubtract(BigIntNum* r, BigIntNum* one, BigIntNum* two){
+	BigIntNum negated = *two;
+	negated.sign = -negated.sign;
+	BigAdd(r, one, &negated);
+}
+
+/* Multiply two bignums */
+void BigMultiply(BigIntNum* r, BigIntNum* one, BigIntNum* two){
+	if(one->sign == 0 || two->sign == 0){
+		BigZero(r);
+		return;
+	}
+
+	r->limbs = malloc(sizeof(VyLimb) * (one->size + two->size));
+	MultiplyMagnitudes(r->limbs, one->limbs, one->size, two->limbs, two->size);
+	r->size = TrimLimbs(r->limbs, one->size + two->size);
+	r->sign = one->sign * two->sign;
+}
+
+/* Truncating division (the quotient rounds towards zero, and the remainder has the sign of the dividend) */
+void BigDivMod(BigIntNum* quotient, BigIntNum* remainder, BigIntNum* one, BigIntNum* two){
+	/* If the divisor is larger, the quotient is zero */
+	if(CompareMagnitudes(one->limbs, one->size, two->limbs, two->size) < 0){
+		if(quotient != NULL){
+			BigZero(quotient);
+		}
+		if(remainder != NULL){
+			BigCopy(remainder, one);
+		}
+		return;
+	}
+
+	int m = one->size;
+	int n = two->size;
+	VyLimb* q = malloc(sizeof(VyLimb) * (m - n + 1));
+	VyLimb* r = malloc(sizeof(VyLimb) * n);
+	DivideMagnitudes(q, r, one->limbs, m, two->limbs, n);
+
+	if(quotient != NULL){
+		quotient->limbs = q;
+		quotient->size = TrimLimbs(q, m - n + 1);
+		quotient->sign = (quotient->size > 0) ? one->sign * two->sign : 0;
+	}
+	else{
+		free(q);
+	}
+
+	if(remainder != NULL){
+		remainder->limbs = r;
+		remainder->size = TrimLimbs(r, n);
+		remainder->sign = (remainder->size > 0) ? one->sign : 0;
+	}
+	else{
+		free(r);
+	}
+}
+
+/* Binary GCD on machine words */
+unsigned long long BinaryGcd(unsigned long long u, unsigned long long v){
+	if(u == 0){
+		return v;
+	}
+	if(v == 0){
+		return u;
+	}
+
+	/* Factor out the common powers of two */
+	int shift = __builtin_ctzll(u | v);
+	u >>= __builtin_ctzll(u);
+
+	/* Now u is odd; repeatedly subtract the smaller from the larger, removing factors of two */
+	do{
+		v >>= __builtin_ctzll(v);
+		if(u > v){
+			unsigned long long temp = u;
+			u = v;
+			v = temp;
+		}
+		v -= u;
+	} while(v != 0);
+
+	return u << shift;
+}
+
+/* Greatest common divisor: Euclid's algorithm while the numbers are large, then binary GCD */
+void BigGcd(BigIntNum* r, BigIntNum* one, BigIntNum* two){
+	BigIntNum x, y;
+	BigCopy(&x, one);
+	BigCopy(&y, two);
+	x.sign = (x.size > 0) ? 1 : 0;
+	y.sign = (y.size > 0) ? 1 : 0;
+
+	while(y.sign != 0 && (x.size > 2 || y.size > 2)){
+		BigIntNum rem;
+		BigDivMod(NULL, &rem, &x, &y);
+		BigFree(&x);
+		x = y;
+		y = rem;
+	}
+
+	if(y.sign == 0){
+		*r = x;
+		BigFree(&y);
+		return;
+	}
+
+	/* Both fit in a machine word */
+	unsigned long long u = x.limbs[0] | ((x.size > 1) ? (VyDoubleLimb)(x.limbs[1]) << LIMB_BITS : 0);
+	unsigned long long v = y.limbs[0] | ((y.size > 1) ? (VyDoubleLimb)(y.limbs[1]) << LIMB_BITS : 0);
+	BigFree(&x);
+	BigFree(&y);
+
+	BigFromULong(r, BinaryGcd(u, v));
+}
+
+/* Convert a bignum to a decimal string, by repeatedly dividing out nine digits at a time */
+char* BigToString(BigIntNum* num){
+	if(num->sign == 0){
+		return strdup("0");
+	}
+
+	/* Each limb holds less than ten decimal digits */
+	int maxDigits = num->size * 10 + 2;
+	char* str = malloc(maxDigits + 1);
+	char* end = str + maxDigits;
+	*end = '\0';
+	char* pos = end;
+
+	VyLimb* temp = malloc(sizeof(VyLimb) * num->size);
+	memcpy(temp, num->limbs, sizeof(VyLimb) * num->size);
+	int size = num->size;
+
+	while(size > 0){
+		VyLimb chunk = DivideSmall(temp, size, 1000000000U);
+		size = TrimLimbs(temp, size);
+
+		/* Write all nine digits of the chunk, except for the leading zeros of the last chunk */
+		int i;
+		for(i = 0; i < 9 && (size > 0 || chunk > 0); i++){
+			*--pos = '0' + (chunk % 10);
+			chunk /= 10;
+		}
+	}
+	free(temp);
+
+	if(num->sign < 0){
+		*--pos = '-';
+	}
+
+	memmove(str, pos, end - pos + 1);
+	return str;
+}
+
+/* Free the bignum's memory */
+void BigFree(BigIntNum* num){
+	free(num->limbs);
+	BigZero(num);
+}
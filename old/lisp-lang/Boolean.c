@@ -19,8 +19,8 @@ int IsFalse(VyBoolean** b){
 /*                           Creation of booleans 
  * Note: since all boolean values are the same, there is no need for more
  * than two of them. Therefore, just return the global true or false value. */
-VyBoolean** t = NULL;
-VyBoolean** f = NULL;
+__thread VyBoolean** t = NULL;
+__thread VyBoolean** f = NULL;
 
 VyBoolean** MakeTrueBool(){
 	if(t == NULL){
@@ -39,6 +39,12 @@ VyBoolean** MakeFalseBool(){
 	return f;
 }
 
+/* Restore the true and false values (for heap images) */
+void SetBooleans(VyBoolean** trueBool, VyBoolean** falseBool){
+	t = trueBool;
+	f = falseBool;
+}
+
 /* Functions for logic operations and, or, xor, and not (non-short-circuiting) */
 VyBoolean** BoolAnd(VyBoolean** one, VyBoolean** two){
 	if(IsTrue(one) && IsTrue(two)){
@@ -69,67 +75,19 @@ VyBoolean** BoolNot(VyBoolean** b){
 	}
 }
 
-/* Functions for comparing numbers */
+/* Functions for comparing numbers (any mix of integers, ratios, and reals) */
 VyBoolean** LessThan(VyNumber** one, VyNumber** two){
-	/* If they are of the same type, then compare */
-	if(one[0]->type == INT && two[0]->type == INT){
-		if(GetInt(one) < GetInt(two)){
-			return t;	
-		} else{
-			return f;	
-		}
-	}
-	if(one[0]->type == REAL && two[0]->type == REAL){
-		if(GetDouble(one) < GetDouble(two)){
-			return t;	
-		} else{
-			return f;	
-		}
-	}
-
-	/* If the types are different, make sure that one is an int */
-	if(one[0]->type == REAL){
-		return LessThan(two, one);	
-	}
-
-	/* Guaranteed that type one is int and type two is double */
-	else{
-		if((double)(GetInt(one)) < GetDouble(two)){
-			return t;	
-		}else{
-			return f;	
-		}
+	if(CompareNumbers(one, two) < 0){
+		return t;	
+	}else{
+		return f;	
 	}
 }
 VyBoolean** GreaterThan(VyNumber** one, VyNumber** two){
-	/* If they are of the same type, then compare */
-	if(one[0]->type == INT && two[0]->type == INT){
-		if(GetInt(one) > GetInt(two)){
-			return t;	
-		} else{
-			return f;	
-		}
-	}
-	if(one[0]->type == REAL && two[0]->type == REAL){
-		if(GetDouble(one) > GetDouble(two)){
-			return t;	
-		} else{
-			return f;	
-		}
-	}
-
-	/* If the types are different, make sure that one is an int */
-	if(one[0]->type == REAL){
-		return GreaterThan(two, one);	
-	}
-
-	/* Guaranteed that type one is int and type two is double */
-	else{
-		if((double)(GetInt(one)) > GetDouble(two)){
-			return t;	
-		}else{
-			return f;	
-		}
+	if(CompareNumbers(one, two) > 0){
+		return t;	
+	}else{
+		return f;	
 	}
 }
 
@@ -165,6 +123,11 @@ VyBoolean** Equal(VyNumber** one, VyNumber** two){
 			return t;	
 		}
 	}
+	if(one[0]->type == BIGINT || one[0]->type == RATIO){
+		if(CompareNumbers(one, two) == 0){
+			return t;	
+		}
+	}
 	if(one[0]->type == COMPLEX){
 		/* Check that both the imaginary and real parts are equal */
 		return BoolAnd(Equal(GetReal(one), GetReal(two)), Equal(GetImaginary(one), GetImaginary(two)));
@@ -1,84 +1,55 @@
 #include "Vyion.h"
 
-/* Make a new character list and initialize the next node to NULL */
+/* The capacity of a new character list */
+#define INIT_CHAR_LIST_SIZE 16
+
+/* Make a new, empty character list */
 CharList* MakeCharList(){
 	CharList* c = malloc(sizeof(CharList));
-	c->next = NULL;
+	c->size = 0;
+	c->capacity = INIT_CHAR_LIST_SIZE;
+	c->chars = malloc(c->capacity);
 	return c;
 }
 
-/* Add another node to the list */
+/* Add a character to the end of the list, doubling the buffer when it fills up */
 void Add(CharList* list, char c){
-	/* If this is the last node, then add the character to it and add another empty node for the future */
-	if(list->next == NULL){
-		/* Create a new node that will be used in future additions*/
-		list->next = MakeCharList();
-
-		/* Add the character to THIS node */
-		list->val = c;
-
-	}
-	/* If it isn't the last node, then continue on to the next node in the list */
-	else {
-		Add(list->next, c); 
+	if(list->size == list->capacity){
+		list->capacity *= 2;
+		list->chars = realloc(list->chars, list->capacity);
 	}
+
+	list->chars[list->size] = c;
+	list->size++;
 }
 
 /* Find the character at index n */
 char Get(CharList* list, int n){
-	/* If it's this node, return it; otherwise, go on to the next node */
-	if(n == 0){
-		return list->val;
-	}else{
-		return Get(list->next, n - 1);
-	}
+	return list->chars[n];
 }
 
 /* Convert the CharList to a string */
 char* ToStr(CharList* list){
-	/* Allocate room for the string */
-	int list_size = Size(list);
-	char* str = malloc(sizeof(char)*list_size + 1);
-
-
-	/* Collect the string characters */
-	int c;
-	for(c = 0; c < list_size; c++){
-		str[c] = Get(list,c);
-	}
-
-	/* End the string (with a ASCII 0) */
-	str[list_size] = '\0';
+	return strndup(list->chars, list->size);
+}
 
-	/* Return the string */
-	return str;
+/* Empty the list, keeping its buffer */
+void Clear(CharList* list){
+	list->size = 0;
 }
 
 int Size(CharList* list){
-	if(list->next == NULL){
-		return 0;
-	}else{
-		return Size(list->next) + 1;
-	}
+	return list->size;
 }
 
-/* Print the contents of the list recursively */
+/* Print the contents of the list */
 void Print(CharList* list){
-	if(list->next != NULL){
-		printf("%c", list->val);
-		Print(list->next);
-	}
+	fwrite(list->chars, 1, list->size, stdout);
 }
 
 /* Delete the list */
 void Delete(CharList* list){
-	/* If this is the last added one, free it, otherwise, 
-	 * free the next node first and then free this node. */
-	if(list->next == NULL){
-		free(list);
-	}else{
-		Delete(list->next);
-		free(list);
-	}
+	free(list->chars);
+	free(list);
 }
 
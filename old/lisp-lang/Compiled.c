@@ -0,0 +1,245 @@
+#include "Vyion.h"
+
+/* A compiled file starts with this, followed by the version of the format */
+#define COMPILED_MAGIC "VYCTREE"
+#define COMPILED_VERSION 2
+
+/* The header of a compiled file, which says which source it was compiled from */
+typedef struct {
+	char magic[8];
+	int version;
+	int nodeSize;
+
+	/* The modification time and size of the source */
+	long sourceSeconds;
+	long sourceNanoseconds;
+	long sourceSize;
+} CompiledHeader;
+
+/* Fill in the header a compiled file of a source file should have (returning 0 if the source isn't there) */
+int MakeCompiledHeader(CompiledHeader* header, char* source){
+	struct stat info;
+	if(stat(source, &info) != 0){
+		return 0;
+	}
+
+	memset(header, 0, sizeof(CompiledHeader));
+	memcpy(header->magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+	header->version = COMPILED_VERSION;
+	header->nodeSize = sizeof(VyParseTree);
+	header->sourceSeconds = info.st_mtim.tv_sec;
+	header->sourceNanoseconds = info.st_mtim.tv_nsec;
+	header->sourceSize = info.st_size;
+	return 1;
+}
+
+/* Find the name of the compiled file of a source file (the extension .v, if it has it, becomes .vyc) */
+char* CompiledPath(char* source){
+	int length = strlen(source);
+	if(length > 2 && strcmp(source + length - 2, ".v") == 0){
+		length -= 2;
+	}
+
+	char* path = malloc(length + 5);
+	memcpy(path, source, length);
+	strcpy(path + length, ".vyc");
+	return path;
+}
+
+/***** Reading compiled files *****/
+
+/* Open a compiled file, if it is up to date */
+CompiledFile* OpenCompiledFile(char* source){
+	CompiledHeader expected;
+	if(!MakeCompiledHeader(&expected, source)){
+		return NULL;
+	}
+
+	char* path = CompiledPath(source);
+	FILE* file = fopen(path, "rb");
+	if(file == NULL){
+		free(path);
+		return NULL;
+	}
+
+	CompiledHeader header;
+	if(fread(&header, sizeof(CompiledHeader), 1, file) != 1 || memcmp(&header, &expected, sizeof(CompiledHeader)) != 0){
+		fclose(file);
+		free(path);
+		return NULL;
+	}
+
+	CompiledFile* compiled = malloc(sizeof(CompiledFile));
+	compiled->file = file;
+	compiled->path = path;
+	compiled->data = NULL;
+	return compiled;
+}
+
+/* Read data from a compiled file (since forms are evaluated as they are read, one which ends early can't be
+ * given up on for the source, so that is fatal, like a source file which isn't there) */
+void ReadCompiled(CompiledFile* compiled, void* data, int size){
+	if(fread(data, 1, size, compiled->file) != size){
+		fprintf(stderr, "\"%s\" is damaged; delete it to compile its source again.\n", compiled->path);
+		ExitInterpreter();
+	}
+}
+
+/* Read a number */
+VyNumber** ReadCompiledNumber(CompiledFile* compiled){
+	int type;
+	ReadCompiled(compiled, &type, sizeof(int));
+
+	if(type == BIGINT){
+		BigIntNum big;
+		ReadCompiled(compiled, &big.sign, sizeof(int));
+		ReadCompiled(compiled, &big.size, sizeof(int));
+		big.limbs = malloc(sizeof(VyLimb) * (big.size + 1));
+		ReadCompiled(compiled, big.limbs, sizeof(VyLimb) * big.size);
+
+		VyNumber** num = CreateNumber(BIGINT);
+		*((BigIntNum*) NumberToSubtype(num)) = big;
+		return num;
+	}
+	else if(type == RATIO){
+		/* The parts were already reduced when the number was parsed */
+		VyNumber** numerator = ReadCompiledNumber(compiled);
+		VyNumber** denominator = ReadCompiledNumber(compiled);
+
+		VyNumber** ratio = CreateNumber(RATIO);
+		RatioNum* rNum = NumberToSubtype(ratio);
+		rNum->numerator = numerator;
+		rNum->denominator = denominator;
+		return ratio;
+	}
+	else if(type == COMPLEX){
+		VyNumber** real = ReadCompiledNumber(compiled);
+		VyNumber** imaginary = ReadCompiledNumber(compiled);
+		return CreateComplex(real, imaginary);
+	}
+
+	VyNumber** num = CreateNumber(type);
+	ReadCompiled(compiled, NumberToSubtype(num), NumberSize(type));
+	return num;
+}
+
+/* Read a form: its block goes straight into memory, and then its numbers are created */
+VyParseTree* ReadCompiledForm(CompiledFile* compiled){
+	int size;
+	ReadCompiled(compiled, &size, sizeof(int));
+	if(size == 0){
+		return NULL;
+	}
+
+	void* block = malloc(size);
+	ReadCompiled(compiled, block, size);
+
+	int numNodes;
+	VyParseTree* tree = TreeInBlock(block, &numNodes);
+
+	int i;
+	for(i = 0; i < numNodes; i++){
+		if(tree[i].type == TREE_NUM){
+			tree[i].data.num = ReadCompiledNumber(compiled);
+		}
+	}
+	return tree;
+}
+
+/* Close a compiled file */
+void CloseCompiledFile(CompiledFile* compiled){
+	fclose(compiled->file);
+	free(compiled->path);
+	free(compiled);
+}
+
+/***** Writing compiled files *****/
+
+/* Start writing a compiled file (into memory, since evaluating the forms may end the program) */
+CompiledFile* CreateCompiledFile(char* source){
+	CompiledHeader header;
+	if(!MakeCompiledHeader(&header, source)){
+		return NULL;
+	}
+
+	CompiledFile* compiled = malloc(sizeof(CompiledFile));
+	compiled->file = open_memstream(&compiled->data, &compiled->size);
+	if(compiled->file == NULL){
+		free(compiled);
+		return NULL;
+	}
+	fwrite(&header, sizeof(CompiledHeader), 1, compiled->file);
+
+	compiled->path = CompiledPath(source);
+	return compiled;
+}
+
+/* Write a number */
+void WriteCompiledNumber(FILE* file, VyNumber** num){
+	int type = num[0]->type;
+	fwrite(&type, sizeof(int), 1, file);
+
+	if(type == BIGINT){
+		BigIntNum* big = NumberToSubtype(num);
+		fwrite(&big->sign, sizeof(int), 1, file);
+		fwrite(&big->size, sizeof(int), 1, file);
+		fwrite(big->limbs, sizeof(VyLimb), big->size, file);
+	}
+	else if(type == RATIO){
+		RatioNum* rNum = NumberToSubtype(num);
+		WriteCompiledNumber(file, rNum->numerator);
+		WriteCompiledNumber(file, rNum->denominator);
+	}
+	else if(type == COMPLEX){
+		ComplexNum* cNum = NumberToSubtype(num);
+		WriteCompiledNumber(file, cNum->real);
+		WriteCompiledNumber(file, cNum->imaginary);
+	}
+	else{
+		fwrite(NumberToSubtype(num), NumberSize(type), 1, file);
+	}
+}
+
+/* Write a form (the number pointers in the block are written too, but they are replaced when it is read) */
+void WriteCompiledForm(CompiledFile* compiled, VyParseTree* tree){
+	int size;
+	void* block = GetTreeBlock(tree, &size);
+	fwrite(&size, sizeof(int), 1, compiled->file);
+	fwrite(block, 1, size, compiled->file);
+
+	int numNodes;
+	TreeInBlock(block, &numNodes);
+
+	int i;
+	for(i = 0; i < numNodes; i++){
+		if(tree[i].type == TREE_NUM){
+			WriteCompiledNumber(compiled->file, tree[i].data.num);
+		}
+	}
+}
+
+/* Finish a compiled file: if it is complete, write it under a temporary name, then give it its real one (the
+ * temporary name is the process's and the context's own, since others may be compiling the same file at once) */
+void FinishCompiledFile(CompiledFile* compiled, int complete){
+	int end = 0;
+	fwrite(&end, sizeof(int), 1, compiled->file);
+	fclose(compiled->file);
+
+	if(complete){
+		char* tempPath = malloc(strlen(compiled->path) + 32);
+		sprintf(tempPath, "%s.%d-%d.tmp", compiled->path, (int) getpid(), ContextNumber());
+
+		FILE* file = fopen(tempPath, "wb");
+		if(file != NULL){
+			int written = fwrite(compiled->data, 1, compiled->size, file) == compiled->size;
+			if(fclose(file) != 0 || !written || rename(tempPath, compiled->path) != 0){
+				remove(tempPath);
+			}
+		}
+		free(tempPath);
+	}
+
+	free(compiled->data);
+	free(compiled->path);
+	free(compiled);
+}
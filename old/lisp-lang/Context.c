@@ -0,0 +1,74 @@
+#include "Vyion.h"
+
+/* The stack of a context's thread: as deep as a main thread's usually is, so that code which recurses deeply
+ * runs the same in one (it is only mapped, so what isn't used costs nothing) */
+#define CONTEXT_STACK_SIZE (64*1024*1024)
+
+/* The context of this thread (NULL for the main thread), and where it goes back to when it has to stop */
+__thread VyContext* currentContext = NULL;
+__thread jmp_buf contextExit;
+
+/* The number of the next context to start */
+int nextContext = 1;
+
+/* Run the files of a context in an interpreter of its own */
+void* RunContext(void* arg){
+	VyContext* context = arg;
+	currentContext = context;
+
+	InitEvaluator();
+	SetReplMode(0);
+
+	if(setjmp(contextExit) == 0){
+		int i;
+		for(i = 0; i < context->numFiles; i++){
+			RunFile(context->files[i]);
+		}
+		context->succeeded = 1;
+	}
+
+	FreeHeap(GetMemoryHeap());
+	return NULL;
+}
+
+/* Start a context */
+VyContext* StartContext(char** files, int numFiles){
+	VyContext* context = malloc(sizeof(VyContext));
+	context->files = files;
+	context->numFiles = numFiles;
+	context->number = __atomic_fetch_add(&nextContext, 1, __ATOMIC_RELAXED);
+	context->succeeded = 0;
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, CONTEXT_STACK_SIZE);
+	int started = pthread_create(&context->thread, &attributes, &RunContext, context) == 0;
+	pthread_attr_destroy(&attributes);
+
+	if(!started){
+		free(context);
+		return NULL;
+	}
+	return context;
+}
+
+/* Wait for a context */
+int JoinContext(VyContext* context){
+	pthread_join(context->thread, NULL);
+	int succeeded = context->succeeded;
+	free(context);
+	return succeeded;
+}
+
+/* Stop the interpreter after an error */
+void ExitInterpreter(){
+	if(currentContext != NULL){
+		longjmp(contextExit, 1);
+	}
+	exit(0);
+}
+
+/* Get the number of this thread's context */
+int ContextNumber(){
+	return (currentContext != NULL) ? currentContext->number : 0;
+}
@@ -6,6 +6,11 @@ VyError** CreateError(char* message, VyParseTree* location){
 	err[0]->message = message;
 	err[0]->expr = location;
 
+	/* The error refers to the tree, so it needs to stay around */
+	if(location != NULL){
+		RetainParseTree();	
+	}
+
 	return err;
 }
 
@@ -16,9 +21,10 @@ void PrintError(VyError** err){
 	if(err[0]->expr != NULL){
 		PrintTree(err[0]->expr);
 		printf("\n");
-		if(err[0]->expr->pos != NULL){
+		Position pos;
+		if(GetTreePosition(err[0]->expr, &pos)){
 			printf("Position: ");
-			PrintPosition(err[0]->expr->pos);
+			PrintPosition(&pos);
 			printf("\n");
 		}
 	}
@@ -1,172 +1,129 @@
 #include "Vyion.h"
 
 /* Whether the interpreter is in interactive REPL mode */
-int replMode = 0;
-
-/* Process the argument list and 'return' the values and number of arguments */
-void ProcessArgumentList(Argument** funcArgs, int numFuncArgs, VyParseTree* tr, VyObject** valuesPtr, int* numArgsPtr, VyObject (*EvalFunctionToUse) (VyParseTree*)){
-	/* When gathering the arguments, remember their names (if any, else NULL) */
-	char** argumentNames = malloc(sizeof(char*) * (ListTreeSize(tr) - 1));
-
-	/* Evaluate the rest of the list and store the results */
-	VyObject* values = malloc(sizeof(VyObject) * (ListTreeSize(tr) - 1));
+__thread int replMode = 0;
+
+/* Process the argument list and 'return' the values and number of arguments. The values are allocated
+ * in the scratch region, so the caller should mark it before and release it once it is done with them.
+ * Which argument each value goes to is decided by the binding plan cached on the call node, which is
+ * recomputed only when a different function is called from the same node (planKey identifies the function). */
+void ProcessArgumentList(Argument** funcArgs, int numFuncArgs, void* planKey, VyParseTree* tr, VyObject** valuesPtr, int* numArgsPtr, VyObject (*EvalFunctionToUse) (VyParseTree*)){
+	VyRegion* scratch = GetScratchRegion();
+
+	/* Evaluate the given values in order (skipping the ~ before a named argument (~ (name value))) */
+	VyObject* given = RegionAlloc(scratch, sizeof(VyObject) * (ListTreeSize(tr) - 1));
+	int numGiven = 0;
 	int i;
-	int numArgs = 0;
 	for(i = 1; i < ListTreeSize(tr); i++){
-		/* If the current argument is a ~, skip it (it will be dealt with later as a named argument marker)*/
-		if(GetListData(tr, i)->type == TREE_IDENT && strcmp(GetStrData(GetListData(tr, i)), "~") == 0){
+		VyParseTree* arg = GetListData(tr, i);
+		if(IsNamedArgMarker(arg)){
 			continue;	
 		}
 
-		/* Count the number of arguments */
-		numArgs++;
-
-		/* Check whether the previous 'argument' was a ~ */
-		VyParseTree* prev = GetListData(tr, i -1 );
-
-		/* The evaluation result */
-		VyObject val;
-
-		/* If it is ~, then this is a named argument */
-		if(prev != NULL && prev->type == TREE_IDENT && strcmp(GetStrData(prev),"~") == 0){
-			/* Find the name and value */
-			char* namedArgName = GetStrData(GetListData(GetListData(tr, i), 0));
-			val = EvalFunctionToUse(GetListData(GetListData(tr, i), 1));
-
-			/* Now remember the name and the corresponding index (in the argument array) */
-			argumentNames[numArgs - 1] = namedArgName;
-		} else{
-			/* If it isn't a named argument, then it's name is NULL */
-			argumentNames[numArgs - 1] = NULL;
-			val = EvalFunctionToUse(GetListData(tr, i));
+		if(IsNamedArgMarker(GetListData(tr, i - 1))){
+			arg = GetListData(arg, 1);
 		}
+		given[numGiven++] = EvalFunctionToUse(arg);
+	}
 
-		/* Subtract one from the array index because i is the index of the list, not array */
-		values[numArgs - 1] = val;	
-	}
-
-	/* Now re-order the argument array for the named arguments */
-	/* Make sure the argument array is valid before using it */
-	if(funcArgs != NULL){
-
-		/* First, do the required named arguments */
-		int c;
-		for(c = 0; c < numFuncArgs && IsNamedArg(funcArgs[c]); c++){
-			/* Check whether the argument is a named one */
-			Argument* currArg = funcArgs[c];
-			if(IsNamedArg(currArg)){
-				/* If it is, match it up with the named argument that we have by switching the order of arguments */
-				char* name = currArg->name;
-
-				int d;
-				for(d = 0; d < numArgs; d++){
-					/* If this is the argument we want to match it with */
-					if(argumentNames[d] != NULL && strcmp(argumentNames[d], name) == 0){
-						/* Switch the order */	
-						VyObject temp = values[d];
-						int m;
-						for(m = d; m > c; m--){
-							/* Move one over to the left */
-							values[m] = values[m - 1];
-						}
-						values[c] = temp;
-					}
-				}
-			}
-		}
-
-		/* Find where the first optional argument occurs */
-		int firstOptionalArg = 0;
-		while(firstOptionalArg < numFuncArgs && !IsOptionalArg(funcArgs[firstOptionalArg])){
-			firstOptionalArg++;	
-		}
-
-		/* Next, sort the optional named arguments using the same method as before */
-		for(c = firstOptionalArg; c < numFuncArgs && IsNamedArg(funcArgs[c]); c++){
-			/* Check whether the argument is a named one */
-			Argument* currArg = funcArgs[c];
-			if(IsNamedArg(currArg)){
-				/* If it is, match it up with the named argument that we have by switching the order of arguments */
-				char* name = currArg->name;
-
-				int d;
-				for(d = 0; d < numArgs; d++){
-					/* If this is the argument we want to match it with */
-					if(argumentNames[d] != NULL && strcmp(argumentNames[d], name) == 0){
-						/* Switch the order */	
-						VyObject temp = values[d];
-						int m;
-						for(m = d; m > c; m--){
-							/* Move one over to the left */
-							values[m] = values[m - 1];
-						}
-						values[c] = temp;
-					}
-				}
-			}
-		}
-
-		/* Now, make sure that optional positional arguments done get messed up by pretending they _were_ passed (use their default value) */
-		for(c = firstOptionalArg; c < numFuncArgs && IsNamedArg(funcArgs[c]); c++){
-			/* For every named argument, check if it really was passed by looking in the argument names array */
-			int wasPassed = 0;
-			int n;
-			for(n = 0; n < numArgs; n++){
-				/* If it WAS passed */
-				if(argumentNames[n] != NULL && strcmp(argumentNames[n], funcArgs[c]->name) == 0){
-					wasPassed = 1;	
-				}
-			}
-
-			/* If it wasn't passed, then substitute it for its default value and move all the 
-			 * values over to the right to compensate for this space */
-			if(!wasPassed){
-				/* Increase the amount of space needed */
-				numArgs++;
-				values = realloc(values, numArgs * sizeof(VyObject));
-
-				/* Move all the values over */
-				int x;
-				for(x = numArgs - 1; x > c; x--){
-					values[x] = values[x - 1];	
-				}
+	/* Without an argument list, the values are just passed in order */
+	if(funcArgs == NULL){
+		*valuesPtr = given;
+		*numArgsPtr = numGiven;
+		return;
+	}
 
-				/* Now put the default value in where it should be */
-				values[c] = funcArgs[c]->optArgDefault;
-			}
+	/* Find the binding plan (this happens after the values are evaluated, since evaluating them may replace it) */
+	BindingPlan* plan = GetTreeCache(tr);
+	if(plan == NULL || plan->key != planKey){
+		plan = CreateBindingPlan(funcArgs, numFuncArgs, planKey, tr);
+		SetTreeCache(tr, plan);
+	}
 
-		}
+	/* Fill the slots */
+	VyObject* values = RegionAlloc(scratch, sizeof(VyObject) * plan->numSlots);
+	for(i = 0; i < plan->numSlots; i++){
+		int source = plan->sources[i];
+		values[i] = (source == PLAN_DEFAULT) ? funcArgs[i]->optArgDefault : given[source];
 	}
 
-	/* Return the values by storing the results in the correct memory locations */
 	*valuesPtr = values;
-	*numArgsPtr = numArgs;
-
-	/* Free the argument names */
-	free(argumentNames);
+	*numArgsPtr = plan->numSlots;
 }
 
 /* Perform a function given the VyFunction** and an argument list */
 VyObject PerformFunction(VyFunction** func, VyParseTree* tr){
 	VyObject* values;
 	int numArgs;
-	ProcessArgumentList(func[0]->args, func[0]->numArgs, tr, &values, &numArgs, &Eval);
+	RegionMark mark = MarkRegion(GetScratchRegion());
+	ProcessArgumentList(func[0]->args, func[0]->numArgs, (func[0]->code != NULL) ? (void*) func[0]->code : (void*) func[0]->args, tr, &values, &numArgs, &Eval);
 
-	/* Calculate the result of the function */
+	/* Calculate the result of the function (what it allocates is allocated by this call) */
+	VyParseTree* site = SetAllocationSite(tr);
 	VyObject val = RunFunction(func, values, numArgs);
-	free(values);
+	SetAllocationSite(site);
+	ReleaseRegion(GetScratchRegion(), mark);
 
+	/* Return the result */
+	return LocateError(val, tr);
+}
 
-	/* Check whether this result is an error, if it has no associated expression, give it one */
+/* Check whether the result of a call is an error, and if it has no associated expression, give it the call */
+VyObject LocateError(VyObject val, VyParseTree* tr){
 	if(ObjType(val) == VALERROR){
 		VyError** err = ObjData(val);
 		if(err[0]->expr == NULL){
 			err[0]->expr = tr;
+			RetainParseTree();
 		}
 	}
+	return val;
+}
 
-	/* Return the result */
-	return val;	
+/* The keywords, and their forms */
+struct {
+	char* name;
+	int form;
+} keywords[] = {
+	{"lambda", FORM_LAMBDA},
+	{"mambda", FORM_MAMBDA},
+	{"set", FORM_SET},
+	{"global", FORM_GLOBAL},
+	{"if", FORM_IF},
+	{"quote", FORM_QUOTE},
+	{"quote-substitutions", FORM_QUOTE_SUBST},
+	{"tagbody", FORM_TAGBODY},
+	{"go", FORM_GO},
+	{"infix", FORM_INFIX},
+	{"while", FORM_WHILE},
+	{"loop", FORM_LOOP},
+	{"for-range", FORM_FOR_RANGE},
+	{"for-each", FORM_FOR_EACH},
+	{"break", FORM_BREAK},
+	{"time", FORM_TIME},
+	{"bench", FORM_BENCH},
+	{NULL, 0}
+};
+
+/* Find out what kind of form a list starting with an identifier is (a keyword, an inline builtin, or a call) */
+int ClassifyForm(VyParseTree* tr){
+	char* funcName = GetStrData(ListTreeHead(tr));
+
+	int i;
+	for(i = 0; keywords[i].name != NULL; i++){
+		if(StrEquals(funcName, keywords[i].name)){
+			return keywords[i].form;
+		}
+	}
+
+	/* A call with named arguments is never inline, since it has a ~ among its arguments */
+	int numArgs = ListTreeSize(tr) - 1;
+	for(i = 1; i < ListTreeSize(tr); i++){
+		if(IsNamedArgMarker(GetListData(tr, i))){
+			return FORM_CALL;
+		}
+	}
+	return InlineBuiltinForm(funcName, numArgs);
 }
 
 /* Quoted eval with and without substitutions */
@@ -179,78 +136,110 @@ VyObject QuotedEvalWithoutSubstitution(VyParseTree* tr){
 
 /* Call a macro */
 VyObject ExpandMacro(VyMacro** mac, VyParseTree* tr){
+	/* The expansion is traced up to the tree it produces (or the error instead), and evaluating that is traced
+	 * separately */
+	long start = TraceStart();
+
 	/* Process the arguments as needed */
 	VyObject* vals;
 	int numArgs;
-	ProcessArgumentList(mac[0]->args, mac[0]->numArgs, tr, &vals, &numArgs, &QuotedEvalWithoutSubstitution);
+	RegionMark mark = MarkRegion(GetScratchRegion());
+	ProcessArgumentList(mac[0]->args, mac[0]->numArgs, mac[0]->code, tr, &vals, &numArgs, &QuotedEvalWithoutSubstitution);
 
 	char* err = CheckFunctionArguments(mac[0]->args, mac[0]->numArgs, vals, numArgs);
 	if(err != NULL){
+		ReleaseRegion(GetScratchRegion(), mark);
+		TraceEnd(TRACE_MACRO, mac[0]->code, 0, start);
 		return ToObject(CreateError(err, tr));	
 	}
 
 	/* Evaluate it as a native function */
 	VyObject obj = EvalNativeFunctionOrMacro(mac[0]->args, mac[0]->numArgs, mac[0]->code, mac[0]->scp, vals, numArgs);
+	ReleaseRegion(GetScratchRegion(), mark);
 
 	if(ObjType(obj) == VALERROR){
 		/* If it has no associated expression, give it one */
 		VyError** err = ObjData(obj);
 		if(err[0]->expr == NULL){
 			err[0]->expr = tr;
+			RetainParseTree();
 		}
+		TraceEnd(TRACE_MACRO, mac[0]->code, 0, start);
 		return obj;
 	}
 
-	/* Evaluate the macro expansion */
+	/* Evaluate the macro expansion, which comes from the module and position of the call (so functions it defines
+	 * are named after where they were defined, and see the variables of that module). Like a top-level tree, its
+	 * tree is deleted afterwards unless something created while evaluating it refers to it, so retention is
+	 * tracked separately for it and the form containing it. */
 	VyParseTree* tree = ObjToParseTree(obj);
-	free(vals);
+	SetTreeOrigin(tree, tr);
+	TraceEnd(TRACE_MACRO, mac[0]->code, 0, start);
+	int outerRetained = ParseTreeRetained();
+	SetParseTreeRetained(0);
+
+	VyObject result = Eval(tree);
 
-	return Eval(tree);
+	if(!ParseTreeRetained()){
+		DeleteParseTree(tree);
+	}
+	SetParseTreeRetained(outerRetained);
 
+	return result;
 }
 
-/* Handle an error: if in REPL mode, just continue, otherwise, exit */
+/* Handle an error: if in REPL mode, just continue, otherwise, stop the interpreter */
 void HandleError(VyObject err){
 	PrintError(ObjData(err));	
 	if(!replMode){
-		exit(0);
+		ExitInterpreter();
 	}
 }
 
-/* Convert an object into a corresponding parse tree */
-VyParseTree* ObjToParseTree(VyObject obj){
+/* Set whether the interpreter is in interactive REPL mode (in which errors don't exit) */
+void SetReplMode(int mode){
+	replMode = mode;
+}
+
+/* The builder for trees made from objects */
+__thread TreeBuilder* objTreeBuilder = NULL;
+
+/* Push the parse tree corresponding to an object onto the builder */
+void PushObject(VyObject obj){
 	int type = ObjType(obj);
 	if(type == VALLIST){
-		/* Make a list parse tree and add the elements to it */
-		VyParseTree* list = MakeListTree();		
-		int size = ListSize(ObjData(obj));
-		int i;
-
-		for(i = 0; i < size; i++){
-			AddToList(list, ObjToParseTree(ListGet(ObjData(obj), i)));		
+		/* Make a list parse tree and add the elements to it, walking the list's nodes once */
+		int list = BeginList(objTreeBuilder);
+		VyList** node;
+		for(node = ObjData(obj); node != NULL && node[0]->data >= 0; node = node[0]->next){
+			PushObject(node[0]->data);
 		}
 
-		return list;
+		EndList(objTreeBuilder, list);
 	}
 	else if(type == VALSYMB){
 		/* Create an ident from symbols */
-		VyParseTree* symb = MakeIdent();
-		SetStrData(symb, GetSymbolString(ObjData(obj)));
-		return symb;
-
+		char* str = GetSymbolString(ObjData(obj));
+		PushIdent(objTreeBuilder, str, strlen(str));
 	}
 	else if(type == VALNUM){
 		/* Numbers are still numbers, just in VyParseTree* form */
-		VyParseTree* num = MakeNum();
-		SetNumberData(num, ObjData(obj));
-		return num;
+		PushNumber(objTreeBuilder, ObjData(obj));
 	} else {
-		printf("TYPE IS %d", type);fflush(stdout);
-		PrintObj(obj);printf("\n");
-		return NULL;	
+		PushError(objTreeBuilder, "Object can't be converted to code.");
 	}
 }
 
+/* Convert an object into a corresponding parse tree */
+VyParseTree* ObjToParseTree(VyObject obj){
+	if(objTreeBuilder == NULL){
+		objTreeBuilder = CreateTreeBuilder();
+	}
+
+	PushObject(obj);
+	return FinishTree(objTreeBuilder);
+}
+
 /* Check a string for equality */
 int StrEquals(char* one, char* two){
 	return (strcmp(one, two) == 0);	
@@ -268,57 +257,74 @@ VyObject Eval(VyParseTree* tr){
 		if(first->type == TREE_IDENT) {
 			char* funcName = GetStrData(first);
 
+			/* Find out what kind of form this is, the first time it is evaluated */
+			int form = GetTreeForm(tr);
+			if(form == FORM_UNKNOWN){
+				form = ClassifyForm(tr);
+				SetTreeForm(tr, form);
+			}
+
 			/* Create a function on lambda */
-			if(StrEquals(funcName, "lambda")){
-				return ParseFunction(tr);
+			if(form == FORM_LAMBDA){
+				VyParseTree* site = SetAllocationSite(tr);
+				VyObject func = ParseFunction(tr);
+				SetAllocationSite(site);
+				return func;
 			}
 
 			/* Create a macro on mambda */
-			if(StrEquals(funcName, "mambda")){
+			if(form == FORM_MAMBDA){
 				return ParseMacro(tr);
 			}
 
 			/* Create a local variable binding on set */
-			else if(StrEquals(funcName, "set")){
+			else if(form == FORM_SET){
 				/* Create a variable binding and return the value held by it */
 				VyParseTree* varName = GetListData(tr, 1);
 				char* strVarName = GetStrData(varName);
 
 				VyObject varValue = Eval(GetListData(tr, 2));
 
-				/* Try looking for the object in the local scope */
-				if(FindValue(GetLocalScope(), strVarName) >= 0){
-					SetVariable(GetLocalScope(), strVarName, varValue);
-				}
-				else if(FindValue(GetCurrentFunctionScope(), strVarName) >= 0){
-					SetVariable(GetCurrentFunctionScope(), strVarName, varValue);
+				/* At the top level of an included module, it is set in the module's namespace, whatever else it is
+				 * bound in */
+				if(GetLocalScope() == GetGlobalScope() && GetModuleScope() != GetGlobalScope()){
+					SetVariable(GetModuleScope(), strVarName, varValue);
+					return varValue;
 				}
-				else if(FindValue(GetGlobalScope(), strVarName) >= 0){
-					SetVariable(GetGlobalScope(), strVarName, varValue);
+
+				/* If the variable is already bound in an accessible scope, update it there */
+				Scope* boundIn = FindVariableScope(strVarName, TreeModuleScope(tr));
+				if(boundIn != NULL){
+					SetVariable(boundIn, strVarName, varValue);
 				}
 
-				/* Add it to the scope */
-				SetVariable(GetLocalScope(), strVarName, varValue);
+				/* Add it to the local scope (at the top level, to the namespace of the module being loaded) */
+				if(GetLocalScope() != GetGlobalScope()){
+					SetVariable(GetLocalScope(), strVarName, varValue);
+				}
+				else if(boundIn == NULL){
+					SetVariable(GetModuleScope(), strVarName, varValue);
+				}
 
 				return varValue;
 			}
 
 			/* Create a global variable binding on global */
-			else if(StrEquals(funcName, "global")){
+			else if(form == FORM_GLOBAL){
 				/* Create a variable binding and return the value held by it */
 				VyParseTree* varName = GetListData(tr, 1);
 				char* strVarName = GetStrData(varName);
 				VyObject varValue = Eval(GetListData(tr, 2));
 
-				/* Add it to the scope */
-				VarBinding* var = CreateVariable(strVarName, varValue);
-				AddVariable(GetGlobalScope(), var);
+				/* Update it where it is bound, or add it to the namespace of the module being loaded */
+				Scope* boundIn = FindGlobalScope(strVarName);
+				SetVariable(boundIn != NULL ? boundIn : GetModuleScope(), strVarName, varValue);
 
 				return varValue;
 			}
 
 			/* If statements */
-			else if(StrEquals(funcName, "if")){
+			else if(form == FORM_IF){
 				/* Evaluate the condition */
 				VyObject cond = Eval(GetListData(tr, 1));
 
@@ -348,30 +354,33 @@ VyObject Eval(VyParseTree* tr){
 			}
 
 			/* The quote operator */
-			if(StrEquals(funcName, "quote")){
+			if(form == FORM_QUOTE){
 				return QuotedEval(GetListData(tr, 1), 0);	
 			}
 
 			/* The substituting quote operator */
-			else if(StrEquals(funcName, "quote-substitutions")){
-				return QuotedEval(GetListData(tr, 1), 1);	
+			else if(form == FORM_QUOTE_SUBST){
+				return EvalTemplate(tr);
 			}
 
 			/* Implement tagbody/go */
-			else if(StrEquals(funcName, "tagbody")){
+			else if(form == FORM_TAGBODY){
 				/* Build up the array containing the tagbody tags so go knows where to go */		
 				int tags = ListTreeSize(tr) - 1;
-				char** tagNames = malloc(sizeof(char*) * tags);
+				RegionMark mark = MarkRegion(GetScratchRegion());
+				char** tagNames = RegionAlloc(GetScratchRegion(), sizeof(char*) * tags);
 
 				int i;
 				for(i = 0; i < tags; i++){
 					VyParseTree* tagTree = GetListData(tr, i + 1);	
 					if(tagTree->type != TREE_LIST){
+						ReleaseRegion(GetScratchRegion(), mark);
 						return ToObject(CreateError("Tagbody tags must be wrapped in a list. ", tr));	
 					}
 
 					VyParseTree* tagNameIdent = GetListData(tagTree, 0);
 					if(tagNameIdent->type != TREE_IDENT){
+						ReleaseRegion(GetScratchRegion(), mark);
 						return ToObject(CreateError("Tag name must be an identifier. ", tagNameIdent));	
 					}
 					char* name = GetStrData(tagNameIdent);
@@ -415,26 +424,68 @@ VyObject Eval(VyParseTree* tr){
 							}
 						}
 						else if(ObjType(lastValue) == VALERROR){
+							ReleaseRegion(GetScratchRegion(), mark);
 							return lastValue;	
 						}
 
 					}
 				}
 
-				free(tagNames);
+				ReleaseRegion(GetScratchRegion(), mark);
 				return lastValue;
 
 			}
 
-			else if(StrEquals(funcName, "go")){
+			else if(form == FORM_GO){
 				char* goToTag = GetStrData(GetListData(tr, 1));	
 				return ToObject(CreateFlowControl(FLOWGO,goToTag)); 
 			}
 
+			/* Evaluate an infix expression through the prefix form it is rewritten to */
+			else if(form == FORM_INFIX){
+				char* error = NULL;
+				VyParseTree* prefix = GetInfixRewrite(tr, &error);
+				if(prefix == NULL){
+					return ToObject(CreateError(error, tr));
+				}
+				return Eval(prefix);
+			}
+
+			/* Loops */
+			else if(form == FORM_WHILE){
+				return EvalWhile(tr);
+			}
+			else if(form == FORM_LOOP){
+				return EvalLoop(tr);
+			}
+			else if(form == FORM_FOR_RANGE || form == FORM_FOR_EACH){
+				/* These allocate their loop variables */
+				VyParseTree* site = SetAllocationSite(tr);
+				VyObject result = (form == FORM_FOR_RANGE) ? EvalForRange(tr) : EvalForEach(tr);
+				SetAllocationSite(site);
+				return result;
+			}
+			else if(form == FORM_BREAK){
+				return EvalBreak(tr);
+			}
+
+			/* Measuring */
+			else if(form == FORM_TIME){
+				return EvalTime(tr);
+			}
+			else if(form == FORM_BENCH){
+				return EvalBench(tr);
+			}
+
+			/* Evaluate calls to the small builtins directly, as long as they haven't been redefined */
+			else if(form >= FORM_FIRST_INLINE && InlineBuiltinIntact(form)){
+				return EvalInlineBuiltin(form, tr);
+			}
+
 			/* Or perform the given function */
 			else{
 				/* Find the function with the given name */
-				VyObject func = FindObjAllScopes(funcName);
+				VyObject func = FindObjAllScopes(funcName, TreeModuleScope(tr));
 
 				/* If it was found, continue */
 				if(func >= 0){
@@ -446,21 +497,19 @@ VyObject Eval(VyParseTree* tr){
 					/* Or expand and evaluate the macro */
 					else if(ObjType(func) == VALMAC){
 
+						VyParseTree* site = SetAllocationSite(tr);
 						VyObject result = ExpandMacro(ObjData(func), tr);
+						SetAllocationSite(site);
 						return result;
 					}
 					/* Otherwise, function not found */
 					else{
-						int size = strlen("Cannot call a non-executable data type: ") + strlen(funcName) + 1;
-						char* str = malloc(size);
-						sprintf(str, "%s%s", "Cannot call a non-executable data type: ", funcName);
+						char* str = ConcatStrings("Cannot call a non-executable data type: ", funcName);
 						return ToObject(CreateError(str, tr));	
 					}
 				}
 				else {
-					int size = strlen("Callable not found: ") + strlen(funcName) + 1;
-					char* str = malloc(size);
-					sprintf(str, "%s%s", "Callable not found: ", funcName);
+					char* str = ConcatStrings("Callable not found: ", funcName);
 					return ToObject(CreateError(str, tr));	
 				}
 			}
@@ -505,23 +554,23 @@ VyObject Eval(VyParseTree* tr){
 	else if(tr->type == TREE_IDENT){
 		char* varName = GetStrData(tr);
 
-		VyObject val = FindObjAllScopes(varName);
+		VyObject val = FindObjAllScopes(varName, TreeModuleScope(tr));
 
 		/* If the variable isn't found, error */
 		if(val < 0){
-			int size = strlen("Variable not found: ") + strlen(varName) + 1;
-			char* str = malloc(size);
-			sprintf(str, "%s%s", "Variable not found: ", varName);
+			char* str = ConcatStrings("Variable not found: ", varName);
 			return ToObject(CreateError(str, NULL));
 		}
 
 		return val;
 	}
 
-	/* If the type is weird, return null */
-	printf("Error occured in Eval(), see last line, it SHOULD NOT GET HERE!");
-	exit(0);
-	return 0;
+	/* Anything else can't be evaluated: string literals are read, but there are no string values (symbols are
+	 * used instead), and so on */
+	if(tr->type == TREE_STR){
+		return ToObject(CreateError("There are no string values; use a symbol (like 'abc) instead.", tr));
+	}
+	return ToObject(CreateError("This expression can't be evaluated.", tr));
 
 }
 
@@ -530,7 +579,9 @@ VyObject QuotedEval(VyParseTree* tr, int doSubstitutions){
 
 	/* An identifier becomes a symbol */
 	if(tr->type == TREE_IDENT){
+		/* The symbol shares the identifier's string */
 		VySymbol** symb = CreateSymbol(GetStrData(tr));	
+		RetainParseTree();
 		return ToObject(symb);
 	}
 
@@ -544,6 +595,7 @@ VyObject QuotedEval(VyParseTree* tr, int doSubstitutions){
 		}
 
 		VyList** l = CreateList();
+		VyList** last = l;
 
 		/* Add the elements to the list one by one */
 		int listElements = ListTreeSize(tr);
@@ -561,15 +613,18 @@ VyObject QuotedEval(VyParseTree* tr, int doSubstitutions){
 				}
 
 				/* Add each of it's elements to the list */
-				int size = ListSize(ObjData(list));
-				int i;
-				for(i = 0; i < size; i++){
-					l = ListAppend(l, ListGet(ObjData(list), i));	
+				VyList** node;
+				for(node = ObjData(list); node != NULL && node[0]->data >= 0; node = node[0]->next){
+					last = ListBuildAppend(last, node[0]->data);	
 				}
 
 			}
 			else{
-				l = ListAppend(l, QuotedEval(nextParseTree, doSubstitutions));	
+				VyObject value = QuotedEval(nextParseTree, doSubstitutions);
+				if(ObjType(value) == VALERROR){
+					return value;
+				}
+				last = ListBuildAppend(last, value);	
 			}
 		}
 
@@ -581,9 +636,167 @@ VyObject QuotedEval(VyParseTree* tr, int doSubstitutions){
 		return Eval(tr);	
 	}
 
-	printf("Whoa! Wrong type! QuotedEval()");
-	exit(0);
-	return -1;
+	/* Anything else has no value to be quoted as */
+	if(tr->type == TREE_STR){
+		return ToObject(CreateError("There are no string values; use a symbol (like 'abc) instead.", tr));
+	}
+	return ToObject(CreateError("This expression can't be quoted.", tr));
+}
+
+/* A quasi-quote template is compiled into a sequence of steps which build its value, in preorder: a list step is
+ * followed by the steps of its elements. Parts of the template without substitutions are built once, when it is
+ * compiled, and shared by every value built from the template (lists are never modified once built, so this is
+ * safe), so building a value only costs as much as the substitutions and the lists containing them. */
+#define STEP_CONSTANT 0
+#define STEP_SUBSTITUTION 1
+#define STEP_SPLICE 2
+#define STEP_LIST 3
+
+typedef struct {
+	int kind;
+
+	/* The number of steps this one and its elements take up */
+	int size;
+
+	/* Lists: the number of elements */
+	int numElements;
+
+	/* Constants: the value */
+	VyObject constant;
+
+	/* Substitutions: the expression to evaluate (lists: the list, for error messages) */
+	VyParseTree* tree;
+} TemplateStep;
+
+/* A compiled template (cached on its quote-substitutions form) */
+typedef struct {
+	int numSteps;
+	TemplateStep steps[];
+} CompiledTemplate;
+
+/* Whether a template has any substitutions in it */
+int ContainsSubstitution(VyParseTree* tr){
+	if(tr->type != TREE_LIST){
+		return 0;
+	}
+	if(IsSubstitution(tr)){
+		return 1;
+	}
+
+	int i;
+	for(i = 0; i < ListTreeSize(tr); i++){
+		if(ContainsSubstitution(GetListData(tr, i))){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Count the steps a template compiles to */
+int CountTemplateSteps(VyParseTree* tr){
+	if(!ContainsSubstitution(tr) || IsSubstitution(tr)){
+		return 1;
+	}
+
+	int count = 1;
+	int i;
+	for(i = 0; i < ListTreeSize(tr); i++){
+		VyParseTree* element = GetListData(tr, i);
+		count += IsSplicingSubstitution(element) ? 1 : CountTemplateSteps(element);
+	}
+	return count;
+}
+
+/* Compile a template into the steps starting at the given one, and return how many steps it took */
+int CompileTemplateSteps(VyParseTree* tr, TemplateStep* step){
+	step->size = 1;
+
+	/* Constant parts are built right away */
+	if(!ContainsSubstitution(tr)){
+		step->kind = STEP_CONSTANT;
+		step->constant = QuotedEval(tr, 0);
+		return 1;
+	}
+
+	/* A substitution which isn't a list element (even a splicing one) is just evaluated */
+	if(IsSubstitution(tr)){
+		step->kind = STEP_SUBSTITUTION;
+		step->tree = GetListData(tr, 1);
+		return 1;
+	}
+
+	/* Otherwise, it is a list with substitutions somewhere inside it */
+	step->kind = STEP_LIST;
+	step->numElements = ListTreeSize(tr);
+	step->tree = tr;
+
+	int i;
+	for(i = 0; i < ListTreeSize(tr); i++){
+		VyParseTree* element = GetListData(tr, i);
+		TemplateStep* elementStep = step + step->size;
+		if(IsSplicingSubstitution(element)){
+			elementStep->kind = STEP_SPLICE;
+			elementStep->size = 1;
+			elementStep->tree = GetListData(element, 1);
+			step->size++;
+		}else{
+			step->size += CompileTemplateSteps(element, elementStep);
+		}
+	}
+	return step->size;
+}
+
+/* Build a value from the steps of a template */
+VyObject BuildTemplate(TemplateStep* step){
+	if(step->kind == STEP_CONSTANT){
+		return step->constant;
+	}
+	if(step->kind == STEP_SUBSTITUTION){
+		return Eval(step->tree);
+	}
+
+	VyList** l = CreateList();
+	VyList** last = l;
+
+	/* Add the elements one by one, splicing in the elements of splicing substitutions */
+	TemplateStep* element = step + 1;
+	int i;
+	for(i = 0; i < step->numElements; i++, element += element->size){
+		if(element->kind == STEP_SPLICE){
+			VyObject list = Eval(element->tree);
+			if(ObjType(list) != VALLIST){
+				return ToObject(CreateError("A splicing substitution operates only on lists.", step->tree));	
+			}
+
+			VyList** node;
+			for(node = ObjData(list); node != NULL && node[0]->data >= 0; node = node[0]->next){
+				last = ListBuildAppend(last, node[0]->data);	
+			}
+		}
+		else{
+			last = ListBuildAppend(last, BuildTemplate(element));
+		}
+	}
+
+	return ToObject(l);
+}
+
+/* Evaluate a quote-substitutions form, compiling its template the first time */
+VyObject EvalTemplate(VyParseTree* tr){
+	CompiledTemplate* compiled = GetTreeCache(tr);
+	if(compiled == NULL){
+		VyParseTree* template = GetListData(tr, 1);
+		int numSteps = CountTemplateSteps(template);
+		compiled = malloc(sizeof(CompiledTemplate) + sizeof(TemplateStep) * numSteps);
+		compiled->numSteps = numSteps;
+		CompileTemplateSteps(template, compiled->steps);
+		SetTreeCache(tr, compiled);
+	}
+
+	VyParseTree* site = SetAllocationSite(tr);
+	VyObject result = BuildTemplate(compiled->steps);
+	SetAllocationSite(site);
+	return result;
 }
 
 /* Define all the built-in functions as wrappers over the other functions.
@@ -599,7 +812,15 @@ VyObject LHead(VyFunction** f, VyObject* args, int argNum){
 VyObject LTail(VyFunction** f, VyObject* args, int argNum){
 	return ToObject(ListTail(ObjData(args[0])));		
 }
+/* Whether an argument is a fixnum (bignums, ratios and reals can't be used as indices or counts) */
+int IsFixnum(VyObject obj){
+	return ObjType(obj) == VALNUM && ((VyNumber**) ObjData(obj))[0]->type == INT;
+}
+
 VyObject LGet(VyFunction** f, VyObject* args, int argNum){
+	if(!IsFixnum(args[1])){
+		return ToObject(CreateError("A list index must be an integer.", NULL));
+	}
 	if(GetInt(ObjData(args[1])) > ListSize(ObjData(args[0]))){
 		return ToObject(CreateError("List index out of bounds.", NULL));	
 	}
@@ -609,6 +830,9 @@ VyObject LSize(VyFunction** f, VyObject* args, int argNum){
 	return ToObject(CreateInt(ListSize(ObjData(args[0]))));		
 }
 VyObject LInsert(VyFunction** f, VyObject* args, int argNum){
+	if(!IsFixnum(args[2])){
+		return ToObject(CreateError("A list index must be an integer.", NULL));
+	}
 	return ToObject(ListInsert(ObjData(args[0]), args[1], GetInt(ObjData(args[2]))));
 }
 
@@ -641,6 +865,11 @@ VyObject DivValues(VyFunction** f, VyObject* args, int argNum){
 	VyNumber** one = ObjData(args[0]);
 	VyNumber** two = ObjData(args[1]);
 
+	/* Exact numbers have no representation for infinity */
+	if(EqualsZero(two) && two[0]->type != REAL && one[0]->type != REAL){
+		return ToObject(CreateError("Division by zero.", NULL));	
+	}
+
 	VyNumber** result = DivideNumbers(one, two);
 	VyObject resultValue = ToObject(result);
 	return resultValue;
@@ -863,8 +1092,26 @@ VyObject IsBool(VyFunction** f, VyObject* args, int numArgs){
 	return ToObject(MakeTrueBool());	
 }
 
+/* Define an infix operator: (def-operator 'symbol precedence) or (def-operator 'symbol precedence 'right) */
+VyObject DefOperator(VyFunction** f, VyObject* args, int numArgs){
+	if(numArgs < 2 || numArgs > 3 || ObjType(args[0]) != VALSYMB || !IsFixnum(args[1])){
+		return ToObject(CreateError("def-operator takes an operator symbol and a precedence.", NULL));
+	}
+
+	int rightAssociative = 0;
+	if(numArgs == 3){
+		if(ObjType(args[2]) != VALSYMB || !StrEquals(GetSymbolString(ObjData(args[2])), "right")){
+			return ToObject(CreateError("The associativity of an operator can only be 'right.", NULL));
+		}
+		rightAssociative = 1;
+	}
+
+	DefineInfixOperator(GetSymbolString(ObjData(args[0])), GetInt(ObjData(args[1])), rightAssociative);
+	return args[0];
+}
+
 /* Generate a guaranteed unique symbol */
-int symbol = -1;
+__thread int symbol = -1;
 VyObject GenSymb(VyFunction** f, VyObject* args, int numArgs){
 	symbol++;
 
@@ -883,198 +1130,239 @@ VyObject GenSymb(VyFunction** f, VyObject* args, int numArgs){
 	return ToObject(CreateSymbol(genSymbStr));
 }
 
-/* A temporary namespace thing */
-void ProcessFile(char*);
-VyObject RequireFile(VyFunction** f, VyObject* args, int numArgs){
-	VyObject name = args[0];
-	VySymbol** symb = ObjData(name);
-	char* fileName = GetSymbolString(symb);
+/* Get or restore the number of the last unique symbol (for heap images) */
+int GetSymbolCounter(){
+	return symbol;
+}
+void SetSymbolCounter(int counter){
+	symbol = counter;
+}
+
+/* The built-in functions, with the number of arguments each takes. Heap images refer to builtins by their place in
+ * this table, so an image only works with the build of the interpreter which saved it. */
+Builtin builtins[] = {
+	{"+", 1, &AddValues},
+	{"-", 1, &SubtractValues},
+	{"*", 1, &MultValues},
+	{"/", 2, &DivValues},
+	{"**", 2, &ExpValues},
+
+	{"head", 1, &LHead},
+	{"tail", 1, &LTail},
+	{"nth", 2, &LGet},
+	{"len", 1, &LSize},
+	{"insert", 3, &LInsert},
+
+	{"&", 1, &BAnd},
+	{"|", 1, &BOr},
+	{"xor", 1, &BXor},
+	{"not", 1, &BNot},
+
+	{"<", 2, &LT},
+	{">", 2, &GT},
+	{"<=", 2, &LTE},
+	{">=", 2, &GTE},
+	{"=", 2, &EQ},
+	{"!=", 2, &NEQ},
+	{"eq", 2, &GeneralEQ},
+
+	{"print", 1, &ObjPrint},
+	{"print-line", 1, &ObjPrintLine},
+
+	{"include", 1, &IncludeFile},
+	{"reload", 1, &ReloadFile},
+
+	{"number?", 1, &IsNum},
+	{"function?", 1, &IsFunction},
+	{"list?", 1, &IsList},
+	{"symbol?", 1, &IsSymbol},
+	{"boolean?", 1, &IsBool},
+	{"macro?", 1, &IsMacro},
+	{"error?", 1, &IsError},
+
+	{"unique", 0, &GenSymb},
+
+	{"heap-profile", 0, &HeapProfile},
+	{"heap-dump", 1, &HeapDump},
+
+	{"def-operator", 2, &DefOperator},
+	{NULL, 0, NULL}
+};
+
+/* Find the place of a builtin in the table from its implementation (or -1) */
+int FindBuiltin(VyObject (*function)(VyFunction**, VyObject*, int)){
+	int i;
+	for(i = 0; builtins[i].name != NULL; i++){
+		if(builtins[i].function == function){
+			return i;
+		}
+	}
+	return -1;
+}
 
-	ProcessFile(fileName);
+/* Count the builtins */
+int NumBuiltins(){
+	int num = 0;
+	while(builtins[num].name != NULL){
+		num++;
+	}
+	return num;
+}
 
-	return ToObject(MakeTrueBool());
+/* Get a builtin by its place in the table (or NULL) */
+Builtin* GetBuiltin(int index){
+	return (index >= 0 && index < NumBuiltins()) ? &builtins[index] : NULL;
 }
 
+/* Set up the interpreter: the heap, the scopes and the builtins */
 int InitEvaluator(){
 
 	InitMem();
 
+	/* Create the regions for short-lived data */
+	InitRegions();
+
 	/* Initialize scopes (before functions because functions use scopes) */
 	InitScopes();
 
 	/* Initialize all the built-in functions */
-	Argument** args = NULL;
-
-	AddFunction("+", CreateBuiltinFunction(args, 1, &AddValues ));
-	AddFunction("-", CreateBuiltinFunction(args, 1, &SubtractValues));
-	AddFunction("*", CreateBuiltinFunction(args, 1, &MultValues));
-	AddFunction("/", CreateBuiltinFunction(args, 2, &DivValues));
-	AddFunction("**", CreateBuiltinFunction(args, 2, &ExpValues));
-
-	AddFunction("head", CreateBuiltinFunction(args, 1, &LHead));
-	AddFunction("tail", CreateBuiltinFunction(args, 1, &LTail));
-	AddFunction("nth", CreateBuiltinFunction(args, 2, &LGet));
-	AddFunction("len", CreateBuiltinFunction(args, 1, &LSize));
-	AddFunction("insert", CreateBuiltinFunction(args, 3, &LInsert));
-
-	AddFunction("&", CreateBuiltinFunction(args, 1, &BAnd));
-	AddFunction("|", CreateBuiltinFunction(args, 1, &BOr));
-	AddFunction("xor", CreateBuiltinFunction(args, 1, &BXor));
-	AddFunction("not", CreateBuiltinFunction(args, 1, &BNot));
-
-	AddFunction("<", CreateBuiltinFunction(args, 2, &LT));
-	AddFunction(">", CreateBuiltinFunction(args, 2, &GT));
-	AddFunction("<=", CreateBuiltinFunction(args, 2, &LTE));
-	AddFunction(">=", CreateBuiltinFunction(args, 2, &GTE));
-	AddFunction("=", CreateBuiltinFunction(args, 2, &EQ));
-	AddFunction("!=", CreateBuiltinFunction(args, 2, &NEQ));
-	AddFunction("eq", CreateBuiltinFunction(args, 2, &GeneralEQ));
-
-	AddFunction("print", CreateBuiltinFunction(args, 1, &ObjPrint));
-	AddFunction("print-line", CreateBuiltinFunction(args, 1, &ObjPrintLine));
-
-	AddFunction("include", CreateBuiltinFunction(args, 1, &RequireFile));
-
-	AddFunction("number?", CreateBuiltinFunction(args, 1, &IsNum));
-	AddFunction("function?", CreateBuiltinFunction(args, 1, &IsFunction));
-	AddFunction("list?", CreateBuiltinFunction(args, 1, &IsList));
-	AddFunction("symbol?", CreateBuiltinFunction(args, 1, &IsSymbol));
-	AddFunction("boolean?", CreateBuiltinFunction(args, 1, &IsBool));
-	AddFunction("macro?", CreateBuiltinFunction(args, 1, &IsMacro));
-	AddFunction("error?", CreateBuiltinFunction(args, 1, &IsError));
+	int i;
+	for(i = 0; builtins[i].name != NULL; i++){
+		AddFunction(builtins[i].name, CreateBuiltinFunction(NULL, builtins[i].numArgs, builtins[i].function));
+	}
 
-	AddFunction("unique", CreateBuiltinFunction(args, 0, &GenSymb));
+	InitInfixOperators();
 
+	/* Create the object loops break with */
+	InitLoops();
 
+	/* Now that they are defined, the small builtins can be inlined */
+	InitInlineBuiltins();
 
 	/* Initialize built-in globals */
-	AddVariable(GetGlobalScope(), CreateVariable("true!", ToObject(MakeTrueBool())));
-	AddVariable(GetGlobalScope(), CreateVariable("false!", ToObject(MakeFalseBool())));
-
-
+	AddVariable(GetGlobalScope(), "true!", ToObject(MakeTrueBool()));
+	AddVariable(GetGlobalScope(), "false!", ToObject(MakeFalseBool()));
 
 	return 1;
 }
-void ProcessFile(char* filename){
-	/* Parse the file, and if no errors exist, evaluate the expressions */
-	VyParseTree* exprList = ParseFile(filename);
-
-	if(exprList != NULL && !CheckAndPrintErrors(exprList)){
-		/* Evaluate each expression and, if error, print and exit */
-		int i;
-		for(i = 0; i < ListTreeSize(exprList); i++){
-			VyParseTree* next = GetListData(exprList, i);
-			VyObject val = Eval(next);
+/* How many top-level forms are being evaluated (more than one when a form includes a file) */
+__thread int formDepth = 0;
+
+/* Evaluate a top-level form */
+VyObject EvalTopLevel(VyParseTree* expr){
+	SetParseTreeRetained(0);
+	formDepth++;
+	VyObject val = Eval(expr);
+	formDepth--;
+	return val;
+}
 
-			if(ObjType(val) == VALERROR){
-				HandleError(val);	
-			}
+/* Once a top-level form has been dealt with, free its tree and the form region, unless the form was retained.
+ * The data of forms in an included file is kept until the form which included the file is done. */
+void FinishTopLevel(VyParseTree* expr){
+	if(!ParseTreeRetained()){
+		DeleteParseTree(expr);	
+	}
 
+	if(formDepth == 0){
+		if(ParseTreeRetained()){
+			AbandonRegion(GetFormRegion());
+		}else{
+			ResetRegion(GetFormRegion());
 		}
 	}
 }
 
-/* Given a char list, check that all parens balance */
-int AllParensClosed(CharList* list){
-	int counting = 1;
-	int parens = 0;		
-
-	int c;
-	for(c = 0; c < Size(list); c++){
-		char next = Get(list, c);	
-		if(counting){
-			if(next == '('){
-				parens++;	
-			}
-			else if(next == ')'){
-				parens--;	
-			}
-		}
-	}
+/* Evaluate a top-level form of a file, and return whether it was retained */
+int EvalFileForm(VyParseTree* expr){
+	Position pos;
+	long line = GetTreePosition(expr, &pos) ? pos.line + 1 : 0;
+	long start = TraceStart();
+
+	/* Evaluate the expression and, if error, print and exit */
+	VyObject val = EvalTopLevel(expr);
+	TraceEnd(TRACE_FORM, NULL, line, start);
 
-	if(parens == 0){
-		return 1;	
-	}else{
-		return 0;	
+	if(ObjType(val) == VALERROR){
+		HandleError(val);	
 	}
-}
 
-/* The read eval print loop */
-void ReadEvalPrintLoop(){
-	CharList** prevInputs = NULL;
-	int numInputs = 0;
-	char c;
-
-	/* Let the user enter expressions and evaluate them */
-	while(c != EOF){
-		printf("V >> ");	
-		fflush(stdout);
-
-		/* Get user input */
-		CharList* strList = MakeCharList();	
-		while(1){
-			c = getchar();
-			/* On entered newline, if all parenthesis balance, stop, otherwise continue data enterage */
-			if(c == '\n' && AllParensClosed(strList)){
-				break;
-			}else if(c == '\n'){
-				printf("     ");	
-			}
+	int retained = ParseTreeRetained();
+	FinishTopLevel(expr);
+	return retained;
+}
 
-			Add(strList, c);
+/* Read, parse, and evaluate a file one top-level form at a time, deleting each form's parse tree once it has been
+ * evaluated (unless it was retained). A form is evaluated before the forms after it are even read. Included files
+ * are compiled (see Compiled.h): their forms are read from the compiled file if it is up to date, and otherwise,
+ * they are written to it as they are parsed. */
+void ProcessFile(char* filename, int included){
+	/* When a file is included, the including form is still being evaluated, so keep its retention */
+	int outerRetained = ParseTreeRetained();
+
+	int anyRetained = 0;
+	int numForms = 0;
+	long start = TraceStart();
+
+	CompiledFile* compiled = included ? OpenCompiledFile(filename) : NULL;
+	if(compiled != NULL){
+		VyParseTree* expr;
+		while((expr = ReadCompiledForm(compiled)) != NULL){
+			SetTreeModule(expr, GetLoadingModule() + 1);
+			numForms++;
+			anyRetained |= EvalFileForm(expr);
+		}
+		CloseCompiledFile(compiled);
+	}
+	else{
+		VyReader* reader = OpenReader(filename);
+		if(reader == NULL){
+			fprintf(stderr, "\"%s\" not available.\n", filename);
+			ExitInterpreter();
 		}
 
-		numInputs++;
-		prevInputs = realloc(prevInputs, numInputs*sizeof(CharList*));
-		prevInputs[numInputs - 1] = strList;
+		compiled = included ? CreateCompiledFile(filename) : NULL;
+		int complete = 1;
+		while(ReadForm(reader)){
+			/* Lex and parse the form (it may have been only a comment, in which case there is nothing to do) */
+			LexBufferAt(FormText(reader), FormLength(reader), FormPosition(reader));
+			VyParseTree* expr = Parse();
+			CleanLexer();
 
-		/* Lex, parse, eval */
-		char* str = ToStr(strList);
+			if(expr == NULL){
+				continue;	
+			}
+			SetTreeModule(expr, GetLoadingModule() + 1);
+			numForms++;
 
-		/* For convenience, exit when the user types "exit" and "quit" */
-		if(StrEquals(str, "exit") || StrEquals(str, "quit")){
-			exit(1);	
-		}
+			/* If there are errors, print them and stop */
+			if(CheckAndPrintErrors(expr)){
+				complete = 0;
+				break;	
+			}
 
-		Lex(str);
-		if(GetNumTokens() == 0){
-			continue;	
+			if(compiled != NULL){
+				WriteCompiledForm(compiled, expr);
+			}
+			anyRetained |= EvalFileForm(expr);
 		}
 
-		/* Look for errors, if none found, eval and print result */
-		VyParseTree* tree = Parse();
-		if(!CheckAndPrintErrors(tree)){
-			VyObject val = Eval(tree);
-			printf("\n");
-			PrintObj(val);
-			printf("\n");
+		if(compiled != NULL){
+			FinishCompiledFile(compiled, complete);
 		}
-
-		/* Free various resources */
-		CleanLexer();
-		CleanParser();
-		free(str);
+		CloseReader(reader);
 	}
-}
-
-int main(int argc, char** argv){
-	InitEvaluator();
 
-	/* If given filenames, process all that are given, otherwise enter the read-eval-print-loop */
-	if(argc >= 2){
-		replMode = 0;
-		int file;
-		for(file = 1; file < argc; file++){
-			ProcessFile(argv[file]);	
-		}
+	if(numForms == 0){
+		printf("Empty file: %s\n", filename);
 	}
-	else{
-		replMode = 1;
-		ReadEvalPrintLoop();
+	/* (The event is named after the module, since its name lasts as long as the registry does) */
+	int module = GetLoadingModule();
+	if(start != 0 && module >= 0){
+		int numModules;
+		TraceEnd(TRACE_FILE, GetModules(&numModules)[module].name, 0, start);
 	}
 
-	/* Free memory */
-	FreeHeap(GetMemoryHeap());
-
-	return 1;
+	/* If anything in the file was retained, the including form is too, so that the form region isn't reset under it */
+	SetParseTreeRetained(outerRetained || anyRetained);
 }
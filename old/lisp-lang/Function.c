@@ -8,6 +8,8 @@ VyFunction** CreateBuiltinFunction(Argument** args, int argNum,  VyObject (*buil
 	func[0]->numArgs = argNum;
 	func[0]->args = args;
 	func[0]->EvalFunction = builtin;
+	func[0]->code = NULL;
+	func[0]->scp = NULL;
 
 	return func;
 }
@@ -69,6 +71,99 @@ int IsNamedArg(Argument* arg){
 	return 0;
 }
 
+/***** Binding the values given at a call site to arguments *****/
+
+/* Check whether a call site element is ~ */
+int IsNamedArgMarker(VyParseTree* tree){
+	return tree->type == TREE_IDENT && GetStrData(tree)[0] == '~' && GetStrData(tree)[1] == '\0';
+}
+
+/* Move the given value named after argument c to slot c, shifting the slots in between one to the right */
+void MoveNamedValueToSlot(int* sources, char** names, int numSlots, int c, char* name){
+	int d;
+	for(d = c; d < numSlots; d++){
+		if(names[d] != NULL && strcmp(names[d], name) == 0){
+			int source = sources[d];
+			char* sourceName = names[d];
+			int m;
+			for(m = d; m > c; m--){
+				sources[m] = sources[m - 1];
+				names[m] = names[m - 1];
+			}
+			sources[c] = source;
+			names[c] = sourceName;
+			return;
+		}
+	}
+}
+
+/* Compute where each argument's value comes from. The given values start out in the order they were given;
+ * then the named ones are moved to the slots of the arguments with their names (first the required named
+ * arguments, which come first in the argument list, and then the optional named ones), and the defaults of
+ * optional named arguments which weren't given are inserted in their slots. Any remaining optional arguments
+ * get their defaults when they are bound. */
+BindingPlan* CreateBindingPlan(Argument** funcArgs, int numFuncArgs, void* key, VyParseTree* call){
+	/* There are at most as many slots as given values plus inserted defaults */
+	int maxSlots = ListTreeSize(call) - 1 + numFuncArgs;
+	BindingPlan* plan = malloc(sizeof(BindingPlan) + sizeof(int) * maxSlots);
+	plan->key = key;
+	int* sources = plan->sources;
+
+	/* Find the name of each given value (NULL if it isn't named) */
+	char** names = malloc(sizeof(char*) * maxSlots);
+	int numSlots = 0;
+	int i;
+	for(i = 1; i < ListTreeSize(call); i++){
+		VyParseTree* arg = GetListData(call, i);
+		if(IsNamedArgMarker(arg)){
+			continue;	
+		}
+
+		if(IsNamedArgMarker(GetListData(call, i - 1))){
+			names[numSlots] = GetStrData(GetListData(arg, 0));
+		}else{
+			names[numSlots] = NULL;
+		}
+		sources[numSlots] = numSlots;
+		numSlots++;
+	}
+
+	/* Move the required named arguments */
+	int c;
+	for(c = 0; c < numFuncArgs && IsNamedArg(funcArgs[c]); c++){
+		MoveNamedValueToSlot(sources, names, numSlots, c, funcArgs[c]->name);
+	}
+
+	/* Then the optional named ones */
+	int firstOptionalArg = 0;
+	while(firstOptionalArg < numFuncArgs && !IsOptionalArg(funcArgs[firstOptionalArg])){
+		firstOptionalArg++;	
+	}
+	for(c = firstOptionalArg; c < numFuncArgs && IsNamedArg(funcArgs[c]); c++){
+		MoveNamedValueToSlot(sources, names, numSlots, c, funcArgs[c]->name);
+	}
+
+	/* Insert the defaults of optional named arguments which weren't given (as long as the slots before them are filled) */
+	for(c = firstOptionalArg; c < numFuncArgs && IsNamedArg(funcArgs[c]) && c <= numSlots; c++){
+		if(c < numSlots && names[c] != NULL && strcmp(names[c], funcArgs[c]->name) == 0){
+			continue;	
+		}
+
+		int x;
+		for(x = numSlots; x > c; x--){
+			sources[x] = sources[x - 1];
+			names[x] = names[x - 1];
+		}
+		sources[c] = PLAN_DEFAULT;
+		names[c] = NULL;
+		numSlots++;
+	}
+
+	free(names);
+	plan->numSlots = numSlots;
+	return plan;
+}
+
 /***** Functions for running both built-in and native functions */
 
 /* Check the validity of a function's arguments */
@@ -110,75 +205,62 @@ char* CheckFunctionArguments(Argument** funcArgs, int funcNumArgs, VyObject* arg
 	return NULL;
 }
 
-/* Bind arguments to variables in the local scope */
-void CreateArgumentVariableBindings(Argument** funcArgs, int funcNumArgs, VyObject* args, int numArgs){
-
-	/* Bind all given values to variables */
+/* Bind arguments to the slots of a frame (the first slots of a frame are the arguments, in order) */
+void BindArguments(Scope* frame, Argument** funcArgs, int funcNumArgs, VyObject* args, int numArgs){
+	/* Bind all given values */
 	int i;
 	for(i = 0; i < numArgs; i++){
-		Argument* currArg = funcArgs[i];
-		char* argName = currArg->name;
-
-		/* If it is a rest argument, then put the rest of the arguments in a list and bind that list to the variable, then exit */
-		if(IsRestArg(currArg)){
+		/* If it is a rest argument, then put the rest of the arguments in a list and bind that list, then exit */
+		if(IsRestArg(funcArgs[i])){
 			/* Put the rest of the arguments in a list */
-			int nonRestArgs = i;
 			VyList** rest = CreateList();
 			int c;
-			for(c = nonRestArgs; c < numArgs; c++){
+			for(c = i; c < numArgs; c++){
 				rest = ListAppend(rest, args[c]);
 			}
 
-			/* Bind the list value to the name */
-			VyObject listVal = ToObject(rest);
-			SetVariable(GetLocalScope(), argName, listVal);
-
-			/* Exit this procedure, since there are no more arguments left to bind */
+			frame->values[i] = ToObject(rest);
 			return;
 		}
 
-		/* Otherwise, just set the variable */
-		SetVariable(GetLocalScope(), argName, args[i]);
+		frame->values[i] = args[i];
 	}
 
 	/* Now, bind optional arguments that haven't yet been bound */
 	for(i = numArgs; i < funcNumArgs; i++){
-		Argument* currArg = funcArgs[i];
-		SetVariable(GetLocalScope(), currArg->name, currArg->optArgDefault);
+		frame->values[i] = funcArgs[i]->optArgDefault;
 	} 
 }
 
 /* Evaluate a native function, which can be a macro too */
 VyObject EvalNativeFunctionOrMacro(Argument** funcArgs, int funcNumArgs, VyParseTree* code, Scope* scp, VyObject* args, int numArgs){
-	/* Push the previous scope on the scope stack and add a new scope for this function call */
-	PushScope(GetLocalScope());
-	SetLocalScope(CreateScope());
-
-	/* Since the arguments are valid, bind them to variables in the local */
-	CreateArgumentVariableBindings(funcArgs, funcNumArgs, args, numArgs);
+	/* Carve the frame for this call out of the frame stack; its parent is the closure of the function */
+	Scope frame;
+	if(!PushFrame(&frame, GetFrameLayout(code, funcArgs, funcNumArgs), scp)){
+		return ToObject(CreateError("Stack overflow.", NULL));
+	}
 
-	/* Set the current function scope */
-	SetCurrentFunctionScope(scp);
+	/* Since the arguments are valid, bind them to the frame's slots, and make it the local scope */
+	BindArguments(&frame, funcArgs, funcNumArgs, args, numArgs);
+	Scope* callerScope = GetLocalScope();
+	SetLocalScope(&frame);
 
 	/* Keep track of the last value, for this is what is returned */
 	VyObject lastValue;
 
-	/* Sequencially evaluate each expression and store the result in the last value */
+	/* Sequencially evaluate each expression and store the result in the last value, stopping on errors
+	 * (the code is the whole lambda, so the body starts after the keyword and the argument list) */
 	int i;
-	for(i = 0; i < ListTreeSize(code); i++){
+	for(i = 2; i < ListTreeSize(code); i++){
 		lastValue = Eval(GetListData(code, i)); 
-
-		/* If an error occurred, return it */
 		if(ObjType(lastValue) == VALERROR){
-			return lastValue;	
+			break;
 		}	
 	}
 
-	/* Delete the scope (NOTE: REMOVE THIS LATER WHEN GC COMES AROUND) */
-	DeleteScope(GetLocalScope());
-
-	/* Return to the previous scope */
-	SetLocalScope(PopScope());
+	/* Pop the frame and return to the previous scope */
+	PopFrame(&frame);
+	SetLocalScope(callerScope);
 
 	return lastValue;   
 
@@ -198,7 +280,12 @@ VyObject RunFunction(VyFunction** func, VyObject* args, int numArgs){
 	}
 
 	/* Evaluate the function by calling the function pointer in it */
-	return func[0]->EvalFunction(func, args, numArgs);
+	long start = TraceStart();
+	PushProfileFrame(func);
+	VyObject result = func[0]->EvalFunction(func, args, numArgs);
+	PopProfileFrame();
+	TraceEnd(TRACE_CALL, FunctionKey(func), 0, start);
+	return result;
 
 }
 
@@ -334,6 +421,15 @@ Argument** ParseFunctionArguments(VyParseTree* argList, int* storeNumArgs, char*
 			}
 		}
 
+		/* Make sure no two arguments have the same name */
+		int other;
+		for(other = 0; other < argumentsFilled; other++){
+			if(arg->name != NULL && argArray[other]->name != NULL && strcmp(argArray[other]->name, arg->name) == 0){
+				*errorStore = "Duplicate argument name.";
+				return NULL;
+			}
+		}
+
 		/* Make sure rest arguments are last */
 		if(IsRestArg(arg) && i != ListTreeSize(argList) - 1){
 			*errorStore = "Rest arguments must come last.";
@@ -404,6 +500,9 @@ Argument** ParseFunctionArguments(VyParseTree* argList, int* storeNumArgs, char*
 
 /* Parse a nameless function given a lambda list */
 VyObject ParseFunction(VyParseTree* code){
+	/* The function keeps the code */
+	RetainParseTree();
+
 	/* Parse the function arguments */
 	VyParseTree* args = GetListData(code, 1);
 	int numArguments = 0;
@@ -413,32 +512,16 @@ VyObject ParseFunction(VyParseTree* code){
 		return ToObject(CreateError(err, code));	
 	}
 
-	/* Take the rest of the expressions in the lambda as code */
-	VyParseTree* exprList = MakeListTree();
-	int i;
-	for(i = 2; i < ListTreeSize(code); i++){
-		AddToList(exprList, GetListData(code, i));  
-	}
-
-	/* Take variables from the current function scope and the local scope */
-	Scope* funcScope = GetCurrentFunctionScope();
-	Scope* localScope = GetLocalScope();
-
-	/* Make sure the local scope isn't the global scope */
-	if(localScope == GetGlobalScope()) {
-		localScope = NULL; 
-	}
-
-	/* Merge the two scopes to get the current function scope */
-	Scope* closureScope = MergeScopes(funcScope, localScope);
+	/* The function captures the variables it uses from the frame it is created in */
+	Scope* closureScope = CaptureClosure(GetFrameLayout(code, arguments, numArguments));
 
 	/* Create the function from the data gathered */
-	VyFunction** func = CreateNativeFunction(arguments, numArguments, exprList, closureScope);
+	VyFunction** func = CreateNativeFunction(arguments, numArguments, code, closureScope);
 	return ToObject(func);
 }
 
 /* Add a nameless function (from a lambda) to the function list, after giving it a name */
 void AddFunction(char* asName, VyFunction** func){
 	/* Add the function to the global scope */
-	AddVariable(GetGlobalScope(), CreateVariable(asName, ToObject(func)));
+	SetVariable(GetGlobalScope(), asName, ToObject(func));
 }
@@ -0,0 +1,228 @@
+#include "Vyion.h"
+
+/* The references of the object being written */
+__thread VyObject* dumpRefs = NULL;
+__thread int numDumpRefs = 0;
+__thread int dumpRefCapacity = 0;
+
+/* Write a number as a varint */
+void WriteVarint(FILE* file, unsigned long num){
+	while(num >= 0x80){
+		fputc((num & 0x7F) | 0x80, file);
+		num >>= 7;
+	}
+	fputc(num, file);
+}
+
+/* Add a reference of the object being written (unless it is to nothing) */
+void AddDumpRef(VyObject obj){
+	if(obj < 0){
+		return;
+	}
+
+	if(numDumpRefs == dumpRefCapacity){
+		dumpRefCapacity = (dumpRefCapacity == 0) ? 64 : dumpRefCapacity * 2;
+		dumpRefs = realloc(dumpRefs, sizeof(VyObject) * dumpRefCapacity);
+	}
+	dumpRefs[numDumpRefs++] = obj;
+}
+
+/* Add the values captured by a closure, returning the bytes of its record */
+int AddClosureRefs(Scope* scp){
+	if(scp == NULL){
+		return 0;
+	}
+
+	int i;
+	for(i = 0; i < scp->size; i++){
+		AddDumpRef(SlotValue(scp, i));
+	}
+	return sizeof(Scope) + (sizeof(char*) + sizeof(VyObject)) * scp->size;
+}
+
+/* Add the numbers in some code (and in what its infix forms were rewritten to) */
+void AddCodeRefs(VyParseTree* tree){
+	if(tree == NULL){
+		return;
+	}
+
+	if(tree->type == TREE_NUM){
+		AddDumpRef(ToObject(tree->data.num));
+	}
+	else if(tree->type == TREE_LIST || tree->type == TREE_REF){
+		int i;
+		for(i = 0; i < tree->data.list.length; i++){
+			AddCodeRefs(tree + tree->data.list.first + i);
+		}
+		if(tree->form == FORM_INFIX){
+			AddCodeRefs(tree->cache);
+		}
+	}
+}
+
+/* Find the references of an object, returning its size */
+int FindDumpRefs(VyObject obj){
+	numDumpRefs = 0;
+
+	int type = ObjType(obj);
+	void* data = *(void**) ObjData(obj);
+	int size = DataSize(type) + sizeof(int);
+
+	if(type == VALLIST){
+		VyList* list = data;
+		AddDumpRef(list->data);
+		if(list->next != NULL){
+			AddDumpRef(ToObject(list->next));
+		}
+	}
+	else if(type == VALNUM){
+		VyNumber* num = data;
+		size += NumberSize(num->type);
+		if(num->type == BIGINT){
+			size += sizeof(VyLimb) * ((BigIntNum*) num->data)->size;
+		}
+		else if(num->type == COMPLEX){
+			AddDumpRef(ToObject(((ComplexNum*) num->data)->real));
+			AddDumpRef(ToObject(((ComplexNum*) num->data)->imaginary));
+		}
+		else if(num->type == RATIO){
+			AddDumpRef(ToObject(((RatioNum*) num->data)->numerator));
+			AddDumpRef(ToObject(((RatioNum*) num->data)->denominator));
+		}
+	}
+	else if(type == VALFUNC){
+		size += AddClosureRefs(((VyFunction*) data)->scp);
+		AddCodeRefs(((VyFunction*) data)->code);
+	}
+	else if(type == VALMAC){
+		size += AddClosureRefs(((VyMacro*) data)->scp);
+		AddCodeRefs(((VyMacro*) data)->code);
+	}
+	else if(type == VALSYMB){
+		size += strlen(((VySymbol*) data)->ident) + 1;
+	}
+
+	return size;
+}
+
+/* Write a root */
+void WriteDumpRoot(FILE* file, VyObject obj, char* name){
+	WriteVarint(file, obj);
+	WriteVarint(file, strlen(name));
+	fputs(name, file);
+}
+
+/* Write the variables of a scope as roots, with a prefix before their names */
+int WriteDumpScopeRoots(FILE* file, Scope* scope, char* prefix){
+	int numRoots = 0;
+	int i;
+	for(i = 0; i < scope->size; i++){
+		VyObject val = SlotValue(scope, i);
+		if(val >= 0){
+			char* name = malloc(strlen(prefix) + strlen(scope->names[i]) + 1);
+			sprintf(name, "%s%s", prefix, scope->names[i]);
+			WriteDumpRoot(file, val, name);
+			free(name);
+			numRoots++;
+		}
+	}
+	return numRoots;
+}
+
+/* Write the roots, returning how many there are */
+int WriteDumpRoots(FILE* file){
+	int numRoots = WriteDumpScopeRoots(file, GetGlobalScope(), "global ");
+
+	int numModules;
+	Module* modules = GetModules(&numModules);
+	int i;
+	for(i = 0; i < numModules; i++){
+		if(modules[i].scope != GetGlobalScope()){
+			char* prefix = malloc(strlen(modules[i].path) + 16);
+			sprintf(prefix, "module %s: ", modules[i].path);
+			numRoots += WriteDumpScopeRoots(file, modules[i].scope, prefix);
+			free(prefix);
+		}
+	}
+
+	int numValues;
+	VyObject* values = GetFrameValues(&numValues);
+	for(i = 0; i < numValues; i++){
+		if(values[i] >= 0){
+			WriteDumpRoot(file, values[i], "stack");
+			numRoots++;
+		}
+	}
+	free(values);
+
+	VyObject originals[NUM_INLINE_BUILTINS];
+	int rebound[NUM_INLINE_BUILTINS];
+	GetInlineBuiltinState(originals, rebound);
+
+	VyObject kept[NUM_INLINE_BUILTINS + 3] = {ToObject(MakeTrueBool()), ToObject(MakeFalseBool()), GetBreakSignal()};
+	memcpy(kept + 3, originals, sizeof(originals));
+	for(i = 0; i < NUM_INLINE_BUILTINS + 3; i++){
+		if(kept[i] >= 0){
+			WriteDumpRoot(file, kept[i], "interpreter");
+			numRoots++;
+		}
+	}
+
+	return numRoots;
+}
+
+/* Write a heap dump */
+int WriteHeapDump(char* filename){
+	FILE* file = fopen(filename, "wb");
+	if(file == NULL){
+		return 0;
+	}
+
+	/* (Before the number of objects is found, in case the booleans don't exist yet) */
+	MakeTrueBool();
+	MakeFalseBool();
+
+	/* The header has fixed fields first, and the number of roots, which is only known once they are written,
+	 * in a varint padded to its full length */
+	VyMemHeap* heap = GetMemoryHeap();
+	char magic[8] = HEAP_DUMP_MAGIC;
+	fwrite(magic, 1, sizeof(magic), file);
+	WriteVarint(file, HEAP_DUMP_VERSION);
+	WriteVarint(file, heap->objectsOnHeap);
+	long rootsAt = ftell(file);
+	fwrite("\x80\x80\x80\x80\x00", 1, 5, file);
+
+	VyObject obj;
+	for(obj = 0; obj < heap->objectsOnHeap; obj++){
+		int size = FindDumpRefs(obj);
+		fputc(ObjType(obj), file);
+		WriteVarint(file, size);
+		WriteVarint(file, numDumpRefs);
+
+		int i;
+		for(i = 0; i < numDumpRefs; i++){
+			WriteVarint(file, dumpRefs[i]);
+		}
+	}
+
+	unsigned int numRoots = WriteDumpRoots(file);
+	unsigned char padded[5] = {(numRoots & 0x7F) | 0x80, ((numRoots >> 7) & 0x7F) | 0x80, ((numRoots >> 14) & 0x7F) | 0x80,
+			((numRoots >> 21) & 0x7F) | 0x80, numRoots >> 28};
+	fseek(file, rootsAt, SEEK_SET);
+	fwrite(padded, 1, sizeof(padded), file);
+
+	int written = !ferror(file);
+	return (fclose(file) == 0) && written;
+}
+
+/* Dump the heap to the file a symbol names */
+VyObject HeapDump(VyFunction** f, VyObject* args, int numArgs){
+	if(ObjType(args[0]) != VALSYMB){
+		return ToObject(CreateError("heap-dump takes the name of the file to write to.", NULL));
+	}
+
+	if(!WriteHeapDump(GetSymbolString(ObjData(args[0])))){
+		return ToObject(CreateError("Couldn't write the heap dump.", NULL));
+	}
+	return ToObject(MakeTrueBool());
+}
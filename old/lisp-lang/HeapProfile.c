@@ -0,0 +1,238 @@
+#include "Vyion.h"
+
+/* The number of types of objects (see ObjType.h) */
+#define NUM_TYPES (VALFLOW + 1)
+
+/* How many sites each table of the report shows */
+#define TOP_SITES 15
+
+/* The names of the types of objects */
+char* typeNames[NUM_TYPES] = {"number", "function", "list", "symbol", "boolean", "macro", "error", "flow"};
+
+/* Whether the profiler is on, how many allocations a sample stands for, and how many are left until the next */
+int heapProfiling = 0;
+int sampleRate = 1;
+int untilSample = 0;
+
+/* The state of the random number generator which spaces the samples (a xorshift generator) */
+unsigned int sampleRandom = 2463534242u;
+
+/* The innermost call being evaluated on this thread (or NULL) */
+__thread VyParseTree* allocationSite = NULL;
+
+/* A site, with the number of objects of each type sampled there */
+typedef struct {
+	char* name;
+	unsigned int hash;
+	long samples[NUM_TYPES];
+	long total;
+	long bytes;
+} AllocationSite;
+
+/* The sites, in an open addressed table (its size is a power of two) */
+AllocationSite* allocationSites = NULL;
+int siteCapacity = 0;
+int numSites = 0;
+long numSampled = 0;
+
+/* Set the allocation site. Code from macro expansions has no position, so while profiling, such a site is
+ * passed over, and what it allocates is put down to the nearest site around it that does have one. (Since the
+ * sites passed over are never the current site, restoring a site is never passed over.) */
+VyParseTree* SetAllocationSite(VyParseTree* site){
+	VyParseTree* previous = allocationSite;
+	if(heapProfiling && site != NULL){
+		Position pos;
+		if(!GetTreePosition(site, &pos)){
+			return previous;
+		}
+	}
+	allocationSite = site;
+	return previous;
+}
+
+/* Describe a site by its file and position and the name it calls (so that sites in different files are apart) */
+char* NameSite(VyParseTree* site){
+	if(site == NULL){
+		return strdup("[outside any call]");
+	}
+
+	char* head = "...";
+	if(site->type == TREE_LIST && ListTreeSize(site) > 0 && ListTreeHead(site)->type == TREE_IDENT){
+		head = GetStrData(ListTreeHead(site));
+	}
+
+	char* file = TreeModuleName(site);
+	if(file == NULL){
+		file = "?";
+	}
+
+	Position pos;
+	char* name = malloc(strlen(file) + strlen(head) + 40);
+	if(GetTreePosition(site, &pos)){
+		sprintf(name, "%s:%d:%d (%s ...)", file, pos.line + 1, pos.character + 1, head);
+	}else{
+		sprintf(name, "%s:?:? (%s ...)", file, head);
+	}
+	return name;
+}
+
+/* Hash the name of a site */
+unsigned int HashSiteName(char* name){
+	unsigned int hash = 2166136261u;
+	for(; *name != '\0'; name++){
+		hash = (hash ^ (unsigned char) *name) * 16777619u;
+	}
+	return hash;
+}
+
+/* Find the site with a name, adding it if it isn't there (the name is then kept by the table) */
+AllocationSite* FindSite(char* name){
+	if(2 * (numSites + 1) > siteCapacity){
+		AllocationSite* old = allocationSites;
+		int oldCapacity = siteCapacity;
+
+		siteCapacity = (siteCapacity == 0) ? 64 : siteCapacity * 2;
+		allocationSites = calloc(siteCapacity, sizeof(AllocationSite));
+
+		int i;
+		for(i = 0; i < oldCapacity; i++){
+			if(old[i].name != NULL){
+				int slot = old[i].hash & (siteCapacity - 1);
+				while(allocationSites[slot].name != NULL){
+					slot = (slot + 1) & (siteCapacity - 1);
+				}
+				allocationSites[slot] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	unsigned int hash = HashSiteName(name);
+	int slot = hash & (siteCapacity - 1);
+	while(allocationSites[slot].name != NULL &&
+			(allocationSites[slot].hash != hash || strcmp(allocationSites[slot].name, name) != 0)){
+		slot = (slot + 1) & (siteCapacity - 1);
+	}
+
+	if(allocationSites[slot].name == NULL){
+		allocationSites[slot].name = name;
+		allocationSites[slot].hash = hash;
+		numSites++;
+	}else{
+		free(name);
+	}
+	return &allocationSites[slot];
+}
+
+/* Pick how many allocations there are until the next sample: on average, the rate */
+int NextSampleInterval(){
+	if(sampleRate <= 1){
+		return 1;
+	}
+
+	sampleRandom ^= sampleRandom << 13;
+	sampleRandom ^= sampleRandom >> 17;
+	sampleRandom ^= sampleRandom << 5;
+	return 1 + sampleRandom % (2 * sampleRate - 1);
+}
+
+/* Note an allocation, and sample it if its turn has come */
+void NoteAllocation(int type){
+	if(!heapProfiling || --untilSample > 0){
+		return;
+	}
+	untilSample = NextSampleInterval();
+
+	AllocationSite* site = FindSite(NameSite(allocationSite));
+	site->samples[type]++;
+	site->total++;
+	site->bytes += DataSize(type) + sizeof(int);
+	numSampled++;
+}
+
+/* Compare sites by their bytes, and by their objects (most first) */
+int CompareSiteBytes(const void* a, const void* b){
+	long diff = ((AllocationSite*) b)->bytes - ((AllocationSite*) a)->bytes;
+	return (diff > 0) - (diff < 0);
+}
+int CompareSiteObjects(const void* a, const void* b){
+	long diff = ((AllocationSite*) b)->total - ((AllocationSite*) a)->total;
+	return (diff > 0) - (diff < 0);
+}
+
+/* Print the sites which allocated the most, in some order */
+void PrintTopSites(AllocationSite* sorted, int numSorted, long totalBytes, char* title){
+	fprintf(stderr, "%s:\n", title);
+	fprintf(stderr, "%12s %7s %12s %7s  %-36s %s\n", "objects", "objs%", "bytes", "bytes%", "site", "types");
+
+	int i;
+	for(i = 0; i < numSorted && i < TOP_SITES; i++){
+		AllocationSite* site = &sorted[i];
+		fprintf(stderr, "%12ld %6.2f%% %12ld %6.2f%%  %-36s", site->total * sampleRate, 100.0 * site->total / numSampled,
+				site->bytes * sampleRate, 100.0 * site->bytes / totalBytes, site->name);
+
+		int type;
+		for(type = 0; type < NUM_TYPES; type++){
+			if(site->samples[type] > 0){
+				fprintf(stderr, " %s %.0f%%", typeNames[type], 100.0 * site->samples[type] / site->total);
+			}
+		}
+		fprintf(stderr, "\n");
+	}
+}
+
+/* Print the report of the allocations sampled so far */
+void PrintHeapProfile(){
+	long totalBytes = 0;
+	AllocationSite* sorted = malloc(sizeof(AllocationSite) * (numSites + 1));
+	int numSorted = 0;
+	int i;
+	for(i = 0; i < siteCapacity; i++){
+		if(allocationSites[i].name != NULL){
+			sorted[numSorted++] = allocationSites[i];
+			totalBytes += allocationSites[i].bytes;
+		}
+	}
+
+	fprintf(stderr, "\n--- Heap profile: %ld allocations sampled, about one in %d (estimated %ld objects, %ld bytes) ---\n",
+			numSampled, sampleRate, numSampled * sampleRate, totalBytes * sampleRate);
+	if(numSampled > 0){
+		qsort(sorted, numSorted, sizeof(AllocationSite), &CompareSiteBytes);
+		PrintTopSites(sorted, numSorted, totalBytes, "Sites by bytes");
+
+		qsort(sorted, numSorted, sizeof(AllocationSite), &CompareSiteObjects);
+		PrintTopSites(sorted, numSorted, totalBytes, "Sites by objects");
+	}
+	free(sorted);
+}
+
+/* Stop profiling, and print the report */
+void StopHeapProfiler(){
+	if(!heapProfiling){
+		return;
+	}
+	heapProfiling = 0;
+	PrintHeapProfile();
+}
+
+/* Start profiling */
+void StartHeapProfiler(int rate){
+	sampleRate = (rate > 1) ? rate : 1;
+	untilSample = NextSampleInterval();
+
+	/* The report is also made if the program exits early (errors exit from wherever they are handled) */
+	atexit(&StopHeapProfiler);
+
+	heapProfiling = 1;
+}
+
+/* Print the report so far, returning whether there was one to print */
+VyObject HeapProfile(VyFunction** f, VyObject* args, int numArgs){
+	if(!heapProfiling){
+		fprintf(stderr, "The allocation profiler is off (it is turned on with --heap-profile RATE).\n");
+		return ToObject(MakeFalseBool());
+	}
+
+	PrintHeapProfile();
+	return ToObject(MakeTrueBool());
+}
@@ -0,0 +1,594 @@
+#include "Vyion.h"
+
+/* An image starts with this, followed by the version of the format */
+#define IMAGE_MAGIC "VYIMAGE"
+#define IMAGE_VERSION 3
+
+/* In an image, a pointer is stored as the offset of what it points to (0 is NULL, since the header is there)... */
+#define TO_OFFSET(offset) ((void*)(long)(offset))
+#define FROM_OFFSET(base, ptr) ((ptr) == NULL ? NULL : (void*)((char*)(base) + (long)(ptr)))
+
+/* ...and a reference to an object (a pointer to its data pointer) is stored as its ID plus one */
+#define TO_REF(ptr) ((ptr) == NULL ? NULL : (void*)(long)(ToObject(ptr) + 1))
+#define FROM_REF(ptr) ((ptr) == NULL ? NULL : ObjData((long)(ptr) - 1))
+
+/* The evaluator of native functions isn't in the table of builtins, so it gets a place of its own */
+#define NATIVE_FUNCTION -1
+
+/* The header of an image, which everything else is found from */
+typedef struct {
+	char magic[8];
+	int version;
+	int pointerSize;
+	int numBuiltins;
+
+	/* The objects: their types (a char each), and the heap they are laid out on */
+	int numObjects;
+	int idMapSize;
+	int heapSize;
+	long types;
+	long heap;
+
+	/* The parse trees (the offsets of their blocks) */
+	int numTrees;
+	long trees;
+
+	/* The global variables, the modules, and the cells of boxed variables */
+	int numGlobals;
+	long globals;
+	int numModules;
+	long modules;
+	int numCells;
+	long cells;
+
+	/* The original inline builtins and whether they were rebound, and the infix operators */
+	long inlineOriginals;
+	long inlineRebound;
+	int numOperators;
+	long operators;
+
+	/* The true and false values, the object loops break with, and the number of the last unique symbol */
+	VyObject trueBool;
+	VyObject falseBool;
+	VyObject breakSignal;
+	int symbolCounter;
+} ImageHeader;
+
+/* A global variable */
+typedef struct {
+	long name;
+	VyObject value;
+} ImageVariable;
+
+/* A module, with the variables of its namespace (numVariables is -1 if that is the global scope) */
+typedef struct {
+	long path;
+	int numVariables;
+	long variables;
+} ImageModule;
+
+/* An infix operator */
+typedef struct {
+	long name;
+	int precedence;
+	int rightAssociative;
+} ImageOperator;
+
+/***** Saving images *****/
+
+/* An image being put together in memory */
+typedef struct {
+	char* data;
+	long size;
+	long capacity;
+
+	/* The trees written so far, and where (functions created by the same code share it, so it is written once) */
+	VyParseTree** trees;
+	long* treeOffsets;
+	int numTrees;
+	int treeCapacity;
+} ImageWriter;
+
+/* Append data to the image (or zeros, if it is NULL), aligned for any type, and return its offset. Since the
+ * image may move, pointers into it are only good until the next write. */
+long WriteImageData(ImageWriter* image, void* data, long size){
+	long offset = (image->size + 7) & ~7L;
+	while(offset + size > image->capacity){
+		image->capacity *= 2;
+		image->data = realloc(image->data, image->capacity);
+	}
+
+	memset(image->data + image->size, 0, offset - image->size);
+	if(data != NULL){
+		memcpy(image->data + offset, data, size);
+	}else{
+		memset(image->data + offset, 0, size);
+	}
+
+	image->size = offset + size;
+	return offset;
+}
+
+/* Write a string */
+long WriteImageString(ImageWriter* image, char* str){
+	if(str == NULL){
+		return 0;
+	}
+	return WriteImageData(image, str, strlen(str) + 1);
+}
+
+/* Write a copy of a tree, with its numbers and error messages replaced, and return the offset of its block */
+long WriteImageTree(ImageWriter* image, VyParseTree* tree){
+	if(tree == NULL){
+		return 0;
+	}
+
+	int i;
+	for(i = 0; i < image->numTrees; i++){
+		if(image->trees[i] == tree){
+			return image->treeOffsets[i];
+		}
+	}
+
+	/* Copying the tree leaves out the cached data, and makes it a tree of its own even if it is a part of one */
+	VyParseTree* copy = CopyParseTree(tree);
+	int size;
+	void* block = GetTreeBlock(copy, &size);
+	long offset = WriteImageData(image, block, size);
+
+	int numNodes;
+	TreeInBlock(image->data + offset, &numNodes);
+	for(i = 0; i < numNodes; i++){
+		if(copy[i].type == TREE_NUM){
+			TreeInBlock(image->data + offset, &numNodes)[i].data.num = TO_REF(copy[i].data.num);
+		}
+		else if(copy[i].type == TREE_ERROR){
+			long message = WriteImageString(image, copy[i].data.message);
+			TreeInBlock(image->data + offset, &numNodes)[i].data.message = TO_OFFSET(message);
+		}
+	}
+	DeleteParseTree(copy);
+
+	if(image->numTrees == image->treeCapacity){
+		image->treeCapacity = (image->treeCapacity == 0) ? 64 : image->treeCapacity * 2;
+		image->trees = realloc(image->trees, sizeof(VyParseTree*) * image->treeCapacity);
+		image->treeOffsets = realloc(image->treeOffsets, sizeof(long) * image->treeCapacity);
+	}
+	image->trees[image->numTrees] = tree;
+	image->treeOffsets[image->numTrees] = offset;
+	image->numTrees++;
+
+	return offset;
+}
+
+/* Write the arguments of a function or macro */
+long WriteImageArguments(ImageWriter* image, Argument** args, int numArgs){
+	if(args == NULL){
+		return 0;
+	}
+
+	Argument** offsets = malloc(sizeof(Argument*) * numArgs);
+	int i;
+	for(i = 0; i < numArgs; i++){
+		Argument arg = *args[i];
+		arg.name = TO_OFFSET(WriteImageString(image, args[i]->name));
+		offsets[i] = TO_OFFSET(WriteImageData(image, &arg, sizeof(Argument)));
+	}
+
+	long offset = WriteImageData(image, offsets, sizeof(Argument*) * numArgs);
+	free(offsets);
+	return offset;
+}
+
+/* Write the closure of a function or macro (the values are IDs and boxes, which stay the same) */
+long WriteImageClosure(ImageWriter* image, Scope* scp){
+	if(scp == NULL){
+		return 0;
+	}
+
+	char** names = malloc(sizeof(char*) * scp->size);
+	int i;
+	for(i = 0; i < scp->size; i++){
+		names[i] = TO_OFFSET(WriteImageString(image, scp->names[i]));
+	}
+
+	Scope closure = *scp;
+	closure.names = TO_OFFSET(WriteImageData(image, names, sizeof(char*) * scp->size));
+	closure.values = TO_OFFSET(WriteImageData(image, scp->values, sizeof(VyObject) * scp->size));
+	closure.capacity = scp->size;
+	closure.overflow = closure.parent = NULL;
+	free(names);
+
+	return WriteImageData(image, &closure, sizeof(Scope));
+}
+
+/* Write the data of a number */
+long WriteImageNumber(ImageWriter* image, VyNumber* num){
+	if(num->type == BIGINT){
+		BigIntNum big = *(BigIntNum*) num->data;
+		big.limbs = TO_OFFSET(WriteImageData(image, big.limbs, sizeof(VyLimb) * big.size));
+		return WriteImageData(image, &big, sizeof(BigIntNum));
+	}
+	else if(num->type == COMPLEX){
+		ComplexNum complex = *(ComplexNum*) num->data;
+		complex.real = TO_REF(complex.real);
+		complex.imaginary = TO_REF(complex.imaginary);
+		return WriteImageData(image, &complex, sizeof(ComplexNum));
+	}
+	else if(num->type == RATIO){
+		RatioNum ratio = *(RatioNum*) num->data;
+		ratio.numerator = TO_REF(ratio.numerator);
+		ratio.denominator = TO_REF(ratio.denominator);
+		return WriteImageData(image, &ratio, sizeof(RatioNum));
+	}
+	return WriteImageData(image, num->data, NumberSize(num->type));
+}
+
+/* Write what an object refers to outside the heap, and replace its pointers in the image's copy of the heap
+ * (at the given offset). Returns 0 if the object can't be saved. */
+int WriteImageObject(ImageWriter* image, long heapOffset, VyObject obj){
+	void* data = *(void**) ObjData(obj);
+	long at = heapOffset + ((char*) data - (char*) GetMemoryHeap()->heapBase);
+	int type = ObjType(obj);
+
+	if(type == VALLIST){
+		((VyList*)(image->data + at))->next = TO_REF(((VyList*) data)->next);
+	}
+	else if(type == VALNUM){
+		long num = WriteImageNumber(image, data);
+		((VyNumber*)(image->data + at))->data = TO_OFFSET(num);
+	}
+	else if(type == VALFUNC){
+		VyFunction* func = data;
+		long builtin = (func->EvalFunction == &EvalNativeFunction) ? NATIVE_FUNCTION : FindBuiltin(func->EvalFunction);
+		if(builtin == -1 && func->EvalFunction != &EvalNativeFunction){
+			return 0;
+		}
+
+		long args = WriteImageArguments(image, func->args, func->numArgs);
+		long code = WriteImageTree(image, func->code);
+		long scp = WriteImageClosure(image, func->scp);
+
+		VyFunction* saved = (VyFunction*)(image->data + at);
+		saved->EvalFunction = TO_OFFSET(builtin);
+		saved->args = TO_OFFSET(args);
+		saved->code = TO_OFFSET(code);
+		saved->scp = TO_OFFSET(scp);
+	}
+	else if(type == VALMAC){
+		VyMacro* mac = data;
+		long args = WriteImageArguments(image, mac->args, mac->numArgs);
+		long code = WriteImageTree(image, mac->code);
+		long scp = WriteImageClosure(image, mac->scp);
+
+		VyMacro* saved = (VyMacro*)(image->data + at);
+		saved->args = TO_OFFSET(args);
+		saved->code = TO_OFFSET(code);
+		saved->scp = TO_OFFSET(scp);
+	}
+	else if(type == VALSYMB){
+		long ident = WriteImageString(image, ((VySymbol*) data)->ident);
+		((VySymbol*)(image->data + at))->ident = TO_OFFSET(ident);
+	}
+	else if(type == VALERROR){
+		long message = WriteImageString(image, ((VyError*) data)->message);
+		long expr = WriteImageTree(image, ((VyError*) data)->expr);
+
+		VyError* saved = (VyError*)(image->data + at);
+		saved->message = TO_OFFSET(message);
+		saved->expr = TO_OFFSET(expr);
+	}
+	else if(type == VALFLOW){
+		/* Flow control objects are only used while a form is evaluated (the tag of a go is in its code) */
+		((VyFlowControl*)(image->data + at))->data = NULL;
+	}
+
+	return 1;
+}
+
+/* Write the variables of a scope */
+long WriteImageScope(ImageWriter* image, Scope* scope){
+	ImageVariable* variables = malloc(sizeof(ImageVariable) * (scope->size + 1));
+	int i;
+	for(i = 0; i < scope->size; i++){
+		variables[i].name = WriteImageString(image, scope->names[i]);
+		variables[i].value = scope->values[i];
+	}
+	long offset = WriteImageData(image, variables, sizeof(ImageVariable) * scope->size);
+	free(variables);
+	return offset;
+}
+
+/* Save an image */
+int SaveImage(char* filename){
+	VyMemHeap* heap = GetMemoryHeap();
+
+	ImageWriter image;
+	image.capacity = heap->usedSpace * 2 + 64 * 1024;
+	image.data = malloc(image.capacity);
+	image.size = 0;
+	image.trees = NULL;
+	image.treeOffsets = NULL;
+	image.numTrees = image.treeCapacity = 0;
+
+	/* Make room for the header, which is filled in as the rest is written */
+	ImageHeader header;
+	memset(&header, 0, sizeof(ImageHeader));
+	WriteImageData(&image, NULL, sizeof(ImageHeader));
+
+	memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+	header.version = IMAGE_VERSION;
+	header.pointerSize = sizeof(void*);
+	header.numBuiltins = NumBuiltins();
+
+	/* (Before the heap is written, in case the booleans don't exist yet) */
+	header.trueBool = ToObject(MakeTrueBool());
+	header.falseBool = ToObject(MakeFalseBool());
+
+	/* Write the heap as it is, then go through the objects replacing their pointers */
+	header.numObjects = heap->objectsOnHeap;
+	header.idMapSize = heap->idMapSize;
+	header.heapSize = heap->usedSpace;
+
+	char* types = malloc(heap->objectsOnHeap + 1);
+	int id;
+	for(id = 0; id < heap->objectsOnHeap; id++){
+		types[id] = ObjType(id);
+	}
+	header.types = WriteImageData(&image, types, heap->objectsOnHeap);
+	header.heap = WriteImageData(&image, heap->heapBase, heap->usedSpace);
+	free(types);
+
+	int saved = 1;
+	for(id = 0; id < heap->objectsOnHeap && saved; id++){
+		saved = WriteImageObject(&image, header.heap, id);
+	}
+
+	header.numTrees = image.numTrees;
+	header.trees = WriteImageData(&image, image.treeOffsets, sizeof(long) * image.numTrees);
+
+	/* The global scope and the modules */
+	header.numGlobals = GetGlobalScope()->size;
+	header.globals = WriteImageScope(&image, GetGlobalScope());
+
+	Module* modules = GetModules(&header.numModules);
+	ImageModule* savedModules = malloc(sizeof(ImageModule) * (header.numModules + 1));
+	int i;
+	for(i = 0; i < header.numModules; i++){
+		savedModules[i].path = WriteImageString(&image, modules[i].path);
+		if(modules[i].scope == GetGlobalScope()){
+			savedModules[i].numVariables = -1;
+			savedModules[i].variables = 0;
+		}else{
+			savedModules[i].numVariables = modules[i].scope->size;
+			savedModules[i].variables = WriteImageScope(&image, modules[i].scope);
+		}
+	}
+	header.modules = WriteImageData(&image, savedModules, sizeof(ImageModule) * header.numModules);
+	free(savedModules);
+
+	VyObject* cells = GetCells(&header.numCells);
+	header.cells = WriteImageData(&image, cells, sizeof(VyObject) * header.numCells);
+
+	/* The rest of the interpreter's state */
+	VyObject originals[NUM_INLINE_BUILTINS];
+	int rebound[NUM_INLINE_BUILTINS];
+	GetInlineBuiltinState(originals, rebound);
+	header.inlineOriginals = WriteImageData(&image, originals, sizeof(originals));
+	header.inlineRebound = WriteImageData(&image, rebound, sizeof(rebound));
+
+	InfixOperator* operators = GetInfixOperators(&header.numOperators);
+	ImageOperator* savedOperators = malloc(sizeof(ImageOperator) * (header.numOperators + 1));
+	for(i = 0; i < header.numOperators; i++){
+		savedOperators[i].name = WriteImageString(&image, operators[i].name);
+		savedOperators[i].precedence = operators[i].precedence;
+		savedOperators[i].rightAssociative = operators[i].rightAssociative;
+	}
+	header.operators = WriteImageData(&image, savedOperators, sizeof(ImageOperator) * header.numOperators);
+	free(savedOperators);
+
+	header.breakSignal = GetBreakSignal();
+	header.symbolCounter = GetSymbolCounter();
+	memcpy(image.data, &header, sizeof(ImageHeader));
+
+	/* Write the file */
+	if(saved){
+		FILE* file = fopen(filename, "wb");
+		saved = file != NULL && fwrite(image.data, 1, image.size, file) == image.size;
+		if(file != NULL && fclose(file) != 0){
+			saved = 0;
+		}
+	}
+
+	free(image.data);
+	free(image.trees);
+	free(image.treeOffsets);
+	return saved;
+}
+
+/***** Loading images *****/
+
+/* Fix up the numbers and error messages of a tree */
+void LoadImageTree(char* base, long offset){
+	int numNodes;
+	VyParseTree* nodes = TreeInBlock(base + offset, &numNodes);
+
+	int i;
+	for(i = 0; i < numNodes; i++){
+		if(nodes[i].type == TREE_NUM){
+			nodes[i].data.num = FROM_REF(nodes[i].data.num);
+		}
+		else if(nodes[i].type == TREE_ERROR){
+			nodes[i].data.message = FROM_OFFSET(base, nodes[i].data.message);
+		}
+	}
+}
+
+/* Find a tree from the offset of its block */
+VyParseTree* FindImageTree(char* base, VyParseTree* offset){
+	int numNodes;
+	return (offset == NULL) ? NULL : TreeInBlock(FROM_OFFSET(base, offset), &numNodes);
+}
+
+/* Fix up the arguments of a function or macro */
+Argument** LoadImageArguments(char* base, Argument** offset, int numArgs){
+	Argument** args = FROM_OFFSET(base, offset);
+	if(args != NULL){
+		int i;
+		for(i = 0; i < numArgs; i++){
+			args[i] = FROM_OFFSET(base, args[i]);
+			args[i]->name = FROM_OFFSET(base, args[i]->name);
+		}
+	}
+	return args;
+}
+
+/* Fix up a closure */
+Scope* LoadImageClosure(char* base, Scope* offset){
+	Scope* scp = FROM_OFFSET(base, offset);
+	if(scp != NULL){
+		scp->names = FROM_OFFSET(base, scp->names);
+		scp->values = FROM_OFFSET(base, scp->values);
+
+		int i;
+		for(i = 0; i < scp->size; i++){
+			scp->names[i] = FROM_OFFSET(base, scp->names[i]);
+		}
+	}
+	return scp;
+}
+
+/* Fix up the pointers of an object */
+void LoadImageObject(char* base, VyObject obj){
+	int type = ObjType(obj);
+
+	if(type == VALLIST){
+		VyList** list = ObjData(obj);
+		list[0]->next = FROM_REF(list[0]->next);
+	}
+	else if(type == VALNUM){
+		VyNumber** num = ObjData(obj);
+		num[0]->data = FROM_OFFSET(base, num[0]->data);
+
+		if(num[0]->type == BIGINT){
+			BigIntNum* big = num[0]->data;
+			big->limbs = FROM_OFFSET(base, big->limbs);
+		}
+		else if(num[0]->type == COMPLEX){
+			ComplexNum* complex = num[0]->data;
+			complex->real = FROM_REF(complex->real);
+			complex->imaginary = FROM_REF(complex->imaginary);
+		}
+		else if(num[0]->type == RATIO){
+			RatioNum* ratio = num[0]->data;
+			ratio->numerator = FROM_REF(ratio->numerator);
+			ratio->denominator = FROM_REF(ratio->denominator);
+		}
+	}
+	else if(type == VALFUNC){
+		VyFunction** func = ObjData(obj);
+		long builtin = (long) func[0]->EvalFunction;
+		func[0]->EvalFunction = (builtin == NATIVE_FUNCTION) ? &EvalNativeFunction : GetBuiltin(builtin)->function;
+		func[0]->args = LoadImageArguments(base, func[0]->args, func[0]->numArgs);
+		func[0]->code = FindImageTree(base, func[0]->code);
+		func[0]->scp = LoadImageClosure(base, func[0]->scp);
+	}
+	else if(type == VALMAC){
+		VyMacro** mac = ObjData(obj);
+		mac[0]->args = LoadImageArguments(base, mac[0]->args, mac[0]->numArgs);
+		mac[0]->code = FindImageTree(base, mac[0]->code);
+		mac[0]->scp = LoadImageClosure(base, mac[0]->scp);
+	}
+	else if(type == VALSYMB){
+		VySymbol** symb = ObjData(obj);
+		symb[0]->ident = FROM_OFFSET(base, symb[0]->ident);
+	}
+	else if(type == VALERROR){
+		VyError** error = ObjData(obj);
+		error[0]->message = FROM_OFFSET(base, error[0]->message);
+		error[0]->expr = FindImageTree(base, error[0]->expr);
+	}
+}
+
+/* Restore the variables of a scope */
+void LoadImageScope(char* base, long offset, int numVariables, Scope* scope){
+	ImageVariable* variables = (ImageVariable*)(base + offset);
+	int i;
+	for(i = 0; i < numVariables; i++){
+		AddVariable(scope, base + variables[i].name, variables[i].value);
+	}
+}
+
+/* Load an image */
+int LoadImage(char* filename){
+	int file = open(filename, O_RDONLY);
+	if(file < 0){
+		return 0;
+	}
+
+	/* Map the whole image (privately, so that fixing it up doesn't change the file) */
+	struct stat info;
+	char* base = MAP_FAILED;
+	if(fstat(file, &info) == 0 && info.st_size >= sizeof(ImageHeader)){
+		base = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	}
+	close(file);
+	if(base == MAP_FAILED){
+		return 0;
+	}
+
+	ImageHeader* header = (ImageHeader*) base;
+	if(memcmp(header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header->version != IMAGE_VERSION
+	   || header->pointerSize != sizeof(void*) || header->numBuiltins != NumBuiltins()
+	   || header->heap + header->heapSize > info.st_size){
+		munmap(base, info.st_size);
+		return 0;
+	}
+
+	/* Use the heap where it is */
+	if(!InitMemFrom(base + header->heap, header->heapSize, base + header->types, header->numObjects, header->idMapSize)){
+		return 0;
+	}
+	InitRegions();
+	InitScopes();
+
+	/* Fix the pointers up (the trees first, since objects find them by their blocks) */
+	long* trees = (long*)(base + header->trees);
+	int i;
+	for(i = 0; i < header->numTrees; i++){
+		LoadImageTree(base, trees[i]);
+	}
+
+	VyObject obj;
+	for(obj = 0; obj < header->numObjects; obj++){
+		LoadImageObject(base, obj);
+	}
+
+	/* Restore the global scope and the modules (the inline builtins are restored afterwards, so that this isn't
+	 * a rebinding) */
+	LoadImageScope(base, header->globals, header->numGlobals, GetGlobalScope());
+
+	ImageModule* modules = (ImageModule*)(base + header->modules);
+	for(i = 0; i < header->numModules; i++){
+		Scope* scope = GetGlobalScope();
+		if(modules[i].numVariables >= 0){
+			scope = CreateScope();
+			LoadImageScope(base, modules[i].variables, modules[i].numVariables, scope);
+		}
+		AddLoadedModule(base + modules[i].path, scope);
+	}
+	SetCells((VyObject*)(base + header->cells), header->numCells);
+
+	/* And the rest of the state */
+	SetInlineBuiltinState((VyObject*)(base + header->inlineOriginals), (int*)(base + header->inlineRebound));
+
+	ImageOperator* operators = (ImageOperator*)(base + header->operators);
+	for(i = 0; i < header->numOperators; i++){
+		DefineInfixOperator(base + operators[i].name, operators[i].precedence, operators[i].rightAssociative);
+	}
+
+	SetBooleans(ObjData(header->trueBool), ObjData(header->falseBool));
+	SetBreakSignal(header->breakSignal);
+	SetSymbolCounter(header->symbolCounter);
+	return 1;
+}
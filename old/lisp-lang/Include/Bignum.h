@@ -0,0 +1,67 @@
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include "Vyion.h"
+
+/* Arbitrary precision integers. Every integer starts out as a fixnum (an IntNum, which is just a C int), and
+ * only when an operation overflows the fixnum range is the result promoted to a bignum. A bignum keeps its sign
+ * separately from its magnitude, and the magnitude is an array of 32-bit limbs, least significant limb first.
+ *
+ * Bignums are always kept normalized: the most significant limb is never zero, and a value which fits into a
+ * fixnum is demoted back into one (see CreateIntegerFromBig() in Number.c). That way small integers never leave
+ * the fast path, and two equal integers always have the same representation.
+ *
+ * Multiplication picks an algorithm based on the size of the operands: schoolbook multiplication for small
+ * numbers, Karatsuba for medium sized ones, and Toom-3 for large ones. Division is Knuth's algorithm D, and the
+ * GCD uses Euclid's algorithm until the numbers fit in a machine word, and then finishes with a binary GCD.
+ *
+ * Unless otherwise noted, the functions here store their result in their first argument, which receives a
+ * freshly malloc'd limb array and must not alias any of the operands.
+ */
+
+/* A single limb, and a type wide enough to hold the product of two limbs */
+typedef unsigned int VyLimb;
+typedef unsigned long long VyDoubleLimb;
+
+#define LIMB_BITS 32
+
+/* Create bignums from machine integers and decimal digit strings (the digits must all be [0-9]) */
+void BigFromLong(BigIntNum*, long long);
+void BigFromDigits(BigIntNum*, char*, int);
+
+/* Make a bignum view of a fixnum without allocating (the limb array must have room for one limb) */
+void BigFromIntView(BigIntNum*, int, VyLimb*);
+
+/* Conversions back into machine types */
+int BigFitsInt(BigIntNum*);
+int BigFitsLong(BigIntNum*);
+long long BigToLong(BigIntNum*);
+double BigToDouble(BigIntNum*);
+
+/* Compare two bignums, returning -1, 0, or 1 */
+int BigCompare(BigIntNum*, BigIntNum*);
+
+/* Basic arithmetic */
+void BigAdd(BigIntNum*, BigIntNum*, BigIntNum*);
+void BigSubtract(BigIntNum*, BigIntNum*, BigIntNum*);
+void BigMultiply(BigIntNum*, BigIntNum*, BigIntNum*);
+
+/* Truncating division: store the quotient and remainder (either may be NULL) */
+void BigDivMod(BigIntNum*, BigIntNum*, BigIntNum*, BigIntNum*);
+
+/* The (non-negative) greatest common divisor */
+void BigGcd(BigIntNum*, BigIntNum*, BigIntNum*);
+
+/* Copy a bignum */
+void BigCopy(BigIntNum*, BigIntNum*);
+
+/* Convert to a decimal string (which should be freed) */
+char* BigToString(BigIntNum*);
+
+/* Free the limb array */
+void BigFree(BigIntNum*);
+
+/* Binary GCD of two machine words */
+unsigned long long BinaryGcd(unsigned long long, unsigned long long);
+
+#endif /* BIGNUM_H */
@@ -23,6 +23,9 @@ int IsFalse(VyBoolean**);
 VyBoolean** MakeTrueBool();
 VyBoolean** MakeFalseBool();
 
+/* Restore the true and false values (when loading an image) */
+void SetBooleans(VyBoolean**, VyBoolean**);
+
 /* Functions for non-short-circuiting boolean operations */
 VyBoolean** BoolAnd(VyBoolean**, VyBoolean**);
 VyBoolean** BoolOr(VyBoolean**, VyBoolean**);
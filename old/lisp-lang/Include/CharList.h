@@ -5,10 +5,11 @@
  * Like an expandable string. 
  */
 
-/* A list of characters which can be expanded (currently, a linked list) */
+/* A list of characters which can be expanded (a buffer which doubles in size as it fills) */
 struct CharList {
-	char val;
-	struct CharList* next;
+	char* chars;
+	int size;
+	int capacity;
 };
 
 /* Print the contents of the list to standard output */
@@ -29,6 +30,9 @@ char Get(CharList*, int);
 /* Convert the character list into a string */
 char* ToStr(CharList*);
 
+/* Empty the character list */
+void Clear(CharList*);
+
 /* Find the size of the character list */
 int Size(CharList*);
 
@@ -0,0 +1,45 @@
+#ifndef COMPILED_H
+#define COMPILED_H
+
+#include "Vyion.h"
+
+/* Included files are usually libraries which don't change between runs, so the first time one is included, the
+ * parse trees of its forms are saved to a compiled file next to it (VyionLib.v is compiled to VyionLib.vyc). As
+ * long as the source is unchanged (it has the same modification time and size as when it was compiled), later
+ * includes read the trees straight from the compiled file, without lexing or parsing anything.
+ *
+ * A compiled file is a header followed by the forms, in order. Each form is the block of its tree as it is in
+ * memory (see GetTreeBlock() in ParseTree.h), followed by the values of the numbers in it, since those are objects.
+ * A file is only written (under a temporary name, which is then renamed) once the whole source has been parsed
+ * without errors, so a compiled file which exists is always complete.
+ */
+
+/* A compiled file being read or written */
+typedef struct {
+	FILE* file;
+	char* path;
+
+	/* When writing, the file is put together in memory first */
+	char* data;
+	size_t size;
+} CompiledFile;
+
+/* Open the compiled file of a source file, if there is one which is up to date (or return NULL) */
+CompiledFile* OpenCompiledFile(char*);
+
+/* Read the tree of the next form (NULL after the last one) */
+VyParseTree* ReadCompiledForm(CompiledFile*);
+
+/* Start writing the compiled file of a source file (NULL if it can't be written) */
+CompiledFile* CreateCompiledFile(char*);
+
+/* Write the tree of a form (before it is evaluated, since that adds data to it) */
+void WriteCompiledForm(CompiledFile*, VyParseTree*);
+
+/* Finish writing a compiled file, keeping it only if the whole source was written */
+void FinishCompiledFile(CompiledFile*, int);
+
+/* Close a compiled file which was read */
+void CloseCompiledFile(CompiledFile*);
+
+#endif /* COMPILED_H */
@@ -0,0 +1,44 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "Vyion.h"
+
+/* Several interpreters can run at once in one process, each in a context with a thread of its own:
+ *     vyion --parallel a.v b.v c.v
+ *
+ * All of the state of an interpreter (its heap, scopes, modules, lexer and parser, regions, and so on) is kept
+ * in thread-local variables, so each thread which sets up the evaluator has an interpreter of its own, which
+ * shares no objects with any other, and runs without taking locks. The files of a context run one after another,
+ * just as they would in the main interpreter, and an error in one ends its context instead of the program.
+ *
+ * The profilers and the tracer measure the whole process, and images and the allocation counters are of one
+ * interpreter, so those are only for the main thread, and can't be used with --parallel.
+ */
+
+/* A context: the files it runs, and its thread */
+typedef struct {
+	char** files;
+	int numFiles;
+
+	/* The number of the context (the main thread's is 0) */
+	int number;
+
+	/* Whether all of the files ran without an error */
+	int succeeded;
+
+	pthread_t thread;
+} VyContext;
+
+/* Start running some files in a new context, returning it (or NULL if its thread couldn't be started) */
+VyContext* StartContext(char**, int);
+
+/* Wait for a context to finish and free it, returning whether its files ran without an error */
+int JoinContext(VyContext*);
+
+/* Stop the interpreter of this thread after an error: a context ends, and the main thread exits */
+void ExitInterpreter();
+
+/* The number of the context of this thread (0 for the main thread) */
+int ContextNumber();
+
+#endif /* CONTEXT_H */
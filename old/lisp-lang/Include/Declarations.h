@@ -24,14 +24,14 @@ typedef struct VySymbol		 VySymbol	;
 typedef struct VyMacro		 VyMacro	;
 
 typedef struct VyToken		 VyToken	;
+typedef struct VyReader		 VyReader	;
 typedef struct VyParseTree	 VyParseTree	;
 
 typedef struct Scope		 Scope		;
-typedef struct VarBinding	 VarBinding	;
-typedef struct ScopeStack	 ScopeStack	;
 typedef struct Argument		 Argument	;
 
 typedef struct VyMemHeap 	 VyMemHeap	;
+typedef struct VyRegion	 VyRegion	;
 
 typedef struct Position		 Position	;
 typedef struct CharList		 CharList	;
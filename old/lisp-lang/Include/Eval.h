@@ -7,6 +7,22 @@
  * evaluates the parse tree and returns a value for it.
  */
 
+/* A built-in function: its name, the number of arguments it takes, and its implementation */
+typedef struct {
+	char* name;
+	int numArgs;
+	VyObject (*function)(VyFunction**, VyObject*, int);
+} Builtin;
+
+/* Find the place of a builtin in the table of builtins from its implementation (or -1), or the builtin at a place */
+int FindBuiltin(VyObject (*)(VyFunction**, VyObject*, int));
+Builtin* GetBuiltin(int);
+int NumBuiltins();
+
+/* Get or restore the number of the last unique symbol generated */
+int GetSymbolCounter();
+void SetSymbolCounter(int);
+
 /* Expand a of macro */
 VyObject ExpandMacro(VyMacro**, VyParseTree*);
 
@@ -19,9 +35,31 @@ VyParseTree* ObjToParseTree(VyObject);
 /* Evaluate a quoted expression */
 VyObject QuotedEval(VyParseTree*, int);
 
+/* Evaluate a quote-substitutions form (its template is compiled the first time) */
+VyObject EvalTemplate(VyParseTree*);
+
+/* Give an error resulting from a call the call as its expression (if it has none yet) */
+VyObject LocateError(VyObject, VyParseTree*);
+
+/* Read, parse and evaluate a file (the second argument says whether it was included, since those are compiled) */
+void ProcessFile(char*, int);
+
+/* Set up the interpreter */
+int InitEvaluator();
+
+/* Evaluate a top-level form, and free what it used once it has been dealt with */
+VyObject EvalTopLevel(VyParseTree*);
+void FinishTopLevel(VyParseTree*);
+
 /* Handle an error */
 void HandleError(VyObject);
 
+/* Set whether the interpreter is in interactive REPL mode (in which errors are reported without exiting) */
+void SetReplMode(int);
+
+/* Whether an object is a fixnum (what indices and counts must be, since GetInt() only reads those) */
+int IsFixnum(VyObject);
+
 int StrEquals(char*, char*);
 
 #endif /* EVAL_H */
@@ -11,6 +11,7 @@
 /* Flow control types */
 #define FLOWGO 0
 #define FLOWRETURN 1
+#define FLOWBREAK 2
 
 struct VyFlowControl {
 	void* data;
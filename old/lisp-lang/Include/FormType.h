@@ -0,0 +1,43 @@
+#ifndef FORM_TYPE_H
+#define FORM_TYPE_H
+
+/* The different kinds of forms a list can be, depending on its head */
+
+/* Not classified yet */
+#define FORM_UNKNOWN	0
+
+/* A call to whatever the head evaluates to (a function or a macro) */
+#define FORM_CALL	1
+
+/* Keywords */
+#define FORM_LAMBDA	2
+#define FORM_MAMBDA	3
+#define FORM_SET	4
+#define FORM_GLOBAL	5
+#define FORM_IF		6
+#define FORM_QUOTE	7
+#define FORM_QUOTE_SUBST	8
+#define FORM_TAGBODY	9
+#define FORM_GO		10
+#define FORM_INFIX	11
+#define FORM_WHILE	12
+#define FORM_LOOP	13
+#define FORM_FOR_RANGE	14
+#define FORM_FOR_EACH	15
+#define FORM_BREAK	16
+#define FORM_TIME	17
+#define FORM_BENCH	18
+
+/* Calls to builtins which are evaluated inline while they are still bound to the original builtin (see Inline.h) */
+#define FORM_FIRST_INLINE	19
+#define FORM_ADD	19
+#define FORM_SUBTRACT	20
+#define FORM_LT		21
+#define FORM_EQ		22
+#define FORM_HEAD	23
+#define FORM_TAIL	24
+#define FORM_NTH	25
+#define FORM_NOT	26
+#define FORM_LAST_INLINE	26
+
+#endif /* FORM_TYPE_H */
@@ -36,6 +36,23 @@ struct Argument {
 
 };
 
+/* A binding plan says how the values given at a call site map onto a function's arguments. It depends only on the
+ * function's argument list and on which values at the call site are named, so it is computed once and cached on
+ * the call node (see SetTreeCache() in ParseTree.h). Slot i of the result gets the given value sources[i], or,
+ * if that is PLAN_DEFAULT, the default value of argument i. */
+#define PLAN_DEFAULT -1
+
+typedef struct {
+	/* What the plan was computed for (the function's code, or its argument list for builtins) */
+	void* key;
+
+	/* The number of slots to fill */
+	int numSlots;
+
+	/* Where each slot's value comes from */
+	int sources[];
+} BindingPlan;
+
 /* A function with its charactertics */
 struct VyFunction {
 	/* Function arguments */
@@ -85,6 +102,12 @@ VyObject EvalNativeFunctionOrMacro(Argument**, int, VyParseTree*, Scope*, VyObje
 /* Parse a function's arguments */
 Argument** ParseFunctionArguments(VyParseTree*, int*, char**);
 
+/* Whether a call site element is the ~ marking a named argument */
+int IsNamedArgMarker(VyParseTree*);
+
+/* Compute the plan for binding the values of a call to a function's arguments */
+BindingPlan* CreateBindingPlan(Argument**, int, void*, VyParseTree*);
+
 /* Check the arguments for validity */
 char* CheckFunctionArguments(Argument**, int, VyObject*, int);
 
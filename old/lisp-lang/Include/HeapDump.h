@@ -0,0 +1,34 @@
+#ifndef HEAP_DUMP_H
+#define HEAP_DUMP_H
+
+#include "Vyion.h"
+
+/* A heap dump is a snapshot of every object on the heap and what refers to what, for finding out what keeps
+ * memory alive (with the analyzer in tools/, which works out the objects each one retains):
+ *     (heap-dump 'file.vyheap)
+ *
+ * The format is compact: every number is an unsigned LEB128 varint (seven bits a byte, low bits first, with the
+ * top bit set on all bytes but the last). The file is:
+ *     the magic HEAP_DUMP_MAGIC (8 bytes), the version, the number of objects, and the number of roots (which is
+ *     written once the roots are, so its varint is padded to five bytes)
+ *     each object, in order of ID (so the first is object 0): its type (see ObjType.h), its size in bytes, the
+ *     number of objects it refers to, and their IDs
+ *     each root: the ID of the object, the length of its name, and the name (not null terminated)
+ *
+ * The size of an object is what it takes on the heap along with what it owns off it (the digits of a bignum, the
+ * text of a symbol, the record of a closure). The references are the element and the rest of a list, the values
+ * captured by the closure of a function or macro, the numbers in its code, and the parts of a complex number or
+ * ratio. The roots are the global variables and those of modules, named "global x" and "module path: x", the
+ * variables of the calls in progress ("stack"), and the objects the interpreter itself keeps ("interpreter").
+ */
+
+#define HEAP_DUMP_MAGIC "VYHEAP"
+#define HEAP_DUMP_VERSION 1
+
+/* Write a heap dump to a file, returning 0 if it can't */
+int WriteHeapDump(char*);
+
+/* The heap-dump builtin */
+VyObject HeapDump(VyFunction**, VyObject*, int);
+
+#endif /* HEAP_DUMP_H */
@@ -0,0 +1,37 @@
+#ifndef HEAP_PROFILE_H
+#define HEAP_PROFILE_H
+
+#include "Vyion.h"
+
+/* The allocation profiler finds out where in the program the heap goes:
+ *     vyion --heap-profile RATE program.v
+ *
+ * The evaluator keeps track of the allocation site, which is the innermost call (or lambda, quote-substitutions
+ * form, for-range or for-each loop, or macro call) being evaluated, leaving out code from macro expansions, which
+ * has no position of its own. While profiling, about one in RATE of the objects created is sampled (at random
+ * intervals, so that a loop which allocates in a fixed pattern can't hide a site), and counted towards the
+ * position of the site, as the lexer found it, along with the object's type. Each sample stands for RATE objects,
+ * so with a rate of 1, every object is counted and the counts are exact.
+ *
+ * At exit, or whenever the program calls (heap-profile), the sites which allocated the most bytes and the most
+ * objects are printed to stderr, each with the share of its objects of each type. A site is shown as the file
+ * (relative to the working directory), line and character it starts on and the name it calls, like
+ * lib.v:12:5 (cons ...), or with ? for the file if the code wasn't read from one (like code typed into the REPL).
+ */
+
+/* Start profiling, sampling one in so many allocations */
+void StartHeapProfiler(int);
+
+/* Stop profiling, and print the report (this is done at exit, if it hasn't been done yet) */
+void StopHeapProfiler();
+
+/* Set the allocation site, returning the one it replaces (which should be restored once the site is done) */
+VyParseTree* SetAllocationSite(VyParseTree*);
+
+/* Note the creation of an object of a type (this does nothing unless profiling) */
+void NoteAllocation(int);
+
+/* The heap-profile builtin, which prints the report so far */
+VyObject HeapProfile(VyFunction**, VyObject*, int);
+
+#endif /* HEAP_PROFILE_H */
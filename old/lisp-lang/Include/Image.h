@@ -0,0 +1,29 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "Vyion.h"
+
+/* A heap image is a snapshot of the interpreter, taken after some files (a library, usually) have been processed,
+ * from which another run can start instead of processing them again:
+ *     vyion --save-image lib.vyi VyionLib.v        Process VyionLib.v, then save the image.
+ *     vyion --load-image lib.vyi program.v         Start from the image, then process program.v.
+ *
+ * The image holds the objects, exactly as they are laid out on the heap, along with everything outside the heap
+ * which they refer to: strings, number data, argument lists, closures, and the code of functions and macros (each
+ * copied into a parse tree of its own). It also holds the global scope, the modules with their scopes, the cells of
+ * boxed variables, and the rest of the interpreter's state (the inline builtins, the infix operators, and so on).
+ *
+ * Inside the file, pointers are replaced by offsets from the start of the file, and references to objects by
+ * their IDs, so it doesn't matter where it is loaded. Loading maps the whole file into memory at once and fixes
+ * the pointers up where they are; the heap is used right where it was mapped, until it first needs to grow.
+ * Builtins are saved as their place in the table of builtins, so an image only works with the build of the
+ * interpreter which saved it.
+ */
+
+/* Save the state of the interpreter to an image file, returning 0 if it can't */
+int SaveImage(char*);
+
+/* Initialize the interpreter from an image file (instead of with InitEvaluator()), returning 0 if it can't */
+int LoadImage(char*);
+
+#endif /* IMAGE_H */
@@ -0,0 +1,36 @@
+#ifndef INFIX_H
+#define INFIX_H
+
+#include "Vyion.h"
+
+/* An expression in {braces} is parsed into (infix (...)). The first time such a form is evaluated, it is
+ * rewritten into prefix form by precedence climbing ({a + b * c} becomes (+ a (* b c))), and the result is cached
+ * on the form, so that afterwards it costs the same as if it had been written in prefix form. Infix forms which
+ * are directly the operands of another one are rewritten along with it.
+ *
+ * The operators and their precedences are kept in a table which programs can add to with def-operator. Since
+ * forms are only rewritten once, operators should be defined before the code using them is first evaluated.
+ * Anything else in operator position is called, binding more loosely than every operator in the table, so
+ * {a eq b} is (eq a b). Infix forms inside quote and quote-substitutions forms are data, and are left alone.
+ */
+
+/* An infix operator: a higher precedence binds tighter */
+typedef struct {
+	char* name;
+	int precedence;
+	int rightAssociative;
+} InfixOperator;
+
+/* Set up the standard operators */
+void InitInfixOperators();
+
+/* Add an operator to the table, or change its precedence if it is already there */
+void DefineInfixOperator(char*, int, int);
+
+/* Get the operator table and the number of operators in it */
+InfixOperator* GetInfixOperators(int*);
+
+/* Find the prefix form an infix form is rewritten to (or NULL, storing an error message, if it is invalid) */
+VyParseTree* GetInfixRewrite(VyParseTree*, char**);
+
+#endif /* INFIX_H */
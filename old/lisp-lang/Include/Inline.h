@@ -0,0 +1,37 @@
+#ifndef INLINE_H
+#define INLINE_H
+
+#include "Vyion.h"
+
+/* A few small builtins (+ - < = head tail nth not) are called so often that Eval evaluates calls to them
+ * directly: the arguments are evaluated onto the C stack and the operation is done right there, without looking
+ * the function up, building an argument array or calling through the function object.
+ *
+ * This is only valid while the name still means the original builtin, so every binding of one of these names is
+ * watched: as soon as a variable with that name is bound to anything else, in any scope (or a function has a
+ * parameter or a local with that name), the builtin stops being inlined, and calls to it go the ordinary way.
+ */
+
+/* The number of inline builtins */
+#define NUM_INLINE_BUILTINS (FORM_LAST_INLINE - FORM_FIRST_INLINE + 1)
+
+/* Remember the original builtins (after they have been added to the global scope) */
+void InitInlineBuiltins();
+
+/* Get or restore the original builtins, and whether each has been rebound (arrays of NUM_INLINE_BUILTINS) */
+void GetInlineBuiltinState(VyObject*, int*);
+void SetInlineBuiltinState(VyObject*, int*);
+
+/* Find the inline form for a call to a name with the given number of arguments (or FORM_CALL) */
+int InlineBuiltinForm(char*, int);
+
+/* Whether an inline form can still be used */
+int InlineBuiltinIntact(int);
+
+/* Note that a variable is being bound to a value (< 0 for a slot which will be bound later) */
+void WatchBinding(char*, VyObject);
+
+/* Evaluate a call to an inline builtin */
+VyObject EvalInlineBuiltin(int, VyParseTree*);
+
+#endif /* INLINE_H */
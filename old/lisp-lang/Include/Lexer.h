@@ -13,7 +13,7 @@
 /***** Functions to access the current state of the lexer *****/
 
 /* Get the token list */
-VyToken** GetTokenList();
+VyToken* GetTokenList();
 
 /* Get the next token */
 VyToken* GetNextToken();
@@ -33,6 +33,11 @@ int GetNumTokens();
 /* Free the used memory and reset the lexer to its initial state */
 void CleanLexer();
 
+/* Get the text of a token: either a pointer into the source (which is not null terminated, and is only valid
+ * until the lexer is cleaned), or a newly allocated copy */
+char* TokenText(VyToken*);
+char* TokenToStr(VyToken*);
+
 /***** Functions for tokenizing data *****/
 
 /* Process a whole file */
@@ -41,6 +46,12 @@ void LexFile(char*);
 /* Process a string */
 void Lex(char*);
 
+/* Process a buffer of a given length (the buffer must outlive the tokens) */
+void LexBuffer(char*, int);
+
+/* Process a buffer which starts at a given position in its file */
+void LexBufferAt(char*, int, Position*);
+
 /***** Debugging functions *****/
 
 /* Print the token list (for debugging) */
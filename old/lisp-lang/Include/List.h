@@ -37,6 +37,10 @@ VyObject ListGet(VyList**, int);
 /* Append an element to a list */
 VyList** ListAppend(VyList**, VyObject);
 
+/* Add an element after the last node of a list that is still being built, returning the new last node. Unlike
+ * ListAppend(), this modifies the list, so it may only be used on fresh lists that nothing else refers to. */
+VyList** ListBuildAppend(VyList**, VyObject);
+
 /* Insert an element into a list at an index */
 VyList** ListInsert(VyList**, VyObject, int);
 
@@ -0,0 +1,33 @@
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "Vyion.h"
+
+/* The looping forms are built into the evaluator, rather than being macros over tagbody:
+ *     (while condition body...)             Run the body as long as the condition is true.
+ *     (loop body...)                        Run the body until it breaks.
+ *     (for-range var start end body...)     Run the body with var bound to each integer from start up to (but not including) end.
+ *     (for-each var list body...)           Run the body with var bound to each element of the list.
+ *
+ * (break) or (break value) leaves the innermost loop, which returns the value (or false!). Otherwise, a loop
+ * returns the value of the last expression in its body the last time it ran (or false! if it never ran).
+ * Errors, and go's out of a loop in a tagbody, stop the loop and are returned.
+ */
+
+/* Set up the loops */
+void InitLoops();
+
+/* Get or restore the object loops break with */
+VyObject GetBreakSignal();
+void SetBreakSignal(VyObject);
+
+/* Evaluate the looping forms */
+VyObject EvalWhile(VyParseTree*);
+VyObject EvalLoop(VyParseTree*);
+VyObject EvalForRange(VyParseTree*);
+VyObject EvalForEach(VyParseTree*);
+
+/* Evaluate a break form */
+VyObject EvalBreak(VyParseTree*);
+
+#endif /* LOOP_H */
@@ -59,11 +59,24 @@ struct VyMemHeap {
 	void* heapBase;
 	void* freeMem;
 
+	/* Whether the heap memory belongs to a loaded image, rather than being malloc'd (so it isn't freed) */
+	int mapped;
+
+	/* What has been allocated, and how many collections there have been, since the start (see Timing.h) */
+	long objectsAllocated;
+	long bytesAllocated;
+	long collections;
+
 };
 
 /* Initialize the memory manager */
 void InitMem();
 
+/* Initialize the memory manager with a heap which already holds objects (from an image, see Image.h): given
+ * their types, the objects must be laid out one after another in order of ID, each after its ID. Returns 0 if
+ * they aren't. */
+int InitMemFrom(void*, int, char*, int, int);
+
 /* Allocate a number of bytes on the heap and return a pointer to it */
 void* VyMallocate(int, VyMemHeap*);
 
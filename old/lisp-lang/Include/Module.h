@@ -0,0 +1,58 @@
+#ifndef MODULE_H
+#define MODULE_H
+
+#include "Vyion.h"
+
+/* Every file the interpreter processes is a module, registered under its canonical path (so the same file reached
+ * through different relative paths or links is one module). A module is loaded once: including it again does
+ * nothing, and so does including a module which is still being loaded (a cycle). (reload 'file) loads it again.
+ *
+ * Each included module gets a scope of its own, its namespace: the variables set at the top level of the module
+ * (even ones with the same name as a global, or as a variable of another module), the variables of loops at its
+ * top level, and new globals created while it is loaded go there instead of into the global scope. Code read from
+ * a module looks in the module's own namespace before the global scope; other module scopes are searched after
+ * the global scope, in the order the modules were loaded, so the names a module defines are still visible
+ * everywhere without qualification. The files given on the command line are the program itself, so their
+ * namespace is the global scope.
+ */
+
+/* A loaded (or loading) module, with the name it is shown by (its path relative to the working directory, if it
+ * is under it) */
+typedef struct {
+	char* path;
+	char* name;
+	Scope* scope;
+	int loading;
+} Module;
+
+/* Process a file given on the command line */
+void RunFile(char*);
+
+/* The include and reload builtins */
+VyObject IncludeFile(VyFunction**, VyObject*, int);
+VyObject ReloadFile(VyFunction**, VyObject*, int);
+
+/* Get the scope which top-level variables are set in (the namespace of the module being loaded) */
+Scope* GetModuleScope();
+
+/* Get the scope which variables set (or looped over) by the code being evaluated are bound in: the local scope,
+ * or at the top level, the module scope */
+Scope* GetBindingScope();
+
+/* Find the module scope a variable is bound in (or NULL) */
+Scope* FindModuleScope(char*);
+
+/* Get the modules, or register one which was already loaded (for heap images, with its scope) */
+Module* GetModules(int*);
+void AddLoadedModule(char*, Scope*);
+
+/* Get the place in the registry of the module being loaded (or -1 if none is) */
+int GetLoadingModule();
+
+/* Get the name of the module a parse tree was read from (or NULL if it wasn't read from one) */
+char* TreeModuleName(VyParseTree*);
+
+/* Get the namespace of the module a parse tree was read from (or NULL if it wasn't read from an included one) */
+Scope* TreeModuleScope(VyParseTree*);
+
+#endif /* MODULE_H */
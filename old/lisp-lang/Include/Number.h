@@ -22,23 +22,32 @@ typedef struct {
 } ComplexNum;
 
 typedef struct {
-	int numerator;
-	int denominator;
+	VyNumber** numerator;
+	VyNumber** denominator;
 } RatioNum;
 
+typedef struct {
+	int sign;
+	int size;
+	unsigned int* limbs;
+} BigIntNum;
+
 
-/* Numeric types: integers, floats, complex numbers, and ratios */
+/* Numeric types: integers (fixnums and bignums), floats, complex numbers, and ratios */
 struct VyNumber {
 	int type;
 	void* data;
 };
 
-/* Parse a number from a string */
-VyNumber** ParseNumber(char*);
+/* Parse a number from a string of a given length */
+VyNumber** ParseNumber(char*, int);
 
 /* Get any parsing errors; NULL if none */
 char* GetLastNumberParsingError();
 
+/* The size of the data of a number type */
+int NumberSize(int);
+
 /* Create a number */
 VyNumber** CreateNumber(int);
 
@@ -51,20 +60,57 @@ void DeleteNumber(VyNumber**);
 /* Print the number to stdout */
 void PrintNumber(VyNumber**);
 
+/* Format a double as the shortest string which reads back as the same value */
+void FormatReal(double, char*);
+
 /* Create specific types of number */
 VyNumber** CreateInt(int);
 VyNumber** CreateReal(double);
 VyNumber** CreateImaginary(VyNumber**);
 VyNumber** CreateComplex(VyNumber**, VyNumber**);
-VyNumber** CreateRatio(int,int);
+VyNumber** CreateRatio(VyNumber**, VyNumber**);
+VyNumber** CreateRatioFromLongs(long long, long long);
+
+/* Create an integer, which is a fixnum if it fits and a bignum otherwise */
+VyNumber** CreateInteger(long long);
+VyNumber** CreateIntegerFromBig(BigIntNum*);
 
 /* Retrieve data from numbers */
 int GetInt(VyNumber**);
 double GetDouble(VyNumber**);
-int GetNumerator(VyNumber**);
-int GetDenominator(VyNumber**);
+VyNumber** GetNumerator(VyNumber**);
+VyNumber** GetDenominator(VyNumber**);
 VyNumber** GetReal(VyNumber**);
 VyNumber** GetImaginary(VyNumber**);
+BigIntNum* GetBigInt(VyNumber**);
+
+/* Whether a number is an integer (either a fixnum or a bignum) */
+int IsInteger(VyNumber**);
+
+/* Convert any non-complex number to the closest double */
+double NumberToDouble(VyNumber**);
+
+/* Compare two non-complex numbers, returning -1, 0, or 1 */
+int CompareNumbers(VyNumber**, VyNumber**);
+
+/* Exact integer arithmetic, on fixnums and bignums */
+int IntegerSign(VyNumber**);
+int IntegerCompare(VyNumber**, VyNumber**);
+VyNumber** IntegerAdd(VyNumber**, VyNumber**);
+VyNumber** IntegerSubtract(VyNumber**, VyNumber**);
+VyNumber** IntegerMultiply(VyNumber**, VyNumber**);
+VyNumber** IntegerQuotient(VyNumber**, VyNumber**);
+VyNumber** IntegerNegate(VyNumber**);
+VyNumber** IntegerGcd(VyNumber**, VyNumber**);
+
+/* Copy a number */
+VyNumber** CloneNumber(VyNumber**);
+
+/* Convert a number to its simplest type (such as a complex number with no imaginary part to a real) */
+void ReduceNumber(VyNumber**);
+
+/* Check whether a number equals zero */
+int EqualsZero(VyNumber**);
 
 /* Negate a number */
 VyNumber** NegateNumber(VyNumber**);
@@ -6,5 +6,6 @@
 #define INT 1
 #define COMPLEX 2
 #define RATIO   3
+#define BIGINT  4
 
 #endif /* NUMBER_TYPE_H */
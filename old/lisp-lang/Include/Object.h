@@ -18,6 +18,9 @@ int DataSize(int);
 /* Print a value to standard output */
 void PrintObj(VyObject);
 
+/* Create an object of a type, returning its ID */
+VyObject CreateObj(int);
+
 /* Create objects from values */
 VyNumber** CreateNumObj();
 VyFunction** CreateFuncObj();
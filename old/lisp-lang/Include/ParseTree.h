@@ -3,106 +3,155 @@
 
 #include "Vyion.h"
 
-/* Nodes of a parse tree */
-struct VyParseTree;
-
-typedef struct {
-	struct VyParseTree** list;
-	int length;
-} list_node;
-
-typedef struct {
-	char* str;
-} ident_node;
-
-typedef struct {
-	VyNumber** num;
-} num_node;
-
-typedef struct {
-	struct VyParseTree* data;
-} quote_node;
-
-typedef struct {
-	struct VyParseTree* data;
-	int splice;
-} subst_node;
-
-typedef struct {
-	struct VyParseTree* obj;
-	struct VyParseTree* ref;
-} ref_node;
-
-typedef struct {
-	char* str;
-} string_node;
-
-typedef struct {
-	char* message;
-} error_node;
-
-/* The data of a parse tree node */
-typedef union {
-	list_node list;
-	ident_node ident;
-	num_node num;
-	string_node str;
-	quote_node quote;
-	subst_node subst;
-	ref_node ref;
-	error_node error;
-} tree_node_data;
+/* A parse tree is stored flat: all of the nodes of a tree live in one contiguous block of memory, along with
+ * the text of its identifiers and strings. The children of a list are stored next to each other, and a node
+ * refers to its children and its text by 32-bit offsets relative to itself, so walking a tree is just index
+ * arithmetic and the whole tree is freed at once.
+ *
+ * Since the children of a list must be contiguous, trees are built bottom up with a TreeBuilder. Finished
+ * nodes wait on the builder's pending stack until the list containing them is closed, at which point they are
+ * moved together into the tree. Finishing the builder packs everything into a single block.
+ */
 
 /* A parse tree node */
 struct VyParseTree {
-	int type;
-	Position* pos;
-	tree_node_data* data;
+	unsigned char type;
+
+	/* For lists, what kind of form the evaluator found the list to be (see FormType.h), so that keywords and
+	 * inline builtins are only recognized once */
+	unsigned char form;
+
+	/* The module the node was read from: one more than its place in the registry (see Module.h), or 0 if it
+	 * wasn't read from a file (like code typed into the REPL, or made by a macro) */
+	unsigned short module;
+
+	/* The position in the original text, packed into one int */
+	unsigned int pos;
+
+	/* The data of a node depends on its type */
+	union {
+		/* Lists and references: the children are at (this + first)[0 .. length - 1] */
+		struct {
+			int first;
+			int length;
+		} list;
+
+		/* Identifiers and strings: the null terminated text is at ((char*) this + offset) */
+		struct {
+			int offset;
+			int length;
+		} str;
+
+		VyNumber** num;
+		char* message;
+	} data;
+
+	/* Data which the evaluator computes once for this node and reuses (such as a call's binding plan), or NULL.
+	 * It must be a single malloc'd block, since it is freed along with the tree (except for infix forms, whose
+	 * cache is the tree they were rewritten to, which is deleted instead). */
+	void* cache;
 };
 
-/* Create empty parse trees of a certain type  */
-VyParseTree* MakeListTree();
-VyParseTree* MakeNum();
-VyParseTree* MakeIdent();
-VyParseTree* MakeString();
-
-/* Quote an expression or get the expression in a quote */
-VyParseTree* Quote(VyParseTree*);
+/* A builder for parse trees */
+typedef struct {
+	/* The nodes which are already in their final place (but with indices which are not yet relative) */
+	VyParseTree* nodes;
+	int numNodes;
+	int nodeCapacity;
+
+	/* The nodes which are waiting for their list to be closed */
+	VyParseTree* pending;
+	int numPending;
+	int pendingCapacity;
+
+	/* The text of identifiers and strings */
+	char* pool;
+	int poolSize;
+	int poolCapacity;
+} TreeBuilder;
+
+/* Create or delete a tree builder */
+TreeBuilder* CreateTreeBuilder();
+void DeleteTreeBuilder(TreeBuilder*);
+
+/* Add a leaf node to the tree being built */
+void PushIdent(TreeBuilder*, char*, int);
+void PushString(TreeBuilder*, char*, int);
+void PushNumber(TreeBuilder*, VyNumber**);
+void PushError(TreeBuilder*, char*);
+
+/* Start a list, and after pushing its elements, close it with the value returned */
+int BeginList(TreeBuilder*);
+void EndList(TreeBuilder*, int);
+
+/* Start a reference to the last node pushed, and after pushing the ref part, close it */
+int BeginReference(TreeBuilder*);
+void EndReference(TreeBuilder*, int);
+
+/* Set the position of the last node pushed, unless it already has one */
+void SetPendingPosition(TreeBuilder*, Position*);
+
+/* Pack the single node left on the builder (with all its children) into a tree, and reset the builder */
+VyParseTree* FinishTree(TreeBuilder*);
+
+/* Find out if a list is a quote or substitution */
 int IsQuote(VyParseTree*);
-
-/* Put something in/out of a substitution */
-VyParseTree* Substitution(VyParseTree*, int);
 int IsSubstitution(VyParseTree*);
 int IsSplicingSubstitution(VyParseTree*);
 
-/* Create an object reference */
-VyParseTree* Reference(VyParseTree*, VyParseTree*);
-
 /* Retrieve either the obj or ref part of the reference */
 VyParseTree* GetObj(VyParseTree*);
 VyParseTree* GetRef(VyParseTree*);
 
-/* Make an error node */
-VyParseTree* ParseError(char*);
+/* Get the message of an error node */
+char* GetErrorMessage(VyParseTree*);
 
-/* List operations (adding, retrieving, and finding list size) */
-int AddToList(VyParseTree*,VyParseTree*);
+/* List operations (retrieving elements and finding list size) */
 VyParseTree* GetListData(VyParseTree*,int);
-inline int ListTreeSize(VyParseTree*);
+int ListTreeSize(VyParseTree*);
 VyParseTree* ListTreeHead(VyParseTree*);
 
-/* Get and set the associated string data for this node */
-int SetStrData(VyParseTree*, char*);
+/* Get the associated string data for this node */
 char* GetStrData(VyParseTree*);
 
-/* Get/Set Number Data */
-void SetNumberData(VyParseTree*, VyNumber**);
+/* Get Number Data */
 VyNumber** GetNumberData(VyParseTree*);
 
-/* Set the position in the original text of this node */
-void SetPosition(VyParseTree*, Position*);
+/* Get or replace the cached evaluation data of a node (the old data is freed) */
+void* GetTreeCache(VyParseTree*);
+void SetTreeCache(VyParseTree*, void*);
+
+/* Get or set the form of a list (FORM_UNKNOWN until the evaluator first sees it) */
+int GetTreeForm(VyParseTree*);
+void SetTreeForm(VyParseTree*, int);
+
+/* Get the position in the original text of this node, returning 0 if it isn't known */
+int GetTreePosition(VyParseTree*, Position*);
+
+/* Get the module a node was read from (as kept in the node), or set it for all the nodes of a whole tree */
+int GetTreeModule(VyParseTree*);
+void SetTreeModule(VyParseTree*, int);
+
+/* Make a whole tree (such as a macro expansion) come from where a node did: its module, and its position for the
+ * nodes which have none */
+void SetTreeOrigin(VyParseTree*, VyParseTree*);
+
+/* Top-level trees are deleted after they are evaluated, unless something created during the evaluation refers
+ * to them (a function or macro's code, a symbol's name, or an error's location). Whatever creates such a
+ * reference calls RetainParseTree() so that the tree is kept. */
+void RetainParseTree();
+int ParseTreeRetained();
+void SetParseTreeRetained(int);
+
+/* Copy a tree (or a part of one) into a new tree, leaving out the cached data */
+VyParseTree* CopyParseTree(VyParseTree*);
+
+/* A whole tree is a single self-relative block of memory, which can be copied as it is (for heap images, see
+ * Image.h): find the block of a tree and its size, or the tree in a block and its number of nodes */
+void* GetTreeBlock(VyParseTree*, int*);
+VyParseTree* TreeInBlock(void*, int*);
 
-/* Delete a parse tree and the used memory */
+/* Delete a whole parse tree (only the root of a tree may be deleted) */
 void DeleteParseTree(VyParseTree*);
 
 #endif /* PARSE_TREE_H */
@@ -0,0 +1,37 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "Vyion.h"
+
+/* The sampling profiler finds out which Vyion functions the time goes to:
+ *     vyion --profile out.folded program.v
+ *
+ * While it is on, every function call pushes a frame onto a shadow stack, which identifies the function by its
+ * code (or, for builtins, by the C function implementing it). A SIGPROF timer interrupts the program every
+ * millisecond of CPU time, and each time, the handler copies the shadow stack into a sample buffer which was
+ * allocated beforehand (so that it doesn't need to allocate anything or take any locks).
+ *
+ * At exit, the frames are given names: a function is named after a variable it is bound to (by set, global, or
+ * as a builtin), or called lambda if it has none, and followed by the file (relative to the working directory)
+ * and line its code starts on. The samples are written to the file as folded stacks (one line per distinct stack,
+ * "toplevel;outer:main.v:3;inner:lib.v:10 count"), which flame graph tools read, and a table of the functions
+ * with the most samples is printed to stderr, with the samples spent in each function itself (self) and in it or
+ * anything it called (total).
+ */
+
+/* Start profiling, writing the folded stacks to the given file at exit */
+void StartProfiler(char*);
+
+/* Stop profiling, and write the report (this is done at exit, if it hasn't been done yet) */
+void StopProfiler();
+
+/* Find what identifies a function (its code, or the C function of a builtin), and name it from that (the name
+ * is found the first time it is asked for, since that searches the global and module scopes, and then kept) */
+void* FunctionKey(VyFunction**);
+char* NameFunction(void*);
+
+/* Push or pop the frame of a function call (these do nothing unless profiling) */
+void PushProfileFrame(VyFunction**);
+void PopProfileFrame();
+
+#endif /* PROFILE_H */
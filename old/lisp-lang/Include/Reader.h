@@ -0,0 +1,51 @@
+#ifndef READER_H
+#define READER_H
+
+#include "Vyion.h"
+
+/* The reader splits a source file into its top-level forms without lexing or parsing it. It reads the
+ * file in blocks into a buffer, and only looks at enough of the syntax (lists, strings, comments, quotes,
+ * and references) to find where each form ends. A form is then just a slice of the buffer, so a file can be
+ * lexed, parsed, and evaluated one form at a time, and only one form's text, tokens, and parse tree need to
+ * be in memory at once. The buffer only grows if a single form is larger than it.
+ */
+
+struct VyReader {
+	FILE* file;
+	int eof;
+
+	/* The buffered text: the current form starts at start, the next unread character is at pos,
+	 * and the valid data ends at end */
+	char* buffer;
+	int capacity;
+	int start;
+	int pos;
+	int end;
+
+	/* The position in the file of the character at counted (everything before it has been counted) */
+	int counted;
+	int line;
+	int character;
+	int indent;
+
+	/* The position where the last form started */
+	Position formPosition;
+};
+
+/* Open a file for reading forms, or return NULL if the file can't be opened */
+VyReader* OpenReader(char*);
+
+/* Read the next top-level form, returning 0 once the end of the file is reached */
+int ReadForm(VyReader*);
+
+/* The text and length of the last form read (the text is not null terminated) */
+char* FormText(VyReader*);
+int FormLength(VyReader*);
+
+/* The position of the start of the last form read */
+Position* FormPosition(VyReader*);
+
+/* Close the file and free the reader */
+void CloseReader(VyReader*);
+
+#endif /* READER_H */
@@ -0,0 +1,77 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include "Vyion.h"
+
+/* Regions (also called arenas) hold short-lived data which would otherwise be malloc'd and freed over and over.
+ * Allocating from a region just bumps a pointer, and everything in it is freed at once by resetting it. The memory
+ * of a region is a list of chunks, and chunks freed by a reset are kept for reuse, so once a program warms up,
+ * regions don't call malloc at all.
+ *
+ * The interpreter has two regions:
+ *     - The scratch region is for data which lives only during a function call, such as argument arrays. It is used
+ *       like a stack: a call marks the region before allocating and releases it back to the mark when it returns.
+ *     - The form region is for data which lives during the evaluation of one top-level form (or REPL line), such as
+ *       the input text. It is reset after each form, unless the form was retained (see RetainParseTree() in
+ *       ParseTree.h), in which case its memory is left to whatever refers to it. (Error messages aren't put there,
+ *       since an error can be kept in a variable after its form is done.)
+ */
+
+/* A chunk of region memory */
+typedef struct RegionChunk {
+	/* The chunk allocated before this one */
+	struct RegionChunk* next;
+
+	/* The end of the chunk's memory */
+	char* limit;
+
+	char data[];
+} RegionChunk;
+
+/* A region */
+struct VyRegion {
+	/* The current chunk, and the start of its free memory */
+	RegionChunk* chunk;
+	char* top;
+
+	/* Chunks which were released and can be reused */
+	RegionChunk* spare;
+};
+
+/* A saved position in a region, which it can later be released back to */
+typedef struct {
+	RegionChunk* chunk;
+	char* top;
+} RegionMark;
+
+/* Create or delete a region */
+VyRegion* CreateRegion();
+void DeleteRegion(VyRegion*);
+
+/* Allocate memory in a region */
+void* RegionAlloc(VyRegion*, int);
+
+/* Copy a string into a region */
+char* RegionStrndup(VyRegion*, char*, int);
+
+/* Format a string into a region (like sprintf) */
+char* RegionPrintf(VyRegion*, char*, ...);
+
+/* Mark a region, and later free everything allocated after the mark */
+RegionMark MarkRegion(VyRegion*);
+void ReleaseRegion(VyRegion*, RegionMark);
+
+/* Free everything in a region */
+void ResetRegion(VyRegion*);
+
+/* Leave everything allocated so far to whatever refers to it, and start the region over with new memory */
+void AbandonRegion(VyRegion*);
+
+/* Create the interpreter's regions */
+void InitRegions();
+
+/* The interpreter's regions */
+VyRegion* GetScratchRegion();
+VyRegion* GetFormRegion();
+
+#endif /* REGION_H */
@@ -3,58 +3,119 @@
 
 #include "Vyion.h"
 
+/* A scope holds variables as two parallel arrays of names and values. A value < 0 means that the variable
+ * isn't bound (yet), so lookups skip it.
+ *
+ * There are two kinds of scopes. Ordinary scopes (the global scope, for instance) are growable arrays on the heap
+ * which own copies of their names. Function frames instead have a fixed set of slots, one for each parameter and
+ * each variable the function sets, which is known when the function is created (see FrameLayout). The names of
+ * a frame belong to its layout, and the values are carved out of the interpreter's frame stack when the function
+ * is called, so a call doesn't need to allocate anything. A variable which isn't in the layout (one set by code
+ * produced by a macro, for instance) goes into the frame's overflow scope, which is an ordinary scope.
+ *
+ * A closure is flat: when a function is created, it captures only the variables which its body refers to (its
+ * free names, also found in the layout) from the frame it is created in and the closure of that frame's function,
+ * into a record of its own. To let the frame and its closures (and the closures of nested functions) keep sharing
+ * a variable after the frame is popped, a captured slot is boxed: the variable moves into a cell, and the slot
+ * holds the cell's index instead (encoded below -1). So variables are looked up in the local frame, then in the
+ * closure of its function, and finally in the global scope.
+ */
+
+/* The kinds of scopes */
+#define SCOPE_ORDINARY 0
+#define SCOPE_FRAME 1
+#define SCOPE_CLOSURE 2
+
+/* The slots of a function's frame: its parameters, followed by the variables it sets; then the names which may
+ * come from outside the function (everything in its body except the parameters) */
+typedef struct {
+	int numSlots;
+	int numFree;
+	char* names[];
+} FrameLayout;
+
 /* A variable scope */
 struct Scope {
-	VarBinding** vars;
+	/* The variables */
+	char** names;
+	VyObject* values;
 	int size;
+	int capacity;
+
+	/* What kind of scope this is */
+	int kind;
+
+	/* For frames, the scope for variables which aren't in the layout (or NULL) */
+	Scope* overflow;
+
+	/* For frames, the closure of the function (NULL if it has none) */
+	Scope* parent;
 };
 
 /***** Functions to deal with scope data structures *****/
 
-/* Create a scope */
+/* Create an ordinary scope */
 Scope* CreateScope();
 
-/* Find a variable in a scope; if it doesn't exist, return NULL; if it doesn, return it's value. */
+/* Find a variable in a scope; if it isn't bound, return a value < 0 */
 VyObject FindValue(Scope*, char*);
 
 /* Set a variable (may need to add it first) */
 void SetVariable(Scope*, char*, VyObject);
 
-/* Add a variable to a scope */
-void AddVariable(Scope*, VarBinding*);
+/* Add a new variable to an ordinary scope (without checking whether it is already there) */
+void AddVariable(Scope*, char*, VyObject);
 
 /* Print the concents of a scope */
 void PrintScopeContents(Scope*);
 
-/* Merge two scopes into one */
-Scope* MergeScopes(Scope*, Scope*);
-
-/* Destroy a scope */
+/* Destroy an ordinary scope */
 void DeleteScope(Scope*);
 
+/***** Function frames *****/
+
+/* Find the frame layout of a function from its code (a lambda or mambda form) and arguments */
+FrameLayout* GetFrameLayout(VyParseTree*, Argument**, int);
+
+/* Carve a frame for a function call out of the frame stack, returning 0 if the stack is full */
+int PushFrame(Scope*, FrameLayout*, Scope*);
+
+/* Pop the frame of the function call which is returning */
+void PopFrame(Scope*);
+
+/* Get a copy of the values in the frames of the calls in progress (for heap dumps; the caller frees it) */
+VyObject* GetFrameValues(int*);
+
+/* Read the value in a slot of a scope, going through its cell if the slot is boxed */
+VyObject SlotValue(Scope*, int);
+
 /***** Functions to deal with the program's scope *****/
 
 /* Get the global scope */
 Scope* GetGlobalScope();
 
-/* Add or remove scopes to the function scope stack */
-void PushScope(Scope*);
-Scope* PopScope();
-
 /* Get the local scope */
 Scope* GetLocalScope();
 
-/* Get the current function scope */
-Scope* GetCurrentFunctionScope();
-
-/* Set the current function scope */
-void SetCurrentFunctionScope(Scope*);
-
 /* Set the local scope */
 void SetLocalScope(Scope*);
 
-/* Find a value in all currently accesible scopes */
-VyObject FindObjAllScopes(char*);
+/* Create the closure of a function with the given layout created now (NULL if it needs none) */
+Scope* CaptureClosure(FrameLayout*);
+
+/* Find the global scope or module scope (see Module.h) which a variable is bound in (or NULL) */
+Scope* FindGlobalScope(char*);
+
+/* Find the scope which a variable is bound in, out of the currently accessible scopes (or NULL), given the
+ * namespace of the module the code using it is from (or NULL) */
+Scope* FindVariableScope(char*, Scope*);
+
+/* Find a value in all currently accesible scopes, given the namespace of the module the code is from (or NULL) */
+VyObject FindObjAllScopes(char*, Scope*);
+
+/* Get the cells of boxed variables, or replace them (for heap images) */
+VyObject* GetCells(int*);
+void SetCells(VyObject*, int);
 
 /* Initialize scopes */
 void InitScopes();
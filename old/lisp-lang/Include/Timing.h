@@ -0,0 +1,27 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "Vyion.h"
+
+/* Two forms measure how long code takes, and what it allocates:
+ *     (time expr)       Evaluate expr once, report what it took, and return its value.
+ *     (bench expr n)    Evaluate expr a tenth of n times (at least once) to warm up, then n times measuring each,
+ *                       report per evaluation, and return the mean time in nanoseconds.
+ *
+ * The time is wall time from the monotonic clock, in nanoseconds. The allocations are the objects created and
+ * the bytes of heap they took, and the collections are those the allocations caused (see the counters in Mem.h).
+ * (time) reports the totals; (bench) reports the mean, median, and 99th percentile of the time, and the mean
+ * allocations and collections. Reports go to stderr, so that they don't mix with what the program prints.
+ */
+
+/* Get the time from the monotonic clock, in nanoseconds */
+long MonotonicNanoseconds();
+
+/* Write the allocation counters, as a JSON object, to a file (for the benchmark runner), returning 0 if it can't */
+int WriteMemoryStats(char*);
+
+/* Evaluate the time and bench forms */
+VyObject EvalTime(VyParseTree*);
+VyObject EvalBench(VyParseTree*);
+
+#endif /* TIMING_H */
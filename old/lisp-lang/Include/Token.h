@@ -8,22 +8,15 @@ struct Position {
 	int character;
 };
 
-/* A lexer token */
+/* A lexer token. Tokens don't own their text; they are (offset, length) slices of the source
+ * buffer held by the lexer, and the text can be retrieved with TokenText() or TokenToStr(). */
 struct VyToken {
 	int type;
-	char* data;
-	Position* pos;
+	int offset;
+	int length;
+	Position pos;
 };
 
-/* Create a token with no associated data of given type */
-VyToken* EmptyToken(int);
-
-/* Create a token of a given type with associated string data */
-VyToken* DataToken(int,char*);
-
-/* Set the position of a token */
-void SetTokenPosition(VyToken*, int, int, int);
-
 /* Print a position (line and character) */
 void PrintPosition(Position*);
 
@@ -32,13 +25,7 @@ int GetLine(VyToken*);
 int GetCharacter(VyToken*);
 int GetIndent(VyToken*);
 
-/* Whether the token  has a known position */
-int HasKnownPosition(VyToken*);
-
 /* Whether the token is an empty token (i.e., no associated string data) */
 int IsEmptyToken(VyToken*);
 
-/* Delete the token data and free used memory */
-void DeleteToken(VyToken*);
-
 #endif /* TOKEN_H */
@@ -14,6 +14,6 @@
 #define STRING 	 9
 #define DOLLARAT 10
 #define OCURLY 	 11
-#define CCURLY	 11
+#define CCURLY	 12
 
 #endif /* TOKEN_TYPE_H */
@@ -0,0 +1,42 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Vyion.h"
+
+/* The tracer records exactly what the interpreter spends its time on, for viewing on a timeline:
+ *     vyion --trace out.json program.v
+ *
+ * While it is on, every function call, macro expansion, garbage collection, top-level form, and processed file is
+ * recorded as an event with its start time and duration (from the monotonic clock). A span is recorded once it
+ * ends, so each event is complete, and spans inside it end (and are recorded) first. Each thread records into a
+ * ring buffer of its own, without locks; when the buffer is full, the oldest events are overwritten.
+ *
+ * At exit, the events are written in the Chrome trace_event format (JSON), which chrome://tracing and Perfetto
+ * show as a timeline: the category of an event says what it is (call, macro, gc, form, or file), and its name
+ * which function, macro, or file it was (functions are named as described in Profile.h).
+ */
+
+/* The kinds of events */
+#define TRACE_CALL 0
+#define TRACE_MACRO 1
+#define TRACE_GC 2
+#define TRACE_FORM 3
+#define TRACE_FILE 4
+
+/* Start tracing, writing the events to the given file at exit */
+void StartTracer(char*);
+
+/* Stop tracing, and write the events (this is done at exit, if it hasn't been done yet) */
+void StopTracer();
+
+/* Get the start time of a span (0 unless tracing), and record the span once it ends. What an event is about is
+ * given by a pointer: the key of a function (see FunctionKey() in Profile.h) for calls and macro expansions, the
+ * name of a file for files (which must last until the trace is written, like the names of modules), and NULL
+ * otherwise. The number is the line of a form, or the size of the heap after a garbage collection. */
+long TraceStart();
+void TraceEnd(int, void*, long, long);
+
+/* Write a string to a file as a JSON string */
+void WriteJSONString(FILE*, char*);
+
+#endif /* TRACE_H */
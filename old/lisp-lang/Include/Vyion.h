@@ -8,7 +8,19 @@
 #include <malloc.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <stdarg.h>
 #include <math.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <pthread.h>
 
 /* Check that NULL is defined */
 #ifndef NULL
@@ -23,12 +35,14 @@
  *     Tokenizing the input is the process of reading the input and splitting it up into
  *     pieces that will be easier for subsequent parsing. The token data structure is described in Token.h, 
  *     the different token types are described in TokenType.h, and the main lexing routines are described in Lexer.h. 
+ *     Files are split into top-level forms by the reader in Reader.h, so that they can be lexed and parsed one form at a time.
  */
 
 #include "StringUtil.h"
 #include "CharList.h"
 #include "Token.h"
 #include "Lexer.h"
+#include "Reader.h"
 
 
 /* Parser:
@@ -39,34 +53,52 @@
  *     have an enumeration in TreeType.h.
  *     
  *     Note: For convenience, Parser.h also includes a routine to parse the contents of a file. This routine simply calls the lexing routine, and
- *     only then actually does the parsing.
+ *     only then actually does the parsing. The parse trees of included files are saved and reused as described in Compiled.h.
  */
 
 #include "Parser.h"
 #include "ParseTree.h"
+#include "Compiled.h"
 
 /* Evaluation of expressions:
  *     The function which evaluates a parse tree is the eval function, which is in Eval.h. The eval function
  *     takes a parse tree structure and then evaluates it (recursively, if needed). Functions are described in Function.h, which presents 
  *     a function data type that unifies built-in C functions and functions actually written in Vambre through the use of function pointers. 
- *     Vambre is lexically scoped, and the scope data structure in described in Scope.h, while the call stack is in ScopeStack.h. 
+ *     Vambre is lexically scoped, and the scope data structure in described in Scope.h, along with the frame stack that function calls use. 
  *     The different types of objects and values are unified into one type in Value.h, with the value type enumeration in ValueType.h. 
- *     Variables, that is, bindings to values, are described in Value.h.
+ *     Variables, that is, bindings to values, are kept in scopes. Calls to a few small builtins are evaluated inline, as described in Inline.h.
+ *     Infix expressions are rewritten into prefix form as described in Infix.h, and the looping forms are described in Loop.h.
+ *     Files are loaded as modules, each once, with namespaces of their own, as described in Module.h.
+ *     The sampling profiler, which shows which functions the time goes to, is described in Profile.h, and the tracer,
+ *     which records every call, macro expansion, and garbage collection on a timeline, in Trace.h. The allocation
+ *     profiler, which shows which parts of the program the heap goes to, is described in HeapProfile.h, and heap
+ *     dumps, which show what keeps the objects on the heap alive, in HeapDump.h.
+ *     The time and bench forms, which measure code from within a program, are described in Timing.h.
+ *     Each thread can have an interpreter of its own, so that several programs run at once, as described in Context.h.
  *
- *     Note: The main entry point to the program is in the Eval() function, in Eval.h.
+ *     Note: The main entry point to the program is the main() function, in Main.c, which evaluates files or runs the REPL.
  */
 
 #include "Eval.h"
 #include "Scope.h"
-#include "ScopeStack.h"
+#include "Inline.h"
+#include "Infix.h"
+#include "Loop.h"
+#include "Module.h"
+#include "Profile.h"
+#include "HeapProfile.h"
+#include "HeapDump.h"
+#include "Trace.h"
+#include "Timing.h"
+#include "Context.h"
 #include "Object.h"
-#include "Variable.h"
 
 /* Basic variable types:
  *    The different types of objects in Vambre are described in these files. Currently, Vambre has the following types:
  *        - Boolean: 	True or false values, used in boolean expressions.
  *        - List:	A list of objects, implemented as a linked list.
  *        - Number:	A number, which can be either real (i.e. double), integer, or complex. Arithmetic operations convert between those types.
+ *                      Integers which overflow a C int are promoted to bignums, described in Bignum.h.
  *        - Symbol:	The symbol is what you get as a result of quoting an identifier. It is (more-or-less) a string used as an identifier.
  *        - Function:	A function, which can be called with arguments to produce a result. Functions are created with lambda.
  *        - Macro: A macro, which evaluates to Vambre code, which can then be used for anything else. Created with mambda.
@@ -76,6 +108,7 @@
 #include "Boolean.h"
 #include "List.h"
 #include "Number.h"
+#include "Bignum.h"
 #include "Symbol.h"
 #include "Function.h"
 #include "Macro.h"
@@ -84,13 +117,17 @@
 
 /* Memory management:
  * These headers provide an interface to the Vambre memory functions, which allocate and free memory,
- * as well as the Vambre garbage collector.
+ * as well as the Vambre garbage collector. Short-lived data which isn't on the heap is allocated in the regions in Region.h.
+ * The whole state of the interpreter can be saved to an image file and loaded back, as described in Image.h.
  */
 #include "Mem.h"
+#include "Region.h"
+#include "Image.h"
 
 /* Various type enumerations */
 #include "TokenType.h"
 #include "TreeType.h"
+#include "FormType.h"
 #include "ObjType.h"
 #include "NumberType.h"
 
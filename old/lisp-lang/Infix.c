@@ -0,0 +1,256 @@
+#include "Vyion.h"
+
+/* The operator table */
+__thread InfixOperator* infixOperators = NULL;
+__thread int numInfixOperators = 0;
+__thread int infixOperatorCapacity = 0;
+
+/* Add or redefine an operator */
+void DefineInfixOperator(char* name, int precedence, int rightAssociative){
+	int i;
+	for(i = 0; i < numInfixOperators; i++){
+		if(strcmp(infixOperators[i].name, name) == 0){
+			break;
+		}
+	}
+
+	if(i == numInfixOperators){
+		if(numInfixOperators == infixOperatorCapacity){
+			infixOperatorCapacity = (infixOperatorCapacity == 0) ? 16 : infixOperatorCapacity * 2;
+			infixOperators = realloc(infixOperators, sizeof(InfixOperator) * infixOperatorCapacity);
+		}
+		infixOperators[i].name = strdup(name);
+		numInfixOperators++;
+	}
+
+	infixOperators[i].precedence = precedence;
+	infixOperators[i].rightAssociative = rightAssociative;
+}
+
+/* Get the operator table */
+InfixOperator* GetInfixOperators(int* num){
+	*num = numInfixOperators;
+	return infixOperators;
+}
+
+/* Set up the comparisons, then the additive, multiplicative and exponentiation operators, from loosest to tightest */
+void InitInfixOperators(){
+	char* comparisons[] = {"=", "!=", "<", ">", "<=", ">="};
+	int i;
+	for(i = 0; i < 6; i++){
+		DefineInfixOperator(comparisons[i], 10, 0);
+	}
+
+	DefineInfixOperator("+", 20, 0);
+	DefineInfixOperator("-", 20, 0);
+	DefineInfixOperator("*", 30, 0);
+	DefineInfixOperator("/", 30, 0);
+	DefineInfixOperator("**", 40, 1);
+}
+
+/* How anything in operator position which isn't in the table is treated: it is called, binding more loosely than
+ * any operator */
+InfixOperator calledOperator = {NULL, INT_MIN + 1, 0};
+
+/* Find the operator an element of an infix expression names */
+InfixOperator* FindInfixOperator(VyParseTree* element){
+	if(element->type != TREE_IDENT){
+		return &calledOperator;
+	}
+
+	int i;
+	for(i = 0; i < numInfixOperators; i++){
+		if(strcmp(infixOperators[i].name, GetStrData(element)) == 0){
+			return &infixOperators[i];
+		}
+	}
+	return &calledOperator;
+}
+
+/* The builder for rewritten forms */
+__thread TreeBuilder* infixBuilder = NULL;
+
+/* The expression being rewritten, and the tree of operations found in it: a node is an operand (with no children)
+ * or an operator applied to two nodes, and refers to its element of the expression by index */
+typedef struct {
+	VyParseTree* elements;
+	int numElements;
+	int next;
+
+	int* element;
+	int* left;
+	int* right;
+	int numNodes;
+} InfixParse;
+
+/* Check that an expression alternates between operands and operators, and return an error message if not */
+char* ValidateInfix(VyParseTree* elements){
+	if(ListTreeSize(elements) % 2 == 0){
+		return "An infix expression must alternate between operands and operators.";
+	}
+	return NULL;
+}
+
+/* Add a node for an element of the expression */
+int AddInfixNode(InfixParse* parse, int element, int left, int right){
+	parse->element[parse->numNodes] = element;
+	parse->left[parse->numNodes] = left;
+	parse->right[parse->numNodes] = right;
+	return parse->numNodes++;
+}
+
+/* Parse operations by precedence climbing, taking only operators which bind at least as tightly as given */
+int ParseInfixOperations(InfixParse* parse, int minPrecedence){
+	int lhs = AddInfixNode(parse, parse->next++, -1, -1);
+
+	while(parse->next < parse->numElements){
+		int opIndex = parse->next;
+		InfixOperator* op = FindInfixOperator(GetListData(parse->elements, opIndex));
+		if(op->precedence < minPrecedence){
+			break;
+		}
+
+		/* A left associative operator takes only tighter operators into its right operand */
+		parse->next++;
+		int rhs = ParseInfixOperations(parse, op->rightAssociative ? op->precedence : op->precedence + 1);
+		lhs = AddInfixNode(parse, opIndex, lhs, rhs);
+	}
+
+	return lhs;
+}
+
+/* Whether a tree is an infix form */
+int IsInfixForm(VyParseTree* tree){
+	VyParseTree* head = ListTreeHead(tree);
+	return head != NULL && head->type == TREE_IDENT && StrEquals(GetStrData(head), "infix")
+		&& ListTreeSize(tree) == 2 && GetListData(tree, 1)->type == TREE_LIST && ListTreeSize(GetListData(tree, 1)) > 0;
+}
+
+/* Push the prefix form of a valid infix expression (defined below, since operands may be infix forms too) */
+void PushInfixExpression(VyParseTree*, Position*);
+
+/* Whether a tree is a quote or quote-substitutions form, whose contents are data (so infix forms in them are left
+ * alone; those in substitutions are still rewritten if they are evaluated) */
+int IsQuotedForm(VyParseTree* tree){
+	VyParseTree* head = ListTreeHead(tree);
+	return head != NULL && head->type == TREE_IDENT
+		&& (StrEquals(GetStrData(head), "quote") || StrEquals(GetStrData(head), "quote-substitutions"));
+}
+
+/* Push a copy of a tree onto the builder (rewriting it if it is an infix form which is valid, unless it is quoted) */
+void PushTreeCopy(VyParseTree* tree, int quoted){
+	Position pos;
+	int hasPosition = GetTreePosition(tree, &pos);
+
+	if(!quoted && IsInfixForm(tree) && ValidateInfix(GetListData(tree, 1)) == NULL){
+		PushInfixExpression(GetListData(tree, 1), hasPosition ? &pos : NULL);
+		return;
+	}
+
+	if(tree->type == TREE_IDENT){
+		PushIdent(infixBuilder, GetStrData(tree), strlen(GetStrData(tree)));
+	}
+	else if(tree->type == TREE_STR){
+		PushString(infixBuilder, GetStrData(tree), strlen(GetStrData(tree)));
+	}
+	else if(tree->type == TREE_NUM){
+		PushNumber(infixBuilder, GetNumberData(tree));
+	}
+	else if(tree->type == TREE_ERROR){
+		PushError(infixBuilder, GetErrorMessage(tree));
+	}
+	else if(tree->type == TREE_LIST){
+		quoted = quoted || IsQuotedForm(tree);
+		int list = BeginList(infixBuilder);
+		int i;
+		for(i = 0; i < ListTreeSize(tree); i++){
+			PushTreeCopy(GetListData(tree, i), quoted);
+		}
+		EndList(infixBuilder, list);
+	}
+	else if(tree->type == TREE_REF){
+		PushTreeCopy(GetObj(tree), quoted);
+		int ref = BeginReference(infixBuilder);
+		PushTreeCopy(GetRef(tree), quoted);
+		EndReference(infixBuilder, ref);
+	}
+
+	if(hasPosition){
+		SetPendingPosition(infixBuilder, &pos);
+	}
+}
+
+/* Push the prefix form of an operation node */
+void PushInfixNode(InfixParse* parse, int node, Position* pos){
+	VyParseTree* element = GetListData(parse->elements, parse->element[node]);
+	if(parse->left[node] < 0){
+		PushTreeCopy(element, 0);
+		return;
+	}
+
+	int list = BeginList(infixBuilder);
+	PushTreeCopy(element, 0);
+	PushInfixNode(parse, parse->left[node], pos);
+	PushInfixNode(parse, parse->right[node], pos);
+	EndList(infixBuilder, list);
+
+	/* The operations are at the position of the whole infix expression */
+	if(pos != NULL){
+		SetPendingPosition(infixBuilder, pos);
+	}
+}
+
+/* Push the prefix form of a valid infix expression */
+void PushInfixExpression(VyParseTree* elements, Position* pos){
+	VyRegion* scratch = GetScratchRegion();
+	RegionMark mark = MarkRegion(scratch);
+
+	InfixParse parse;
+	parse.elements = elements;
+	parse.numElements = ListTreeSize(elements);
+	parse.next = 0;
+	parse.element = RegionAlloc(scratch, sizeof(int) * parse.numElements);
+	parse.left = RegionAlloc(scratch, sizeof(int) * parse.numElements);
+	parse.right = RegionAlloc(scratch, sizeof(int) * parse.numElements);
+	parse.numNodes = 0;
+
+	int root = ParseInfixOperations(&parse, INT_MIN);
+	PushInfixNode(&parse, root, pos);
+
+	ReleaseRegion(scratch, mark);
+}
+
+/* Find the rewritten form of an infix form, rewriting it the first time */
+VyParseTree* GetInfixRewrite(VyParseTree* form, char** error){
+	VyParseTree* prefix = GetTreeCache(form);
+	if(prefix != NULL){
+		return prefix;
+	}
+
+	/* Check that the expression can be rewritten */
+	if(ListTreeSize(form) != 2 || GetListData(form, 1)->type != TREE_LIST){
+		*error = "Invalid infix form.";
+		return NULL;
+	}
+	VyParseTree* elements = GetListData(form, 1);
+	if(ListTreeSize(elements) == 0){
+		*error = "Empty infix expression.";
+		return NULL;
+	}
+	*error = ValidateInfix(elements);
+	if(*error != NULL){
+		return NULL;
+	}
+
+	if(infixBuilder == NULL){
+		infixBuilder = CreateTreeBuilder();
+	}
+
+	Position pos;
+	PushInfixExpression(elements, GetTreePosition(form, &pos) ? &pos : NULL);
+	prefix = FinishTree(infixBuilder);
+	SetTreeModule(prefix, GetTreeModule(form));
+
+	SetTreeCache(form, prefix);
+	return prefix;
+}
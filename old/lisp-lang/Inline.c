@@ -0,0 +1,168 @@
+#include "Vyion.h"
+
+/* An inline builtin: its name and the number of arguments inline calls take, the original function, and whether
+ * its name has been bound to anything else */
+typedef struct {
+	char* name;
+	int numArgs;
+	VyObject original;
+	int rebound;
+} InlineBuiltin;
+
+/* The inline builtins, in the order of their forms */
+__thread InlineBuiltin inlineBuiltins[NUM_INLINE_BUILTINS] = {
+	{"+", 2, -1, 0},
+	{"-", 2, -1, 0},
+	{"<", 2, -1, 0},
+	{"=", 2, -1, 0},
+	{"head", 1, -1, 0},
+	{"tail", 1, -1, 0},
+	{"nth", 2, -1, 0},
+	{"not", 1, -1, 0}
+};
+
+/* Remember the original builtins */
+void InitInlineBuiltins(){
+	int i;
+	for(i = 0; i < NUM_INLINE_BUILTINS; i++){
+		inlineBuiltins[i].original = FindValue(GetGlobalScope(), inlineBuiltins[i].name);
+		inlineBuiltins[i].rebound = 0;
+	}
+}
+
+/* Get or restore the original builtins and whether they were rebound (for heap images) */
+void GetInlineBuiltinState(VyObject* originals, int* rebound){
+	int i;
+	for(i = 0; i < NUM_INLINE_BUILTINS; i++){
+		originals[i] = inlineBuiltins[i].original;
+		rebound[i] = inlineBuiltins[i].rebound;
+	}
+}
+void SetInlineBuiltinState(VyObject* originals, int* rebound){
+	int i;
+	for(i = 0; i < NUM_INLINE_BUILTINS; i++){
+		inlineBuiltins[i].original = originals[i];
+		inlineBuiltins[i].rebound = rebound[i];
+	}
+}
+
+/* Find the index of an inline builtin by name, or -1 (the first character rules out most names quickly) */
+int FindInlineBuiltin(char* name){
+	if(strchr("+-<=htn", name[0]) == NULL){
+		return -1;
+	}
+
+	int i;
+	for(i = 0; i < NUM_INLINE_BUILTINS; i++){
+		if(strcmp(name, inlineBuiltins[i].name) == 0){
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Find the inline form of a call, if it has the right number of arguments (a call with named arguments doesn't) */
+int InlineBuiltinForm(char* name, int numArgs){
+	int index = FindInlineBuiltin(name);
+	if(index < 0 || inlineBuiltins[index].numArgs != numArgs){
+		return FORM_CALL;
+	}
+	return FORM_FIRST_INLINE + index;
+}
+
+/* Check whether an inline form is still valid */
+int InlineBuiltinIntact(int form){
+	return !inlineBuiltins[form - FORM_FIRST_INLINE].rebound;
+}
+
+/* Watch a binding (before the builtins are initialized, there is nothing to watch) */
+void WatchBinding(char* name, VyObject val){
+	int index = FindInlineBuiltin(name);
+	if(index >= 0 && inlineBuiltins[index].original >= 0 && val != inlineBuiltins[index].original){
+		inlineBuiltins[index].rebound = 1;
+	}
+}
+
+/* Evaluate an inline builtin. The common cases are done directly, and anything else (wrong types, mostly) is
+ * passed to the original builtin, so that the result is always the same as for an ordinary call. */
+VyObject EvalInlineBuiltin(int form, VyParseTree* tr){
+	InlineBuiltin* builtin = &inlineBuiltins[form - FORM_FIRST_INLINE];
+
+	/* Evaluate the arguments */
+	VyObject args[2];
+	int i;
+	for(i = 0; i < builtin->numArgs; i++){
+		args[i] = Eval(GetListData(tr, i + 1));
+	}
+
+	/* What is allocated from here on is allocated by this call */
+	VyParseTree* site = SetAllocationSite(tr);
+
+	/* Inline calls have one or two arguments, so check their types up front */
+	int numbers = (ObjType(args[0]) == VALNUM) && (builtin->numArgs < 2 || ObjType(args[1]) == VALNUM);
+	int listAndNumber = (ObjType(args[0]) == VALLIST) && (builtin->numArgs < 2 || ObjType(args[1]) == VALNUM);
+
+	VyObject result = -1;
+	switch(form){
+		case FORM_ADD:
+			if(numbers){
+				result = ToObject(AddNumbers(ObjData(args[0]), ObjData(args[1])));
+			}
+			break;
+
+		case FORM_SUBTRACT:
+			if(numbers){
+				result = ToObject(SubtractNumbers(ObjData(args[0]), ObjData(args[1])));
+			}
+			break;
+
+		case FORM_LT:
+			if(numbers){
+				VyNumber** one = ObjData(args[0]);
+				VyNumber** two = ObjData(args[1]);
+				if(one[0]->type != COMPLEX && two[0]->type != COMPLEX){
+					result = ToObject(LessThan(one, two));
+				}
+			}
+			break;
+
+		case FORM_EQ:
+			if(numbers){
+				result = ToObject(Equal(ObjData(args[0]), ObjData(args[1])));
+			}
+			break;
+
+		case FORM_HEAD:
+			if(listAndNumber){
+				result = ListHead(ObjData(args[0]));
+			}
+			break;
+
+		case FORM_TAIL:
+			if(listAndNumber){
+				result = ToObject(ListTail(ObjData(args[0])));
+			}
+			break;
+
+		case FORM_NTH:
+			if(listAndNumber && IsFixnum(args[1]) && GetInt(ObjData(args[1])) <= ListSize(ObjData(args[0]))){
+				result = ListGet(ObjData(args[0]), GetInt(ObjData(args[1])));
+			}
+			break;
+
+		case FORM_NOT:
+			if(ObjType(args[0]) == VALBOOL){
+				result = ToObject(BoolNot(ObjData(args[0])));
+			}
+			break;
+	}
+
+	/* Otherwise, let the builtin deal with it */
+	if(result < 0){
+		result = RunFunction(ObjData(builtin->original), args, builtin->numArgs);
+		result = LocateError(result, tr);
+	}
+
+	SetAllocationSite(site);
+	return result;
+}
@@ -1,31 +1,70 @@
 #include "Vyion.h"
 
-/* The resulting tokens */
-VyToken** tokenList = NULL;
-int numTokens = 0;
-int currentToken = 0; //For returning the tokens one by one
-
-/* The special characters */
-const char specialChars[] = { '(', ')', '[', ']', '{', '}', ':', '$', '\''};
+/* The resulting tokens, stored in one array which grows geometrically */
+__thread VyToken* tokenList = NULL;
+__thread int numTokens = 0;
+__thread int tokenCapacity = 0;
+__thread int currentToken = 0; //For returning the tokens one by one
+
+/* The initial size of the token array */
+#define INIT_TOKEN_CAPACITY 256
+
+/* The source being lexed. Tokens are slices of it, so it lives until CleanLexer() is called. */
+__thread char* source = NULL;
+__thread int sourceLength = 0;
+
+/* How the source buffer was obtained, which decides how to release it */
+#define SOURCE_BORROWED 0
+#define SOURCE_MAPPED   1
+#define SOURCE_READ     2
+__thread int sourceOwnership = SOURCE_BORROWED;
+
+/* Character classes, used to decide what to do with the next character in a single table lookup.
+ * The classes from CLASS_SPACE to CLASS_DOLLAR end an identifier; everything else may be inside one. */
+#define CLASS_IDENT        0
+#define CLASS_SPACE        1
+#define CLASS_TAB          2
+#define CLASS_NEWLINE      3
+#define CLASS_PUNCT        4
+#define CLASS_DOLLAR       5
+#define CLASS_STRING       6
+#define CLASS_LINE_COMMENT 7
+#define CLASS_HASH         8
+#define CLASS_BAR          9
+
+#define ENDS_IDENT(c) (charClass[(unsigned char)(c)] >= CLASS_SPACE && charClass[(unsigned char)(c)] <= CLASS_DOLLAR)
+
+static const unsigned char charClass[256] = {
+	['\0'] = CLASS_SPACE, [' '] = CLASS_SPACE, ['\r'] = CLASS_SPACE, ['\t'] = CLASS_TAB, ['\n'] = CLASS_NEWLINE,
+	['('] = CLASS_PUNCT, [')'] = CLASS_PUNCT, ['['] = CLASS_PUNCT, [']'] = CLASS_PUNCT,
+	['{'] = CLASS_PUNCT, ['}'] = CLASS_PUNCT, [':'] = CLASS_PUNCT, ['\''] = CLASS_PUNCT,
+	['$'] = CLASS_DOLLAR, ['"'] = CLASS_STRING, [';'] = CLASS_LINE_COMMENT, ['#'] = CLASS_HASH, ['|'] = CLASS_BAR
+};
+
+/* The token types of the single character (CLASS_PUNCT) tokens */
+static const unsigned char punctTokens[256] = {
+	['('] = OPAREN, [')'] = CPAREN, ['['] = OBRACKET, [']'] = CBRACKET,
+	['{'] = OCURLY, ['}'] = CCURLY, [':'] = COLON, ['\''] = QUOTE
+};
 
 /* Read the contents of a file */
-char* ReadFile(char* filename){
+char* ReadFile(char* filename, int* length){
 	/* Open that file for reading and make sure it is accessable */
 	FILE* file = fopen(filename, "r");
 	if(file == NULL){
 		fprintf(stderr, "\"%s\" not available.\n", filename);
-		exit(0);
+		ExitInterpreter();
 	}
 
 	/* Find the size of the file */
 	fseek(file, 0, SEEK_END);
-	int length = ftell(file);
+	*length = ftell(file);
 
 	/* Return to the beginning of the file for reading */
 	fseek(file, 0, SEEK_SET);	
 
 	/* Read the contents of the file */
-	int size = sizeof(char)*(length);
+	int size = sizeof(char)*(*length);
 
 	/* Add one to the memory needed for the extra '\0' character */
 	char* contents = malloc(size + 1);
@@ -42,21 +81,9 @@ char* ReadFile(char* filename){
 	return contents;
 }
 
-/* Anything non-whitespace and not a special character returns true */
-int isIdentChar(char c){
-	/* Check that it isn't whitespace or a special character */
-	if(isWhitespace(c) == 1) return 0;
-	int i;
-	for( i = 0; i < 9; i++){
-		if(c == specialChars[i]) return 0;
-	}
-
-	return 1;
-}
-
-/* Decide whether a string is a number or an identifier */
-int isNumber(CharList* str){
-	char first = Get(str, 0);
+/* Decide whether a token's text is a number or an identifier */
+int isNumber(char* str, int size){
+	char first = str[0];
 
 	/* A string is a number if:
 	 *  - the first character is a number
@@ -71,35 +98,35 @@ int isNumber(CharList* str){
 		return 1;
 	}
 	/* It can also be a number if the first character is  '+', '-', or '.' (but only if there are more characters later)  */
-	else if((first == '-' || first == '+' || first == '.') && Size(str) > 1){
+	else if((first == '-' || first == '+' || first == '.') && size > 1){
 		/* The rest must be either numeric or 'e' 
 		 * 'e' can only occur once, and cannot be second or last */
 		int occurences_of_e = 0;
 		int i;
-		for(i = 1; i < Size(str); i++){
+		for(i = 1; i < size; i++){
 			/* Deal with the 'e' case */
-			if(Get(str, i) == 'e'){
+			if(str[i] == 'e'){
 				/* In a number, it cannot be second or last */
-				if(i == 1 || i == (Size(str) - 1) || occurences_of_e > 0){
+				if(i == 1 || i == (size - 1) || occurences_of_e > 0){
 					return 0;   //If it is, then it's not a number, therefore return false
 				}
 				occurences_of_e++;
 			}
 			/* Make sure '.' isn't repeated twice */
-			else if(Get(str,i) == '.'){
+			else if(str[i] == '.'){
 				if(first == '.'){
 					return 0;
 				}
 			}
 			/* Also, if it ends with i then it is an imaginary number */
-			else if(Get(str,i) == 'i' || Get(str,i) == 'I'){
+			else if(str[i] == 'i' || str[i] == 'I'){
 				/* If it isn't one, then it is an error and it cannot be a number */
-				if(i != Size(str) - 1) {
+				if(i != size - 1) {
 					return 0;
 				}
 			}
 			/* If any character is non-numeric, not 'e', and not '.', then it can't be a number */
-			else if(!isNumeric(Get(str,i))){
+			else if(!isNumeric(str[i])){
 				return 0;
 			}
 		}
@@ -115,14 +142,32 @@ int isNumber(CharList* str){
 }
 
 /* Add a new token with a position */
-void AddToken(VyToken* tok, int line, int character, int indent){
-	/* Set the position */
-	SetTokenPosition(tok, line, character, indent);
+void AddToken(int type, int offset, int length, int line, int character, int indent){
+	/* Make more room if needed, doubling the array so that adding tokens is amortized constant time */
+	if(numTokens == tokenCapacity){
+		tokenCapacity = (tokenCapacity == 0) ? INIT_TOKEN_CAPACITY : tokenCapacity * 2;
+		tokenList = realloc(tokenList, tokenCapacity*sizeof(VyToken));
+	}
 
-	/* Make more room and add it to the array */
+	VyToken* tok = &tokenList[numTokens];
 	numTokens++;
-	tokenList = realloc(tokenList, (numTokens)*sizeof(VyToken*));
-	tokenList[numTokens - 1] = tok;
+
+	tok->type = type;
+	tok->offset = offset;
+	tok->length = length;
+	tok->pos.line = line;
+	tok->pos.character = character;
+	tok->pos.indent = indent;
+}
+
+/* Get a pointer to the text of a token (which is not null terminated) */
+char* TokenText(VyToken* tok){
+	return source + tok->offset;
+}
+
+/* Copy the text of a token into a new string */
+char* TokenToStr(VyToken* tok){
+	return strndup(source + tok->offset, tok->length);
 }
 
 /* Convert a token type int to a string */
@@ -146,28 +191,11 @@ char* GetTokenTypeStr(VyToken* tok){
 	}
 }
 
-/* Get the data from a token in text form for printing */
-char* GetTokenDataStr(VyToken* tok){
-	int type = tok->type;
-	switch(type){
-		case 0: return "(";
-		case 1: return ")";
-		case 2: return "[";
-		case 3: return "]";
-		case 4: return ":";
-		case 5: return "$";
-		case 6: return "'";
-		default: return tok->data;
-	}
-}   
-
 /* Print a token in a pretty manner */
 void PrintToken(VyToken* tok){
 	printf("\nToken Type: %s\t", GetTokenTypeStr(tok));
-	if(HasKnownPosition(tok)){
-		printf("at position:(%d, %d, %d)\t", GetLine(tok), GetCharacter(tok), GetIndent(tok));
-	}
-	printf(" with data: %s", GetTokenDataStr(tok));
+	printf("at position:(%d, %d, %d)\t", GetLine(tok), GetCharacter(tok), GetIndent(tok));
+	printf(" with data: %.*s", tok->length, TokenText(tok));
 
 
 }
@@ -176,259 +204,251 @@ void PrintToken(VyToken* tok){
 void PrintTokenList(){
 	int i;
 	for(i = 0; i < numTokens; i++){
-		VyToken* tok = tokenList[i];
-		PrintToken(tok);
+		PrintToken(&tokenList[i]);
 	}
 }
 
-/* Clean-up functions */
-void DeleteTokenList(){
-	/* Free each token individually */
-	int t;
-	for(t = 0; t < numTokens; t++){
-		DeleteToken(tokenList[t]);
+/* Release the source buffer */
+void ReleaseSource(){
+	if(sourceOwnership == SOURCE_MAPPED){
+		munmap(source, sourceLength);
+	}
+	else if(sourceOwnership == SOURCE_READ){
+		free(source);
 	}
 
-	/* Free the token list itself */
-	free(tokenList);
-	tokenList = NULL;
+	source = NULL;
+	sourceLength = 0;
+	sourceOwnership = SOURCE_BORROWED;
 }
 
-/* Clean up so the lexer can be reused */
+/* Clean up so the lexer can be reused (the token array is kept for the next use) */
 void CleanLexer(){
-	DeleteTokenList();
+	ReleaseSource();
 	numTokens = 0;
 	currentToken = 0;
 }
 
-/* Perform lexing on the given text */
-void Lex(char* text){
-	/* Keep track of the amount processed */
-	int length = strlen(text);
-	int read = 0;   
-
-	/* Keep track of the current position in the file */
-	int line = 0;
-	int charOnLine = 0;
-	int indent = 0;
-
-	/* Process all the text until the ASCII 0 character */
-	while(read < length){
-		/* Read next character */
-		char next = text[read];
-		read++;
-
-		/* Use newlines and spaces for position */
-		if(isWhitespace(next)){
-			if(next == '\n'){
-				line++;
-				indent = 0;
-				charOnLine = 0;
-			}else{
-				if(next == '\t'){
-					indent++;
-				}
-				charOnLine++;
-			}
-
+/* Skip a nested |{ comment }| starting at the given index, and return the index after it */
+int SkipBlockComment(char* text, int length, int read, int* line, int* charOnLine, int* indent){
+	/* Skip the opening |{ */
+	read += 2;
+	*charOnLine += 2;
+	int commentLevel = 1;
+
+	while(commentLevel > 0){
+		if(read >= length){
+			printf("Unclosed comment at end of program. Exiting.");
+			ExitInterpreter();
 		}
 
-		/* Recognize all the special characters */
-		else if(next == '('){
-			AddToken(EmptyToken(OPAREN), line, charOnLine, indent); 
-			charOnLine++;
-		}
-		else if(next == ')'){
-			AddToken(EmptyToken(CPAREN), line, charOnLine, indent); 
-			charOnLine++;
-		}
-		else if(next == '['){
-			AddToken(EmptyToken(OBRACKET), line, charOnLine, indent); 
-			charOnLine++;
+		char next = text[read];
+		if(next == '}' && read + 1 < length && text[read + 1] == '|'){
+			commentLevel--;
+			read += 2;
+			*charOnLine += 2;
+			continue;
 		}
-		else if(next == ']'){
-			AddToken(EmptyToken(CBRACKET), line, charOnLine, indent); 
-			charOnLine++;
+		else if(next == '|' && read + 1 < length && text[read + 1] == '{'){
+			commentLevel++;
+			read += 2;
+			*charOnLine += 2;
+			continue;
 		}
-		else if(next == ':'){
-			AddToken(EmptyToken(COLON), line, charOnLine, indent); 
-			charOnLine++;
+		else if(next == '\n'){
+			(*line)++;
+			*charOnLine = 0;
+			*indent = 0;
 		}
-		else if(next == '$'){
-			/* Check if it is a splice substitution */
-			if(text[read] == '@'){
-				AddToken(EmptyToken(DOLLARAT), line, charOnLine, indent);	
-				charOnLine++;
-				read++;
-			}else{
-				AddToken(EmptyToken(DOLLAR), line, charOnLine, indent);
+		else{
+			if(next == '\t'){
+				(*indent)++;
 			}
-
-			charOnLine++;
-		}
-		else if(next == '\''){
-			AddToken(EmptyToken(QUOTE), line, charOnLine, indent);
-			charOnLine++;
-		}
-		else if(next == '{'){
-			AddToken(EmptyToken(OCURLY), line, charOnLine, indent);
-			charOnLine++;
-		}
-		else if(next == '}'){
-			AddToken(EmptyToken(CCURLY), line, charOnLine, indent);
-			charOnLine++;
+			(*charOnLine)++;
 		}
 
-		/* Completely ignore comments */
-		else if(next == '|' && text[read] == '{'){
-			/* Comments start with |{ and end with }|, nested comments allowed */
-			charOnLine += 2;
-			read ++;
-			int commentLevel = 1;
-			next = text[read];
-			read++;
-
-			while(commentLevel > 0){
-				if(next == '}' && text[read] == '|'){
-					commentLevel--;
-				}
-				else if(next == '|' && text[read] == '{'){
-					commentLevel++;
+		read++;
+	}
 
-				}
-				else if(next == '\0'){
-					printf("Unclosed comment at end of program. Exiting.");
-					exit(0);
-				}
-				else if(next == '\n'){
-					line++;
-					charOnLine = 0;
-					indent = 0;
-				}
-				else if(next == '\t'){
-					indent++;
-				}
+	return read;
+}
 
+/* Perform lexing on a buffer of the given length, which starts at the given position in its file. The buffer
+ * doesn't need to be null terminated, but must stay valid until the lexer is cleaned, since the tokens refer to it. */
+void LexBufferAt(char* text, int length, Position* start){
+	source = text;
+	sourceLength = length;
+	numTokens = 0;
+	currentToken = 0;
+
+	/* Keep track of the amount processed */
+	int read = 0;   
+
+	/* Keep track of the current position in the file */
+	int line = start->line;
+	int charOnLine = start->character;
+	int indent = start->indent;
+
+	/* Process all the text in a single pass */
+	while(read < length){
+		unsigned char next = text[read];
+		int start = read;
+
+		switch(charClass[next]){
+			/* Use newlines and spaces for position */
+			case CLASS_SPACE:
+				read++;
 				charOnLine++;
-				next = text[read];
+				break;
+			case CLASS_TAB:
 				read++;
-				
-			}
-		}
-		else if(next == ';'){
-			/* For single line comments starting with a semicolon, just keep reading until the \n */
-			while(next != '\n' && next != '\0'){
-				next = text[read];
+				indent++;
+				charOnLine++;
+				break;
+			case CLASS_NEWLINE:
 				read++;
-			}
-
-			/* And increment the line count */
-			line++;
-			indent = 0;
-			charOnLine = 0;
-		}
-		else if(next == '#'){
-			/* Loop through until the end of the ident */
-			while(1){
-				if(!isIdentChar(text[read])){
-					break;	
-				}
+				line++;
+				indent = 0;
+				charOnLine = 0;
+				break;
 
-				next = text[read];
+			/* Recognize all the special characters */
+			case CLASS_PUNCT:
+				AddToken(punctTokens[next], start, 1, line, charOnLine, indent); 
 				read++;
+				charOnLine++;
+				break;
 
-				/* Position */
-				if(next == '\n'){
-					line++;
-					indent = 0;
-					charOnLine = 0;
+			/* Check if it is a splice substitution */
+			case CLASS_DOLLAR:
+				if(read + 1 < length && text[read + 1] == '@'){
+					AddToken(DOLLARAT, start, 2, line, charOnLine, indent);	
+					read += 2;
+					charOnLine += 2;
 				}else{
+					AddToken(DOLLAR, start, 1, line, charOnLine, indent);
+					read++;
 					charOnLine++;
 				}
-			}
-		}
+				break;
 
-		/* Record strings enclosed in "quotes" separately */
-		else if(next == '"'){
-			/* Record the 'previous' character and keep reading until you have a quote not preceeded by a backslash */
-			CharList* str_contents = MakeCharList();
-
-			char prev = next;
-			next = text[read];
-			read++;
-			charOnLine++;
-
-			/* Record the starting position */
-			int start_line = line;
-			int start_char = charOnLine;
+			/* For single line comments starting with a semicolon, just skip to the newline */
+			case CLASS_LINE_COMMENT:
+				while(read < length && text[read] != '\n'){
+					read++;
+				}
+				break;
 
-			while(next != '"' || prev == '\\'){
-				Add(str_contents, next);
-				prev = next;
-				next = text[read];
+			/* A # comments out the identifier following it */
+			case CLASS_HASH:
 				read++;
-
-				/* Position */
-				if(next == '\n'){
-					line++;
-					indent = 0;
-					charOnLine = 0;
-				}else{
+				while(read < length && !ENDS_IDENT(text[read])){
+					read++;
+				}
+				charOnLine += read - start;
+				break;
+
+			/* Record strings enclosed in "quotes" separately */
+			case CLASS_STRING:
+				{
+					/* Keep reading until there is a quote not preceeded by a backslash */
+					int startLine = line;
+					int startChar = charOnLine;
+					int startIndent = indent;
+
+					read++;
+					charOnLine++;
+					while(read < length && (text[read] != '"' || text[read - 1] == '\\')){
+						/* Position */
+						if(text[read] == '\n'){
+							line++;
+							indent = 0;
+							charOnLine = 0;
+						}else{
+							charOnLine++;
+						}
+						read++;
+					}
+
+					/* The string contents are between the quotes */
+					AddToken(STRING, start + 1, read - start - 1, startLine, startChar, startIndent);
+
+					/* Skip the closing quote */
+					read++;
 					charOnLine++;
 				}
+				break;
 
-			}
+			/* Completely ignore comments, which start with |{ and end with }| (nested comments allowed) */
+			case CLASS_BAR:
+				if(read + 1 < length && text[read + 1] == '{'){
+					read = SkipBlockComment(text, length, read, &line, &charOnLine, &indent);
+					break;
+				}
 
-			/* Add the string token and clean up */
-			AddToken(DataToken(STRING, ToStr(str_contents)), start_line, start_char, indent);
-			Delete(str_contents);
+				/* Otherwise, the bar is just part of an identifier */
 
-		}
-		/* Lastly, deal with numbers and identifiers */
-		else {
-
-			/* Find the whole string */
-			CharList* ident = MakeCharList();
-			while(isIdentChar(next) && next != '\0'){  //While the character can be in a number or identifier, keep reading
-				Add(ident, next);
-				next = text[read];
-				read++;
-				charOnLine++;
-			}
-
-			/* Don't skip the character after the ident, it may be a symbol and not a space */
-			read--;
-
-			/* Convert the character list to a string */
-			char* ident_string = ToStr(ident);
-		
-			/* Decide whether the string is a number or identifier token and add it */
-			if(isNumber(ident)){
-				AddToken(DataToken(NUM, ident_string), line, charOnLine, indent);
-			}else{
-				AddToken(DataToken(IDENT, ident_string), line, charOnLine, indent);
-			}
+			/* Lastly, deal with numbers and identifiers */
+			default:
+				/* Find the whole identifier */
+				while(read < length && !ENDS_IDENT(text[read])){
+					read++;
+				}
 
-			/* The string is no longer needed, so delete it */
-			Delete(ident);
+				/* Decide whether the string is a number or identifier token and add it */
+				if(isNumber(text + start, read - start)){
+					AddToken(NUM, start, read - start, line, charOnLine, indent);
+				}else{
+					AddToken(IDENT, start, read - start, line, charOnLine, indent);
+				}
+				charOnLine += read - start;
+				break;
 		}
 	}
 
 }
 
-/* A utility function for reading and lexing a whole file */
+/* Perform lexing on a buffer that starts a file */
+void LexBuffer(char* text, int length){
+	Position start = {0, 0, 0};
+	LexBufferAt(text, length, &start);
+}
+
+/* Perform lexing on the given string */
+void Lex(char* text){
+	LexBuffer(text, strlen(text));
+}
+
+/* A utility function for reading and lexing a whole file. The file is memory mapped when possible, so
+ * its contents are never copied; otherwise, it is read into memory. */
 void LexFile(char* filename){
-	/* Read the file and perform lexing */
-	char* fileContents = ReadFile(filename);
-	Lex(fileContents);
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0){
+		fprintf(stderr, "\"%s\" not available.\n", filename);
+		ExitInterpreter();
+	}
 
-	/* Free the memory used by the file contents */
-	free(fileContents);
+	struct stat info;
+	void* mapped = MAP_FAILED;
+	if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+		mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
 
+	if(mapped != MAP_FAILED){
+		LexBuffer(mapped, info.st_size);
+		sourceOwnership = SOURCE_MAPPED;
+	}
+	else{
+		int length;
+		char* fileContents = ReadFile(filename, &length);
+		LexBuffer(fileContents, length);
+		sourceOwnership = SOURCE_READ;
+	}
 }
 
 /* Functions to access the token list */
-VyToken** GetTokenList(){
+VyToken* GetTokenList(){
 	return tokenList;
 }
 
@@ -445,7 +465,7 @@ VyToken* GetNextToken(){
 	if(currentToken >= numTokens){
 		return NULL;
 	}else{
-		VyToken* next = tokenList[currentToken];
+		VyToken* next = &tokenList[currentToken];
 		currentToken++; //Increment the index of the current token
 		return next;
 	}
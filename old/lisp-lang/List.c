@@ -47,15 +47,22 @@ VyObject ListGet(VyList** l, int index){
 
 /* Clone a list */
 VyList** CloneList(VyList** l){
-	/* A base case for recursive list copying */
 	if(l == NULL){
 		return NULL;	
 	}
-	//printf("List data: (id %d) (ptr %p) (rptr %p) (next %p) (data %d)\n", ToObject(l), l, l[0], l[0]->next, l[0]->data);fflush(stdout);
 
 	VyList** new = CreateList();
 	new[0]->data = l[0]->data;
-	new[0]->next = CloneList(l[0]->next);
+
+	/* Copy the rest of the nodes iteratively, so that long lists don't overflow the stack. Creating a node may move
+	 * the heap, so the previous node has to be dereferenced only after the new one has been created. */
+	VyList** last = new;
+	for(l = l[0]->next; l != NULL; l = l[0]->next){
+		VyList** node = CreateList();
+		node[0]->data = l[0]->data;
+		last[0]->next = node;
+		last = node;
+	}
 
 	return new;
 }
@@ -69,18 +76,15 @@ void ListInternalAppend(VyList** l, VyObject v){
 		return;
 	}
 
-	/* If this is the last node, add the value to a new node */
-	if(l[0]->next == NULL){
-		VyList** x = CreateList();
-		l[0]->next = x;
-		l[0]->next[0]->data = v;
+	/* Proceed to the last node */
+	while(l[0]->next != NULL){
+		l = l[0]->next;
 	}
 
-	/* Otherise, proceed to the last node */
-	else{
-		/* Use ListInternapAppend because here, we want it to have the 'side-effect' of actually adding something to the list */
-		ListInternalAppend(l[0]->next, v);	
-	}
+	/* And add the value to a new node */
+	VyList** x = CreateList();
+	x[0]->data = v;
+	l[0]->next = x;
 }
 
 /* Append an element to a list */
@@ -91,6 +95,20 @@ VyList** ListAppend(VyList** l, VyObject v){
 	return new;
 }
 
+/* Add an element to the end of a list being built */
+VyList** ListBuildAppend(VyList** last, VyObject v){
+	/* An empty list just gets its data set */
+	if(last[0]->data < 0){
+		last[0]->data = v;
+		return last;
+	}
+
+	VyList** x = CreateList();
+	x[0]->data = v;
+	last[0]->next = x;
+	return x;
+}
+
 /* Find the size of a list */
 int ListSize(VyList** l){
 	/* Check for empty list */
@@ -156,7 +174,8 @@ VyList** ListConcat(VyList** one, VyList** two){
 	VyList** node = GetListStartingAt(oneCopy, ListSize(oneCopy));
 
 	/* Set the next one to be the start of list two */
-	node[0]->next = CloneList(two);
+	VyList** twoCopy = CloneList(two);
+	node[0]->next = twoCopy;
 
 	return oneCopy;
 }
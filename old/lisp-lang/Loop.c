@@ -0,0 +1,167 @@
+#include "Vyion.h"
+
+/* A break returns this one flow control object (instead of creating a new one each time), and leaves its value here */
+__thread VyObject breakSignal;
+__thread VyObject breakValue;
+
+/* Create the break object */
+void InitLoops(){
+	breakSignal = ToObject(CreateFlowControl(FLOWBREAK, NULL));
+	breakValue = -1;
+}
+
+/* Get or restore the break object (for heap images) */
+VyObject GetBreakSignal(){
+	return breakSignal;
+}
+void SetBreakSignal(VyObject signal){
+	breakSignal = signal;
+	breakValue = -1;
+}
+
+/* Evaluate a break */
+VyObject EvalBreak(VyParseTree* tr){
+	if(ListTreeSize(tr) > 2){
+		return ToObject(CreateError("Break takes at most one value.", tr));
+	}
+
+	if(ListTreeSize(tr) == 2){
+		breakValue = Eval(GetListData(tr, 1));
+		if(ObjType(breakValue) == VALERROR){
+			return breakValue;
+		}
+	}else{
+		breakValue = ToObject(MakeFalseBool());
+	}
+	return breakSignal;
+}
+
+/* Run the body of a loop (the elements of the form from the given one onwards) once. Return 1 to keep looping,
+ * or 0 if the loop should stop and return the value left in the result. */
+int RunLoopBody(VyParseTree* tr, int first, VyObject* result){
+	int i;
+	for(i = first; i < ListTreeSize(tr); i++){
+		VyObject val = Eval(GetListData(tr, i));
+
+		if(val == breakSignal){
+			*result = breakValue;
+			return 0;
+		}
+		if(ObjType(val) == VALERROR || ObjType(val) == VALFLOW){
+			*result = val;
+			return 0;
+		}
+
+		*result = val;
+	}
+	return 1;
+}
+
+/* Check that a loop has enough elements before its body */
+int CheckLoopForm(VyParseTree* tr, int bodyStart, VyObject* error){
+	if(ListTreeSize(tr) < bodyStart){
+		*error = ToObject(CreateError("Missing loop arguments.", tr));
+		return 0;
+	}
+	if(bodyStart > 2 && GetListData(tr, 1)->type != TREE_IDENT){
+		*error = ToObject(CreateError("A loop variable must be an identifier.", GetListData(tr, 1)));
+		return 0;
+	}
+	return 1;
+}
+
+/* While loops */
+VyObject EvalWhile(VyParseTree* tr){
+	VyObject result = ToObject(MakeFalseBool());
+	if(!CheckLoopForm(tr, 2, &result)){
+		return result;
+	}
+
+	while(1){
+		/* The condition must be a boolean, as for if */
+		VyObject cond = Eval(GetListData(tr, 1));
+		if(ObjType(cond) == VALERROR){
+			return cond;
+		}
+		if(ObjType(cond) != VALBOOL){
+			return ToObject(CreateError("Invalid boolean variable (condition must evaluate to boolean). ", GetListData(tr, 1)));
+		}
+		if(!IsTrue(ObjData(cond))){
+			return result;
+		}
+
+		if(!RunLoopBody(tr, 2, &result)){
+			return result;
+		}
+	}
+}
+
+/* Loops which run until they break */
+VyObject EvalLoop(VyParseTree* tr){
+	VyObject result;
+	while(RunLoopBody(tr, 1, &result)){
+	}
+	return result;
+}
+
+/* Numeric loops */
+VyObject EvalForRange(VyParseTree* tr){
+	VyObject result = ToObject(MakeFalseBool());
+	if(!CheckLoopForm(tr, 4, &result)){
+		return result;
+	}
+
+	/* Find the bounds, which must be integers */
+	VyObject bounds[2];
+	int i;
+	for(i = 0; i < 2; i++){
+		bounds[i] = Eval(GetListData(tr, i + 2));
+		if(ObjType(bounds[i]) == VALERROR){
+			return bounds[i];
+		}
+
+		VyNumber** num = (ObjType(bounds[i]) == VALNUM) ? ObjData(bounds[i]) : NULL;
+		if(num == NULL || num[0]->type != INT){
+			return ToObject(CreateError("The bounds of a range must be integers.", GetListData(tr, i + 2)));
+		}
+	}
+
+	char* varName = GetStrData(GetListData(tr, 1));
+	Scope* scope = GetBindingScope();
+	int end = GetInt(ObjData(bounds[1]));
+	int n;
+	for(n = GetInt(ObjData(bounds[0])); n < end; n++){
+		SetVariable(scope, varName, ToObject(CreateInt(n)));
+		if(!RunLoopBody(tr, 4, &result)){
+			break;
+		}
+	}
+	return result;
+}
+
+/* Loops over the elements of a list, walking its nodes */
+VyObject EvalForEach(VyParseTree* tr){
+	VyObject result = ToObject(MakeFalseBool());
+	if(!CheckLoopForm(tr, 3, &result)){
+		return result;
+	}
+
+	VyObject list = Eval(GetListData(tr, 2));
+	if(ObjType(list) == VALERROR){
+		return list;
+	}
+	if(ObjType(list) != VALLIST){
+		return ToObject(CreateError("For-each can only loop over a list.", GetListData(tr, 2)));
+	}
+
+	char* varName = GetStrData(GetListData(tr, 1));
+	Scope* scope = GetBindingScope();
+	VyList** node;
+	for(node = ObjData(list); node != NULL && node[0]->data >= 0; node = node[0]->next){
+		SetVariable(scope, varName, node[0]->data);
+		if(!RunLoopBody(tr, 3, &result)){
+			break;
+		}
+	}
+	return result;
+}
@@ -31,6 +31,9 @@ VyParseTree* EvalMacro(VyMacro** mac, VyObject* args, int numArgs){
 
 /* Parse a macro */
 VyObject ParseMacro(VyParseTree* code){
+	/* The macro keeps the code */
+	RetainParseTree();
+
 	/* Parse the function arguments */
 	VyParseTree* args = GetListData(code, 1);
 	int numArguments = 0;
@@ -40,26 +43,10 @@ VyObject ParseMacro(VyParseTree* code){
 		return ToObject(CreateError(error, code));	
 	}
 
-	/* Take the rest of the expressions in the lambda as code */
-	VyParseTree* exprList = MakeListTree();
-	int i;
-	for(i = 2; i < ListTreeSize(code); i++){
-		AddToList(exprList, GetListData(code, i));  
-	}
-
-	/* Take variables from the current function scope and the local scope */
-	Scope* funcScope = GetCurrentFunctionScope();
-	Scope* localScope = GetLocalScope();
-
-	/* Make sure the local scope isn't the global scope */
-	if(localScope == GetGlobalScope()) {
-		localScope = NULL; 
-	}
-
-	/* Merge the two scopes to get the current function scope */
-	Scope* closureScope = MergeScopes(funcScope, localScope);
+	/* The macro captures the variables it uses from the frame it is created in */
+	Scope* closureScope = CaptureClosure(GetFrameLayout(code, arguments, numArguments));
 
 	/* Create the function from the data gathered */
-	VyMacro** mac = CreateMacro(arguments, numArguments, exprList, closureScope);
+	VyMacro** mac = CreateMacro(arguments, numArguments, code, closureScope);
 	return ToObject(mac);	
 }
@@ -0,0 +1,215 @@
+#include "Vyion.h"
+
+/* The interpreter program: it runs the files it is given, or the read-eval-print loop if it isn't given any.
+ * (It is kept apart from the evaluator, so that other programs, like the microbenchmarks, can link the interpreter.)
+ */
+
+/* Given a char list, check that all parens balance */
+int AllParensClosed(CharList* list){
+	int counting = 1;
+	int parens = 0;		
+
+	int c;
+	for(c = 0; c < Size(list); c++){
+		char next = Get(list, c);	
+		if(counting){
+			if(next == '('){
+				parens++;	
+			}
+			else if(next == ')'){
+				parens--;	
+			}
+		}
+	}
+
+	if(parens == 0){
+		return 1;	
+	}else{
+		return 0;	
+	}
+}
+
+/* The read eval print loop */
+void ReadEvalPrintLoop(){
+	CharList* strList = MakeCharList();	
+	int c = 0;
+
+	/* Let the user enter expressions and evaluate them */
+	while(c != EOF){
+		printf("V >> ");	
+		fflush(stdout);
+
+		/* Get user input */
+		Clear(strList);
+		while(1){
+			c = getchar();
+			/* On entered newline, if all parenthesis balance, stop, otherwise continue data enterage */
+			if(c == EOF || (c == '\n' && AllParensClosed(strList))){
+				break;
+			}else if(c == '\n'){
+				printf("     ");	
+			}
+
+			Add(strList, c);
+		}
+
+		/* Lex, parse, eval (the line only lives as long as the form) */
+		char* str = RegionStrndup(GetFormRegion(), strList->chars, Size(strList));
+
+		/* For convenience, exit when the user types "exit" and "quit" */
+		if(StrEquals(str, "exit") || StrEquals(str, "quit")){
+			exit(1);	
+		}
+
+		Lex(str);
+		VyParseTree* tree = Parse();
+		CleanLexer();
+		if(tree == NULL){
+			ResetRegion(GetFormRegion());
+			continue;	
+		}
+
+		/* Look for errors, if none found, eval and print result */
+		SetParseTreeRetained(0);
+		if(!CheckAndPrintErrors(tree)){
+			VyObject val = EvalTopLevel(tree);
+			printf("\n");
+			PrintObj(val);
+			printf("\n");
+		}
+
+		/* Free various resources */
+		CleanParser();
+		FinishTopLevel(tree);
+	}
+
+	Delete(strList);
+}
+
+/* Run each file in a context of its own, all at once, returning whether they all ran without an error */
+int RunInParallel(char** files, int numFiles){
+	VyContext** contexts = malloc(sizeof(VyContext*) * numFiles);
+	int succeeded = 1;
+
+	int i;
+	for(i = 0; i < numFiles; i++){
+		contexts[i] = StartContext(files + i, 1);
+		if(contexts[i] == NULL){
+			fprintf(stderr, "Couldn't start a thread to run \"%s\".\n", files[i]);
+			succeeded = 0;
+		}
+	}
+
+	for(i = 0; i < numFiles; i++){
+		if(contexts[i] != NULL && !JoinContext(contexts[i])){
+			succeeded = 0;
+		}
+	}
+
+	free(contexts);
+	return succeeded;
+}
+
+/* Run the interpreter */
+int main(int argc, char** argv){
+	/* The options come before the files: --load-image starts from an image instead of from scratch,
+	 * --save-image saves one once the files have been processed, --profile profiles the program, --trace
+	 * traces it, --heap-profile samples one in so many allocations to find where they are made, and --stats
+	 * writes the allocation counters once it is done. --parallel, which takes no argument, runs each file in an
+	 * interpreter of its own, all at once */
+	char* loadImage = NULL;
+	char* saveImage = NULL;
+	char* profile = NULL;
+	char* trace = NULL;
+	char* stats = NULL;
+	int heapProfileRate = 0;
+	int parallel = 0;
+	int file = 1;
+	while(file + 1 < argc){
+		if(StrEquals(argv[file], "--parallel")){
+			parallel = 1;
+			file++;
+			continue;
+		}
+
+		if(StrEquals(argv[file], "--load-image")){
+			loadImage = argv[file + 1];
+		}
+		else if(StrEquals(argv[file], "--save-image")){
+			saveImage = argv[file + 1];
+		}
+		else if(StrEquals(argv[file], "--profile")){
+			profile = argv[file + 1];
+		}
+		else if(StrEquals(argv[file], "--trace")){
+			trace = argv[file + 1];
+		}
+		else if(StrEquals(argv[file], "--heap-profile")){
+			heapProfileRate = atoi(argv[file + 1]);
+		}
+		else if(StrEquals(argv[file], "--stats")){
+			stats = argv[file + 1];
+		}
+		else{
+			break;
+		}
+		file += 2;
+	}
+
+	/* The files have interpreters of their own, so the main thread only waits for them */
+	if(parallel){
+		if(loadImage != NULL || saveImage != NULL || profile != NULL || trace != NULL || stats != NULL || heapProfileRate > 0){
+			fprintf(stderr, "--parallel can't be used with images, the profilers, the tracer or --stats.\n");
+			exit(0);
+		}
+		return RunInParallel(argv + file, argc - file) ? 1 : 0;
+	}
+
+	if(loadImage == NULL){
+		InitEvaluator();
+	}
+	else if(!LoadImage(loadImage)){
+		fprintf(stderr, "\"%s\" is not an image this interpreter can load.\n", loadImage);
+		exit(0);
+	}
+
+	if(profile != NULL){
+		StartProfiler(profile);
+	}
+	if(trace != NULL){
+		StartTracer(trace);
+	}
+	if(heapProfileRate > 0){
+		StartHeapProfiler(heapProfileRate);
+	}
+
+	/* If given filenames, process all that are given, otherwise enter the read-eval-print-loop */
+	if(file < argc || saveImage != NULL){
+		SetReplMode(0);
+		for(; file < argc; file++){
+			RunFile(argv[file]);
+		}
+	}
+	else{
+		SetReplMode(1);
+		ReadEvalPrintLoop();
+	}
+
+	if(saveImage != NULL && !SaveImage(saveImage)){
+		fprintf(stderr, "Couldn't save an image to \"%s\".\n", saveImage);
+	}
+
+	if(stats != NULL && !WriteMemoryStats(stats)){
+		fprintf(stderr, "Couldn't write the allocation counters to \"%s\".\n", stats);
+	}
+
+	/* Report the profiles and write the trace while the objects still exist */
+	StopProfiler();
+	StopHeapProfiler();
+	StopTracer();
+
+	/* Free memory */
+	FreeHeap(GetMemoryHeap());
+
+	return 1;
+}
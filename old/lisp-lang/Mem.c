@@ -23,18 +23,72 @@ void InitMem(){
 	/* And allocate the heap memory itself */
 	heap->heapBase = heap->freeMem = malloc(INIT_ALLOC);
 	heap->heapSize = INIT_ALLOC;
+	heap->mapped = 0;
+	heap->objectsAllocated = heap->bytesAllocated = heap->collections = 0;
 
 	/* Set this heap as the current memory heap */
 	SetMemoryHeap(heap);
 }
 
+/* Initialize the memory manager with objects which are already laid out in memory */
+int InitMemFrom(void* base, int size, char* types, int numObjects, int idMapSize){
+	VyMemHeap* heap = malloc(sizeof(VyMemHeap));
+	heap->objectsOnHeap = numObjects;
+	heap->idMapSize = idMapSize;
+
+	/* The heap is full, so the first allocation moves the objects into a new heap */
+	heap->heapBase = base;
+	heap->freeMem = base + size;
+	heap->heapSize = heap->usedSpace = size;
+	heap->mapped = 1;
+	heap->objectsAllocated = heap->bytesAllocated = heap->collections = 0;
+
+	/* Make the ID maps, just as if the objects had been created one by one */
+	heap->numIdMaps = (numObjects + idMapSize - 1) / idMapSize;
+	heap->idMapArray = malloc(sizeof(void***) * heap->numIdMaps);
+
+	int map;
+	for(map = 0; map < heap->numIdMaps; map++){
+		heap->idMapArray[map] = malloc(sizeof(void**) * 2);
+		heap->idMapArray[map][0] = malloc(sizeof(void*) * idMapSize);
+		heap->idMapArray[map][1] = malloc(sizeof(void*) * idMapSize);
+	}
+
+	void* obj = base;
+	int id;
+	for(id = 0; id < numObjects; id++){
+		if(types[id] < VALNUM || types[id] > VALFLOW || obj + sizeof(int) > base + size || *(int*)(obj) != id){
+			return 0;
+		}
+
+		heap->idMapArray[id / idMapSize][0][id % idMapSize] = (void*)(long)(types[id]);
+		heap->idMapArray[id / idMapSize][1][id % idMapSize] = obj + sizeof(int);
+		obj += sizeof(int) + DataSize(types[id]);
+	}
+
+	SetMemoryHeap(heap);
+	return obj == base + size;
+}
+
 /* Free the remaining memory */
 void FreeHeap(VyMemHeap* heap){
+	int map;
+	for(map = 0; map < heap->numIdMaps; map++){
+		free(heap->idMapArray[map][0]);
+		free(heap->idMapArray[map][1]);
+		free(heap->idMapArray[map]);
+	}
+	free(heap->idMapArray);
+
+	if(!heap->mapped){
+		free(heap->heapBase);
+	}
 	free(heap);	
 }
 
 /* Force a collection cycle to happen */
 void VyMemCollect(VyMemHeap* heap){
+	long start = TraceStart();
 	void* newHeap = calloc(1, heap->heapSize * ALLOC_STEP);
 	if(newHeap == NULL){
 		printf("Not enough space for large heap. Dead.");		
@@ -55,9 +109,15 @@ void VyMemCollect(VyMemHeap* heap){
 		memcpy(freeMemStart, toCopy, objSize);
 		freeMemStart += objSize;
 	}
-	free(heap->heapBase);
+	if(!heap->mapped){
+		free(heap->heapBase);
+	}
+	heap->mapped = 0;
 	heap->heapBase = newHeap;
 	heap->freeMem = freeMemStart;
+	heap->collections++;
+
+	TraceEnd(TRACE_GC, NULL, heap->heapSize, start);
 }
 
 /* Provide a way for Vyion to allocate memory on the heap */
@@ -65,13 +125,11 @@ void* VyMallocate(int size, VyMemHeap* heap){
 
 	/* Check whether the heap ran out of space, and if it has, it's time to for a garbage collection cycle */
 	if(size + heap->usedSpace > heap->heapSize){
-		printf("Heap: %p ", heap->freeMem);
 		VyMemCollect(heap);
-		printf("\nHeap: %p ", heap->freeMem);
-		printf("? %d ?\n", heap->objectsOnHeap);
 	}
 
 	/* Store and then increment the free memory location */
+	heap->bytesAllocated += size;
 	heap->usedSpace += size;
 	heap->freeMem += size;
 	return heap->freeMem - size;
@@ -0,0 +1,155 @@
+#include "Vyion.h"
+
+/* The modules, in the order they were loaded */
+__thread Module* modules = NULL;
+__thread int numModules = 0;
+__thread int moduleCapacity = 0;
+
+/* The namespace of the module being loaded (the global scope when none is), and its place in the registry */
+__thread Scope* moduleScope = NULL;
+__thread int loadingModule = -1;
+
+/* Find a module by its canonical path (or NULL) */
+Module* FindModule(char* path){
+	int i;
+	for(i = 0; i < numModules; i++){
+		if(StrEquals(modules[i].path, path)){
+			return &modules[i];
+		}
+	}
+	return NULL;
+}
+
+/* Make the name a module is shown by from its path */
+char* ModuleName(char* path){
+	char* directory = getcwd(NULL, 0);
+	int length = (directory != NULL) ? strlen(directory) : 0;
+
+	char* name;
+	if(length > 0 && strncmp(path, directory, length) == 0 && path[length] == '/'){
+		name = strdup(path + length + 1);
+	}else{
+		name = strdup(path);
+	}
+	free(directory);
+	return name;
+}
+
+/* Register a module (the path is taken over by the registry) */
+Module* AddModule(char* path, Scope* scope){
+	if(numModules == moduleCapacity){
+		moduleCapacity = (moduleCapacity == 0) ? 8 : moduleCapacity * 2;
+		modules = realloc(modules, sizeof(Module) * moduleCapacity);
+	}
+
+	Module* module = &modules[numModules++];
+	module->path = path;
+	module->name = ModuleName(path);
+	module->scope = scope;
+	module->loading = 0;
+	return module;
+}
+
+/* Load a module (again, if reloading it), with its namespace as the module scope */
+void LoadModule(char* filename, int included, int reload){
+	/* A file which isn't there has no canonical path; processing it reports that */
+	char* path = realpath(filename, NULL);
+	if(path == NULL){
+		ProcessFile(filename, included);
+		return;
+	}
+
+	/* Modules are found by index, since loading other modules may move the registry */
+	Module* module = FindModule(path);
+	if(module != NULL){
+		free(path);
+		if(module->loading || !reload){
+			return;
+		}
+	}else{
+		module = AddModule(path, included ? CreateScope() : GetGlobalScope());
+	}
+	int index = module - modules;
+
+	Scope* outerScope = GetModuleScope();
+	int outerModule = loadingModule;
+	moduleScope = module->scope;
+	loadingModule = index;
+	modules[index].loading = 1;
+
+	ProcessFile(filename, included);
+
+	modules[index].loading = 0;
+	moduleScope = outerScope;
+	loadingModule = outerModule;
+}
+
+/* Process a file given on the command line */
+void RunFile(char* filename){
+	LoadModule(filename, 0, 0);
+}
+
+/* Include a file, unless it is already loaded */
+VyObject IncludeFile(VyFunction** f, VyObject* args, int numArgs){
+	VySymbol** symb = ObjData(args[0]);
+	LoadModule(GetSymbolString(symb), 1, 0);
+	return ToObject(MakeTrueBool());
+}
+
+/* Include a file again, even if it is already loaded */
+VyObject ReloadFile(VyFunction** f, VyObject* args, int numArgs){
+	VySymbol** symb = ObjData(args[0]);
+	LoadModule(GetSymbolString(symb), 1, 1);
+	return ToObject(MakeTrueBool());
+}
+
+/* Get the scope top-level variables are set in */
+Scope* GetModuleScope(){
+	return (moduleScope != NULL) ? moduleScope : GetGlobalScope();
+}
+
+/* Get the scope variables are bound in where the code is: the local frame, or at the top level, the module scope */
+Scope* GetBindingScope(){
+	return (GetLocalScope() == GetGlobalScope()) ? GetModuleScope() : GetLocalScope();
+}
+
+/* Find the module scope a variable is bound in (the global scope has already been searched) */
+Scope* FindModuleScope(char* name){
+	int i;
+	for(i = 0; i < numModules; i++){
+		Scope* scope = modules[i].scope;
+		if(scope != GetGlobalScope() && FindValue(scope, name) >= 0){
+			return scope;
+		}
+	}
+	return NULL;
+}
+
+/* Get the modules, or register one for a heap image */
+Module* GetModules(int* num){
+	*num = numModules;
+	return modules;
+}
+void AddLoadedModule(char* path, Scope* scope){
+	AddModule(strdup(path), scope);
+}
+
+/* Get the module being loaded */
+int GetLoadingModule(){
+	return loadingModule;
+}
+
+/* Find the name of the module of a tree */
+char* TreeModuleName(VyParseTree* tree){
+	int module = GetTreeModule(tree);
+	return (module > 0 && module <= numModules) ? modules[module - 1].name : NULL;
+}
+
+/* Find the namespace of the module of a tree */
+Scope* TreeModuleScope(VyParseTree* tree){
+	int module = GetTreeModule(tree);
+	if(module > 0 && module <= numModules && modules[module - 1].scope != GetGlobalScope()){
+		return modules[module - 1].scope;
+	}
+	return NULL;
+}
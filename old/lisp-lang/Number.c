@@ -1,7 +1,7 @@
 #include "Vyion.h"
 
 /* Return the last caused parsing error */
-char* parsingError = NULL;
+__thread char* parsingError = NULL;
 char* GetLastNumberParsingError(){
 	return parsingError;	
 }
@@ -17,6 +17,8 @@ int NumberSize(int type){
 			return sizeof(IntNum);
 		case RATIO:
 			return sizeof(RatioNum);
+		case BIGINT:
+			return sizeof(BigIntNum);
 		default:
 			return 0;
 	}
@@ -84,8 +86,50 @@ VyNumber** CreateComplex(VyNumber** real, VyNumber** imaginary){
 	return cmplex;
 }
 
-/* Create a ratio from two ints */
-VyNumber** CreateRatio(int numerator, int denominator){
+/* Create an integer: a fixnum if the value fits, and a bignum if it doesn't */
+VyNumber** CreateInteger(long long value){
+	if(value >= INT_MIN && value <= INT_MAX){
+		return CreateInt((int) value);
+	}
+
+	VyNumber** num = CreateNumber(BIGINT);
+	BigFromLong(NumberToSubtype(num), value);
+	return num;
+}
+
+/* Create an integer from a bignum, demoting it to a fixnum if possible. The number takes ownership of the limbs. */
+VyNumber** CreateIntegerFromBig(BigIntNum* big){
+	if(BigFitsInt(big)){
+		int value = (int) BigToLong(big);
+		BigFree(big);
+		return CreateInt(value);
+	}
+
+	VyNumber** num = CreateNumber(BIGINT);
+	*((BigIntNum*) NumberToSubtype(num)) = *big;
+	return num;
+}
+
+/* Create a ratio from two integers. The ratio is reduced to lowest terms with a positive denominator,
+ * and if the denominator becomes one, then the result is just an integer. The denominator must not be zero. */
+VyNumber** CreateRatio(VyNumber** numerator, VyNumber** denominator){
+	/* Move the sign into the numerator */
+	if(IntegerSign(denominator) < 0){
+		numerator = IntegerNegate(numerator);
+		denominator = IntegerNegate(denominator);
+	}
+
+	/* Reduce to lowest terms */
+	VyNumber** divisor = IntegerGcd(numerator, denominator);
+	if(!(divisor[0]->type == INT && GetInt(divisor) == 1)){
+		numerator = IntegerQuotient(numerator, divisor);
+		denominator = IntegerQuotient(denominator, divisor);
+	}
+
+	if(denominator[0]->type == INT && GetInt(denominator) == 1){
+		return numerator;
+	}
+
 	VyNumber** ratio = CreateNumber(RATIO);
 
 	RatioNum* rNum = NumberToSubtype(ratio);
@@ -96,11 +140,97 @@ VyNumber** CreateRatio(int numerator, int denominator){
 	return ratio;
 }
 
+/* Create a ratio from two machine integers, which avoids creating any intermediate numbers */
+VyNumber** CreateRatioFromLongs(long long numerator, long long denominator){
+	/* The parts of a fixnum ratio never reach the edges of the long long range, so negation is safe */
+	if(denominator < 0){
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	long long divisor = BinaryGcd(numerator < 0 ? -numerator : numerator, denominator);
+	if(divisor > 1){
+		numerator /= divisor;
+		denominator /= divisor;
+	}
+
+	if(denominator == 1){
+		return CreateInteger(numerator);
+	}
+
+	VyNumber** num = CreateInteger(numerator);
+	VyNumber** den = CreateInteger(denominator);
+
+	VyNumber** ratio = CreateNumber(RATIO);
+
+	RatioNum* rNum = NumberToSubtype(ratio);
+
+	rNum->numerator = num;
+	rNum->denominator = den;
+
+	return ratio;
+}
+
 /* Convert a ratio to a double number */
 VyNumber** RatioToReal(VyNumber** ratio){
-	RatioNum* rNum = NumberToSubtype(ratio);
-	double real = ((double)(rNum->numerator))/rNum->denominator;
-	return CreateReal(real);
+	return CreateReal(NumberToDouble(ratio));
+}
+
+/* Write the shortest decimal representation of a double that reads back as exactly the same double. This leans
+ * on printf() and strtod() rather than a dedicated algorithm like Ryu (which needs large tables of 128-bit
+ * multipliers). %g drops trailing zeros, and a normal double with a representation of at most 15 significant
+ * digits is within half an ulp of it, so %.15g gives that representation exactly; otherwise, 16 or 17 digits are
+ * the shortest that round-trip (every double does with 17). So most reals, like those written as literals, cost
+ * one snprintf() and one strtod(), and the others two or three. Subnormals have fewer digits of precision, so
+ * their shortest precision is found by binary search (if some precision round-trips then so does every higher
+ * one). Integral values get a trailing ".0" so that they still look like reals. The buffer must hold at least 32
+ * chars. */
+void FormatReal(double d, char* buffer){
+	if(isnormal(d) || d == 0){
+		int precision;
+		for(precision = 15; precision < 17; precision++){
+			if(snprintf(buffer, 32, "%.*g", precision, d) < 32 && strtod(buffer, NULL) == d){
+				break;
+			}
+		}
+		if(precision == 17 && snprintf(buffer, 32, "%.17g", d) >= 32){
+			return;
+		}
+	}
+	else{
+		int low = 1;
+		int high = 17;
+		while(low < high){
+			int precision = (low + high) / 2;
+			if(snprintf(buffer, 32, "%.*g", precision, d) < 32 && strtod(buffer, NULL) == d){
+				high = precision;
+			}
+			else{
+				low = precision + 1;
+			}
+		}
+		if(snprintf(buffer, 32, "%.*g", low, d) >= 32){
+			return;
+		}
+	}
+
+	/* %g only switches to an exponent once the digits before the point outnumber the precision, so a value whose
+	 * shortest form ends in zeros before the point (like 20090, which is 2.009e+04) is printed again with its real
+	 * number of digits, as it would be with the shortest precision */
+	int length = strlen(buffer);
+	if(isfinite(d) && strpbrk(buffer, ".e") == NULL && buffer[length - 1] == '0'){
+		int digits = length - (buffer[0] == '-');
+		while(digits > 1 && buffer[length - 1] == '0'){
+			length--;
+			digits--;
+		}
+		snprintf(buffer, 32, "%.*g", digits, d);
+	}
+
+	/* Infinities and NaNs are left alone */
+	if(isfinite(d) && strpbrk(buffer, ".e") == NULL){
+		strcat(buffer, ".0");
+	}
 }
 
 /* Print a number */
@@ -111,138 +241,104 @@ void PrintNumber(VyNumber** num){
 		printf("%d",iNum->i);  
 	}else if(num[0]->type == REAL){
 		RealNum* rNum = NumberToSubtype(num);
-		printf("%f", rNum->d);	
+		char buffer[32];
+		FormatReal(rNum->d, buffer);
+		printf("%s", buffer);	
 	}else if(num[0]->type == COMPLEX){
 		ComplexNum* cNum = NumberToSubtype(num);
 		PrintNumber(cNum->real);
 		printf("+");
 		PrintNumber(cNum->imaginary);
 		printf("i");
+	}else if(num[0]->type == RATIO){
+		RatioNum* rNum = NumberToSubtype(num);
+		PrintNumber(rNum->numerator);
+		printf("/");
+		PrintNumber(rNum->denominator);
+	}else if(num[0]->type == BIGINT){
+		char* digits = BigToString(NumberToSubtype(num));
+		printf("%s", digits);
+		free(digits);
 	}
 }
 
-/* Convert a string to a double */
-double StringToDouble(char* str){
-	double result = 0;
-
-	int index = 0;
-	char next = str[index];
-
-	/* Find the integer part */
-	while(next != '.' && next != '\0'){
-		/* Find the int value of the digit */
-		int digit = next - '0';
-
-		/* Update result */
-		result = result*10 + digit;
-
-		/* Next character */
-		index++;
-		next = str[index];
-	}
-
-	/* Find the decimal part if it exists */
-	if(next == '.'){
-		/* Skip the decimal point */
-		index++;
-		next = str[index];
-
-		double scale = 0.1;
-		while(next != '\0'){
-			/* Add the value to the result */
-			int digit = next - '0';
-			result = result + digit * scale;
-			scale *= 0.1;
-
-			/* Next character */
-			index++;
-			next = str[index];
+/* Powers of ten which are exactly representable as doubles */
+static const double exactPowersOfTen[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* The most digits that always fit in an unsigned long long mantissa */
+#define MAX_MANTISSA_DIGITS 19
+
+/* The longest literal strtod() is given a copy of on the stack (longer ones are copied onto the heap) */
+#define SHORT_LITERAL_LENGTH 64
+
+/* Convert a decimal mantissa and power of ten to the nearest double. When both the mantissa and the power of ten
+ * are exact doubles, a single multiplication or division is correctly rounded (Clinger's fast path), which covers
+ * nearly every literal in real source files. Anything else goes to strtod(), which is always correctly rounded;
+ * only then is the text of the literal (which isn't null terminated) copied. */
+static double DecimalToDouble(unsigned long long mantissa, int digits, int exponent, char* str, int length){
+	if(digits <= MAX_MANTISSA_DIGITS && mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22){
+		double d = (double) mantissa;
+		if(exponent < 0){
+			return d / exactPowersOfTen[-exponent];
 		}
+		return d * exactPowersOfTen[exponent];
 	}
 
-	return result;
-}
-
-/* Given all the data about a number that is contained in the string, create a number from it */
-VyNumber** ParseNumberFromData(CharList* beforeRadix, CharList* afterRadix, CharList* exponential, int isNegated, int isImaginary){
-
-	/* Determine the type based on the arguments and parse the number appropriately */
-	VyNumber** num = NULL;
-
-	/* Convert the CharList*s to strings so that we can deal with them */
-	char* exponentialStr = ToStr(exponential);
-	char* beforeRadixStr = ToStr(beforeRadix);
-	char* afterRadixStr = ToStr(afterRadix);
-
-	/* Concatenate the strings to form a double */
-	char* dotted = ConcatStrings(beforeRadixStr, ".");
-	char* doubleStr = ConcatStrings(dotted,afterRadixStr);
-	free(dotted);
-
-	/* Imaginary? */
-	if(isImaginary){
-		/* Create a complex number with default real value of 0 */
-		num = CreateNumber(COMPLEX);
-		ComplexNum* cNum = NumberToSubtype(num);
-		cNum->real = CreateInt(0);
-		cNum->imaginary = ParseNumberFromData(beforeRadix, afterRadix, exponential, 0, 0);
-	}
-
-	/* Integer? */
-	else if(Size(afterRadix) <= atoi(exponentialStr)){
-		/* Integer IF there is no decimal part OR the 10 exponent turns the decimal into an integer */
-		double d = StringToDouble(doubleStr);
-		int i = (int)(d*pow(10, atoi(exponentialStr)));
-
-		/* Make negative if needed */
-		if(isNegated){
-			i = -i; 
-		}
+	char buffer[SHORT_LITERAL_LENGTH + 1];
+	char* terminated = (length <= SHORT_LITERAL_LENGTH) ? buffer : malloc(length + 1);
+	memcpy(terminated, str, length);
+	terminated[length] = '\0';
 
-		num = CreateNumber(INT);
-		IntNum* iNum = NumberToSubtype(num);
-		iNum->i = i;
+	double d = strtod(terminated, NULL);
+	if(terminated != buffer){
+		free(terminated);
 	}
+	return d;
+}
 
-	/* Else, double */
-	else {
-		double d =  StringToDouble(doubleStr);
-		d = d*pow(10,atoi(exponentialStr));
+/* Create an integer from the digits of a literal, followed by the given number of zeros */
+static VyNumber** DigitsToInteger(char* str, int length, int zeros){
+	char* digits = malloc(length + zeros + 1);
 
-		/* Make negative if needed */
-		if(isNegated){
-			d = -d; 
+	/* Copy over only the digits, skipping the radix and exponent */
+	int count = 0;
+	int index;
+	for(index = 0; index < length && str[index] != 'e'; index++){
+		if(isNumeric(str[index])){
+			digits[count++] = str[index];
 		}
-
-		num = CreateNumber(REAL);
-		RealNum* rNum = NumberToSubtype(num);
-		rNum->d = d;
 	}
+	memset(digits + count, '0', zeros);
+	count += zeros;
 
-	/* Free the used strings */
-	free(exponentialStr);
-	free(beforeRadixStr);
-	free(afterRadixStr);
-	free(doubleStr);
+	BigIntNum big;
+	BigFromDigits(&big, digits, count);
+	free(digits);
 
-	return num;
+	return CreateIntegerFromBig(&big);
 }
 
-/* Given a string, find all the data needed to create a number from it an create a number */
-VyNumber** ParseNumber(char* numStr){
+/* Read a character of the literal, treating the end of it like a string terminator */
+#define CHAR_AT(i) ((i) < length ? numStr[i] : '\0')
+
+/* Given the text of a number (which needn't be null terminated), find all the data needed to create a number from it an create a number */
+VyNumber** ParseNumber(char* numStr, int length){
 	/* Set the parsing error to NULL to reset it */
 	parsingError = NULL;
 
-	/* Declare variables to store data about the number */
+	/* The digits are accumulated into a mantissa as they are scanned; digits past the first 19 only
+	 * count towards the total so that the slow paths know they must look at the string again */
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int fractionDigits = 0;
 	int hasRadix = 0;
 
-	/* The radix denotes where the integer part ends */
-	CharList* beforeRadix = MakeCharList();
-	CharList* afterRadix = MakeCharList();
-
 	/* For exponential form */
-	int isExponentialForm = 0;
-	CharList* exponent = MakeCharList();
+	int exponent = 0;
+	int exponentSign = 1;
 
 	/* Imaginary? */
 	int imaginary = 0;
@@ -252,104 +348,131 @@ VyNumber** ParseNumber(char* numStr){
 
 	/* Declare variables needed for iteration over the characters */
 	int index = 0;
-	char next = numStr[index];
-
-	/* If it is negated, parse the rest and negate */
-	if(numStr[0] == '-'){
-		isNegated = 1;
-		index++;
-		next = numStr[index];
-	}
 
-	/* Also allow a + instead of a -, although it does nothing */
-	else if(numStr[0] == '+'){
+	/* If it is negated, parse the rest and negate (a + is also allowed, although it does nothing) */
+	if(CHAR_AT(0) == '-' || CHAR_AT(0) == '+'){
+		isNegated = (CHAR_AT(0) == '-');
 		index++;
-		next = numStr[index];
 	}
+	int start = index;
 
-
-	/* For each character in the string */
-	while(next != '\0'){
-		/* If it finds a radix */
+	/* Scan the integer and decimal parts */
+	char next = CHAR_AT(index);
+	while(next != '\0' && next != 'e' && next != 'i'){
 		if(next == '.'){
 			hasRadix = 1;
-
-			/* If it is already in exponential form, a radix is an error, because exponential 
-			 * form only takes ints for the exponent, so there cannot be a radix */
-			if(isExponentialForm){
-				parsingError = "Badly formatted number: scientific notation exponent must be integer.";
-				return NULL;
+		}
+		else if(!isNumeric(next)){
+			parsingError = "Badly formatted number: non-numeric characters in number.";
+			return NULL;
+		}
+		else{
+			/* Leading zeros don't count as digits */
+			if(digits > 0 || next != '0'){
+				if(digits < MAX_MANTISSA_DIGITS){
+					mantissa = mantissa * 10 + (next - '0');
+				}
+				digits++;
+			}
+			if(hasRadix){
+				fractionDigits++;
 			}
 		}
 
-		/* Scientific notation */
-		else if(next == 'e'){
-			isExponentialForm = 1;
-
-			/* If the next is + or -, allow them */
-			if(numStr[index + 1] == '+' || numStr[index + 1] == '-'){
-				Add(exponent, numStr[index + 1]);
+		index++;
+		next = CHAR_AT(index);
+	}
 
-				/* Continue on to the next character */
-				index++;
-				next = numStr[index];
-			}
+	/* Scientific notation */
+	if(next == 'e'){
+		index++;
 
-			/* 'e' cannot be the last character */
-			else if(numStr[index + 1] == '\0'){
-				parsingError = "Badly formatted number: Expecting exponent after 'e' (scientific notation)";
-				return NULL;
-			}
+		/* If the next is + or -, allow them */
+		if(CHAR_AT(index) == '+' || CHAR_AT(index) == '-'){
+			exponentSign = (CHAR_AT(index) == '-') ? -1 : 1;
+			index++;
 		}
 
-		/* If it is an imaginary number */
-		else if(next == 'i'){
-			imaginary = 1;
+		/* 'e' cannot be the last character */
+		if(CHAR_AT(index) == '\0'){
+			parsingError = "Badly formatted number: Expecting exponent after 'e' (scientific notation)";
+			return NULL;
+		}
 
-			/* If the 'i' isn't last, error */
-			if(numStr[index + 1] != '\0'){
-				parsingError = "Badly formatted number: 'i', indicating imaginary numbers, must come last in a number.";
+		next = CHAR_AT(index);
+		while(next != '\0' && next != 'i'){
+			/* Exponential form only takes ints for the exponent, so there cannot be a radix */
+			if(next == '.'){
+				parsingError = "Badly formatted number: scientific notation exponent must be integer.";
+				return NULL;
+			}
+			if(!isNumeric(next)){
+				parsingError = "Badly formatted number: non-numeric characters in number.";
 				return NULL;
 			}
+
+			/* Clamp huge exponents; they overflow to infinity or zero anyway */
+			if(exponent < 100000){
+				exponent = exponent * 10 + (next - '0');
+			}
+
+			index++;
+			next = CHAR_AT(index);
 		}
+		exponent *= exponentSign;
+	}
 
-		/* No other non-numeric characters are allowed */
-		else if(!isNumeric(next)){
-			parsingError = "Badly formatted number: non-numeric characters in number.";
+	/* If it is an imaginary number */
+	if(next == 'i'){
+		imaginary = 1;
+
+		/* If the 'i' isn't last, error */
+		if(CHAR_AT(index + 1) != '\0'){
+			parsingError = "Badly formatted number: 'i', indicating imaginary numbers, must come last in a number.";
 			return NULL;
 		}
+	}
 
-		/* If it is just a number, add it to the correct char list */
-		else{
-			if(!isExponentialForm){
-				if(!hasRadix){
-					Add(beforeRadix, next);
-				}
-				else{
-					Add(afterRadix, next);
-				}
+	VyNumber** num;
+
+	/* Integer IF there is no decimal part OR the 10 exponent turns the decimal into an integer */
+	if(fractionDigits <= exponent){
+		int zeros = exponent - fractionDigits;
+
+		/* The value is mantissa * 10^zeros, which fits in a long long as long as it has at most 18 digits */
+		if(digits + zeros <= 18){
+			long long value = mantissa;
+			while(zeros-- > 0){
+				value *= 10;
 			}
-			else{
-				Add(exponent, next);
+			num = CreateInteger(isNegated ? -value : value);
+		}
+		else{
+			num = DigitsToInteger(numStr + start, index - start, zeros);
+			if(isNegated){
+				num = IntegerNegate(num);
 			}
 		}
-
-		/* Next character */
-		index++;
-		next = numStr[index];
 	}
 
-	/* Call a function to use the data gained to create a number */
-	VyNumber** number = ParseNumberFromData(beforeRadix, afterRadix, exponent, isNegated, imaginary);
-
-	/* Free the character lists */
-	Delete(beforeRadix);
-	Delete(afterRadix);
-	Delete(exponent);
+	/* Else, double */
+	else {
+		/* Digits dropped from the mantissa shift its scale */
+		int scale = exponent - fractionDigits;
+		if(digits > MAX_MANTISSA_DIGITS){
+			scale += digits - MAX_MANTISSA_DIGITS;
+		}
 
-	/* Return the result */
-	return number;
+		/* (The literal given to strtod() leaves out the sign and the 'i') */
+		double d = DecimalToDouble(mantissa, digits, scale, numStr + start, index - start);
+		num = CreateReal(isNegated ? -d : d);
+	}
 
+	/* Imaginary numbers have a real part of 0 */
+	if(imaginary){
+		return CreateImaginary(num);
+	}
 
+	return num;
 }
 
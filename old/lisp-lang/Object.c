@@ -26,7 +26,7 @@
 /***** Create objects *****/
 
 /* The heap on which all these objects are stored */
-VyMemHeap* heap = NULL;
+__thread VyMemHeap* heap = NULL;
 
 void SetMemoryHeap(VyMemHeap* memHeap){
 	heap = memHeap;	
@@ -54,6 +54,8 @@ int DataSize(int type){
 VyObject CreateObj(int type){
 	/* Mallocate room */
 	void* mem = VyMallocate(DataSize(type) + sizeof(int), heap);
+	heap->objectsAllocated++;
+	NoteAllocation(type);
 
 	/* The object Id is just the number of the object on the heap */
 	int objId = heap->objectsOnHeap;
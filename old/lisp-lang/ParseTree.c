@@ -1,282 +1,413 @@
 #include "Vyion.h"
 
-/* Create a general empty parse tree of a certain type */
-VyParseTree* MakeParseTree(int type){
-	VyParseTree* tree = malloc(sizeof(VyParseTree));
-	tree->type = type;
-	tree->data = malloc(sizeof(tree_node_data));
-	tree->pos = NULL;
-	return tree;
+/* Positions are packed into one int: the line in the high bits and the character in the low bits */
+#define POSITION_CHAR_BITS 12
+#define POSITION_MAX_CHAR ((1 << POSITION_CHAR_BITS) - 1)
+#define NO_POSITION 0xFFFFFFFFu
+
+/* The initial sizes of the builder's arrays */
+#define INIT_BUILDER_NODES 64
+#define INIT_BUILDER_POOL 256
+
+/* A finished tree is a single block: a header, then the nodes (the root first), then the string pool */
+typedef struct {
+	int numNodes;
+	int poolSize;
+	VyParseTree nodes[];
+} TreeBlock;
+
+/* Create an empty tree builder */
+TreeBuilder* CreateTreeBuilder(){
+	TreeBuilder* builder = malloc(sizeof(TreeBuilder));
+	builder->nodeCapacity = builder->pendingCapacity = INIT_BUILDER_NODES;
+	builder->nodes = malloc(sizeof(VyParseTree) * builder->nodeCapacity);
+	builder->pending = malloc(sizeof(VyParseTree) * builder->pendingCapacity);
+	builder->poolCapacity = INIT_BUILDER_POOL;
+	builder->pool = malloc(builder->poolCapacity);
+	builder->numNodes = builder->numPending = builder->poolSize = 0;
+	return builder;
 }
 
-/* Create a list */
-VyParseTree* MakeListTree(){
-	VyParseTree* list = MakeParseTree(TREE_LIST);
-	list->data->list.length = 0;
-	list->data->list.list = NULL;
-	return list;
+/* Delete a tree builder */
+void DeleteTreeBuilder(TreeBuilder* builder){
+	free(builder->nodes);
+	free(builder->pending);
+	free(builder->pool);
+	free(builder);
 }
 
-/* Create a number */
-VyParseTree* MakeNum(){
-	VyParseTree* num = MakeParseTree(TREE_NUM);
-	return num;
+/* Add a node to the pending stack and return it */
+VyParseTree* PushPending(TreeBuilder* builder, int type){
+	if(builder->numPending >= builder->pendingCapacity){
+		builder->pendingCapacity *= 2;
+		builder->pending = realloc(builder->pending, sizeof(VyParseTree) * builder->pendingCapacity);
+	}
+
+	VyParseTree* node = &builder->pending[builder->numPending++];
+	node->type = type;
+	node->form = FORM_UNKNOWN;
+	node->module = 0;
+	node->pos = NO_POSITION;
+	node->cache = NULL;
+	return node;
 }
 
-/* Create a string */
-VyParseTree* MakeString(){
-	VyParseTree* str = MakeParseTree(TREE_STR);
-	return str;
+/* Copy a string into the pool and return its offset */
+int AddToPool(TreeBuilder* builder, char* str, int length){
+	while(builder->poolSize + length + 1 > builder->poolCapacity){
+		builder->poolCapacity *= 2;
+		builder->pool = realloc(builder->pool, builder->poolCapacity);
+	}
+
+	int offset = builder->poolSize;
+	memcpy(builder->pool + offset, str, length);
+	builder->pool[offset + length] = '\0';
+	builder->poolSize += length + 1;
+	return offset;
 }
 
-/* Create an ident */
-VyParseTree* MakeIdent(){
-	VyParseTree* ident = MakeParseTree(TREE_IDENT);
-	return ident;
+/* Push identifiers and strings, whose text is copied into the pool */
+void PushText(TreeBuilder* builder, int type, char* str, int length){
+	int offset = AddToPool(builder, str, length);
+	VyParseTree* node = PushPending(builder, type);
+	node->data.str.offset = offset;
+	node->data.str.length = length;
+}
+void PushIdent(TreeBuilder* builder, char* str, int length){
+	PushText(builder, TREE_IDENT, str, length);
+}
+void PushString(TreeBuilder* builder, char* str, int length){
+	PushText(builder, TREE_STR, str, length);
 }
 
-/* Put something in a quote */
-VyParseTree* Quote(VyParseTree* elem){
-	/* The resulting list, (quote ...) */
-	VyParseTree* qList = MakeListTree();
+/* Push a number */
+void PushNumber(TreeBuilder* builder, VyNumber** num){
+	PushPending(builder, TREE_NUM)->data.num = num;
+}
 
-	/* The quote ident */
-	VyParseTree* qIdent = MakeIdent();
-	SetStrData(qIdent, "quote");
+/* Push an error node */
+void PushError(TreeBuilder* builder, char* message){
+	PushPending(builder, TREE_ERROR)->data.message = message;
+}
 
-	/* Add to the list */
-	AddToList(qList, qIdent);
-	AddToList(qList, elem);
-	
-	return qList;
+/* Start a list, whose elements are everything pushed from now on */
+int BeginList(TreeBuilder* builder){
+	return builder->numPending;
 }
 
-/* Find out if a list is a quote list */
-int IsQuote(VyParseTree* qt){
-	/* It must be a list with two elements to be a quote */
-	if(qt->type == TREE_LIST){
-		if(ListTreeSize(qt) == 2){
-			/* And the first element must be the quote ident */
-			if(GetListData(qt,0)->type == TREE_IDENT && strcmp(GetStrData(GetListData(qt, 0)), "quote") == 0){
-				return 1;	
-			}
-		}
+/* Move the pending nodes from the mark onwards into the tree as one run, and replace them with a node pointing to them */
+void EndGroup(TreeBuilder* builder, int mark, int type){
+	int length = builder->numPending - mark;
+	while(builder->numNodes + length > builder->nodeCapacity){
+		builder->nodeCapacity *= 2;
+		builder->nodes = realloc(builder->nodes, sizeof(VyParseTree) * builder->nodeCapacity);
 	}
 
-	/* Assume false otherwise */
-	return 0;
+	int first = builder->numNodes;
+	memcpy(builder->nodes + first, builder->pending + mark, sizeof(VyParseTree) * length);
+	builder->numNodes += length;
+	builder->numPending = mark;
+
+	VyParseTree* node = PushPending(builder, type);
+	node->data.list.first = first;
+	node->data.list.length = length;
 }
 
-/* Put something in a substitution */
-VyParseTree* Substitution(VyParseTree* elem, int splice){
-	/* The resulting list, (quote ...) */
-	VyParseTree* sList = MakeListTree();
+/* Close a list */
+void EndList(TreeBuilder* builder, int mark){
+	EndGroup(builder, mark, TREE_LIST);
+}
 
-	/* The quote ident */
-	VyParseTree* sIdent = MakeIdent();
-	if(splice){
-		SetStrData(sIdent, "splicing-substitution");
-	}else{
-		SetStrData(sIdent, "substitution");
+/* A reference starts with the last node pushed, which becomes its obj part */
+int BeginReference(TreeBuilder* builder){
+	return builder->numPending - 1;
+}
+void EndReference(TreeBuilder* builder, int mark){
+	EndGroup(builder, mark, TREE_REF);
+}
+
+/* Pack a position into an int */
+unsigned int PackPosition(Position* pos){
+	int character = pos->character;
+	if(character > POSITION_MAX_CHAR){
+		character = POSITION_MAX_CHAR;
 	}
+	return ((unsigned int) pos->line << POSITION_CHAR_BITS) | character;
+}
 
-	/* Add to the list */
-	AddToList(sList, sIdent);
-	AddToList(sList, elem);
-	
-	return sList;
+/* Set the position of the last node pushed (if it doesn't have one yet) */
+void SetPendingPosition(TreeBuilder* builder, Position* pos){
+	VyParseTree* node = &builder->pending[builder->numPending - 1];
+	if(node->pos == NO_POSITION){
+		node->pos = PackPosition(pos);
+	}
 }
 
-/* Find out if a list is a substitution list */
-int IsSubstitution(VyParseTree* qt){
-	/* Same rules apply as for IsQuote, except the ident is different */
-	if(qt->type == TREE_LIST){
-		if(ListTreeSize(qt) == 2){
-			if(GetListData(qt,0)->type == TREE_IDENT){
-				char* str = GetStrData(GetListData(qt, 0));
-				if(strcmp(str, "substitution") == 0 || strcmp(str, "splicing-substitution") == 0){
-					return 1;		
-				}
-				
-			}
+/* Pack the single pending node and everything under it into one block */
+VyParseTree* FinishTree(TreeBuilder* builder){
+	if(builder->numPending != 1){
+		fprintf(stderr, "Parse tree builder finished with %d nodes pending.\n", builder->numPending);
+		ExitInterpreter();
+	}
+
+	int numNodes = builder->numNodes + 1;
+	TreeBlock* block = malloc(sizeof(TreeBlock) + sizeof(VyParseTree) * numNodes + builder->poolSize);
+	block->numNodes = numNodes;
+	block->poolSize = builder->poolSize;
+
+	/* The root goes first, followed by the rest of the nodes, so a node's build index is one less than its final one */
+	VyParseTree* nodes = block->nodes;
+	nodes[0] = builder->pending[0];
+	memcpy(nodes + 1, builder->nodes, sizeof(VyParseTree) * builder->numNodes);
+
+	char* pool = (char*)(nodes + numNodes);
+	memcpy(pool, builder->pool, builder->poolSize);
+
+	/* Make the indices relative to the nodes holding them */
+	int i;
+	for(i = 0; i < numNodes; i++){
+		VyParseTree* node = &nodes[i];
+		if(node->type == TREE_LIST || node->type == TREE_REF){
+			node->data.list.first += 1 - i;
+		}
+		else if(node->type == TREE_IDENT || node->type == TREE_STR){
+			node->data.str.offset = (int)((pool + node->data.str.offset) - (char*) node);
 		}
 	}
 
-	/* Assume false otherwise */
-	return 0;
+	builder->numNodes = builder->numPending = builder->poolSize = 0;
+	return nodes;
 }
 
-/* Find whether it is a splicing substitution */
-int IsSplicingSubstitution(VyParseTree* subst){
-	if(IsSubstitution(subst) 
-			&& strcmp(GetStrData(GetListData(subst, 0)), "splicing-substitution") == 0){
-		return 1;	
+/* Whether a list has two elements and starts with one of the given identifiers */
+int IsKeywordPair(VyParseTree* tree, char* keyword, char* alternative){
+	if(tree->type == TREE_LIST && ListTreeSize(tree) == 2){
+		VyParseTree* first = GetListData(tree, 0);
+		if(first->type == TREE_IDENT){
+			char* str = GetStrData(first);
+			return strcmp(str, keyword) == 0 || (alternative != NULL && strcmp(str, alternative) == 0);
+		}
 	}
 	return 0;
 }
 
-/* Create a reference */
-VyParseTree* Reference(VyParseTree* obj, VyParseTree* ref){
-	VyParseTree* tree = MakeParseTree(TREE_REF);
-	tree->type = TREE_REF;
-	tree->data->ref.obj = obj;
-	tree->data->ref.ref= ref;
-	return tree;
+/* Find out if a list is a quote list */
+int IsQuote(VyParseTree* qt){
+	return IsKeywordPair(qt, "quote", NULL);
+}
+
+/* Find out if a list is a substitution list */
+int IsSubstitution(VyParseTree* qt){
+	return IsKeywordPair(qt, "substitution", "splicing-substitution");
 }
 
-/* Make an error node */
-VyParseTree* ParseError(char* message){
-	VyParseTree* error = MakeParseTree(TREE_ERROR);
-	error->data->error.message = message;
-	return error;
+/* Find whether it is a splicing substitution */
+int IsSplicingSubstitution(VyParseTree* subst){
+	return IsKeywordPair(subst, "splicing-substitution", NULL);
 }
 
 /* Find the obj or ref parts of the reference */
-inline VyParseTree* GetObj(VyParseTree* ref){
-	return ref->data->ref.obj;
+VyParseTree* GetObj(VyParseTree* ref){
+	return ref + ref->data.list.first;
 }
-inline VyParseTree* GetRef(VyParseTree* ref){
-	return ref->data->ref.ref;
+VyParseTree* GetRef(VyParseTree* ref){
+	return ref + ref->data.list.first + 1;
 }
 
-/* Find the size of a list tree */
-inline int ListTreeSize(VyParseTree* tree){
-	return tree->data->list.length;
+/* Get the message of an error */
+char* GetErrorMessage(VyParseTree* tree){
+	return tree->data.message;
 }
 
-/* Add to a list and return it's size */
-int AddToList(VyParseTree* tree, VyParseTree* item){
-	/* If it isn't a list, return 0 */
-	if(tree->type != TREE_LIST){
-		return 0;
-	}
-
-	/* Allocate more memory and add the item */
-	tree->data->list.list = realloc(tree->data->list.list, sizeof(VyParseTree*)*(ListTreeSize(tree)+ 1));
-	tree->data->list.list[ListTreeSize(tree)] = item;
-
-	/* Increment the list's size */
-	tree->data->list.length++;
-
-	return 1;
+/* Find the size of a list tree */
+int ListTreeSize(VyParseTree* tree){
+	return tree->data.list.length;
 }
 
-
 /* Get data from a list */
 VyParseTree* GetListData(VyParseTree* tree, int index){
-	return tree->data->list.list[index];
+	return tree + tree->data.list.first + index;
 }
 
 /* Get the first element of a list */
 VyParseTree* ListTreeHead(VyParseTree* list){
 	/* Validate that it is a list and has at least one element */
-	if(list->type != TREE_LIST && ListTreeSize(list) > 0){
-		return NULL;	
+	if(list->type != TREE_LIST || ListTreeSize(list) == 0){
+		return NULL;
 	}
 	else{
 		return GetListData(list, 0);
 	}
 }
 
+/* Fetch string data for ident and string nodes */
+char* GetStrData(VyParseTree* tree){
+	if(tree->type == TREE_IDENT || tree->type == TREE_STR){
+		return (char*) tree + tree->data.str.offset;
+	}
+	return NULL;
+}
+
+/* Get number data */
+VyNumber** GetNumberData(VyParseTree* tree){
+	if(tree->type == TREE_NUM){
+		return tree->data.num;
+	}else{
+		return NULL;
+	}
+}
 
-/* Set or fetch string data for ident nodes  */
-int SetStrData(VyParseTree* tree, char* str){
-	/* Make sure it has an appropriate type */
-	switch(tree->type){
-		case TREE_IDENT:
-			tree->data->ident.str = strdup(str);
-			return 1;
-		case TREE_STR:
-			tree->data->str.str = strdup(str);
-			return 1;
-		default:
-			return 0;
+/* Free the cached data of a node (the cache of an infix form is the tree it was rewritten to) */
+void FreeTreeCache(VyParseTree* tree){
+	if(tree->form == FORM_INFIX){
+		DeleteParseTree(tree->cache);
+	}else{
+		free(tree->cache);
 	}
+}
 
+/* Get or replace the cached data */
+void* GetTreeCache(VyParseTree* tree){
+	return tree->cache;
+}
+void SetTreeCache(VyParseTree* tree, void* cache){
+	FreeTreeCache(tree);
+	tree->cache = cache;
+}
 
+/* Get or set the form */
+int GetTreeForm(VyParseTree* tree){
+	return tree->form;
 }
-char* GetStrData(VyParseTree* tree){
-	/* Make sure it has an appropriate type */
-	switch(tree->type){
-		case TREE_IDENT:
-			return tree->data->ident.str;
-		case TREE_STR:
-			return tree->data->str.str;
-		default:
-			return NULL;
+void SetTreeForm(VyParseTree* tree, int form){
+	tree->form = form;
+}
+
+/* Unpack the position (the indent isn't kept in trees) */
+int GetTreePosition(VyParseTree* tree, Position* pos){
+	if(tree->pos == NO_POSITION){
+		return 0;
 	}
 
+	pos->line = tree->pos >> POSITION_CHAR_BITS;
+	pos->character = tree->pos & POSITION_MAX_CHAR;
+	pos->indent = 0;
+	return 1;
+}
+
+/* Whether the top-level tree being evaluated is referred to by something which outlives its evaluation */
+__thread int parseTreeRetained = 0;
 
+/* Mark the tree being evaluated as retained */
+void RetainParseTree(){
+	parseTreeRetained = 1;
 }
 
-/* Get and set number data */
-void SetNumberData(VyParseTree* tree, VyNumber** num){
-	if(tree->type == TREE_NUM){
-		tree->data->num.num = num;
+/* Get or reset whether the tree being evaluated is retained */
+int ParseTreeRetained(){
+	return parseTreeRetained;
+}
+void SetParseTreeRetained(int retained){
+	parseTreeRetained = retained;
+}
+
+/* Find the block of a tree, which starts just before its root */
+TreeBlock* BlockOfTree(VyParseTree* tree){
+	return (TreeBlock*)((char*) tree - offsetof(TreeBlock, nodes));
+}
+
+/* Get the module of a node */
+int GetTreeModule(VyParseTree* tree){
+	return tree->module;
+}
+
+/* Set the module of every node of a tree (only the root of a tree knows where its block ends) */
+void SetTreeModule(VyParseTree* tree, int module){
+	int numNodes;
+	VyParseTree* nodes = TreeInBlock(BlockOfTree(tree), &numNodes);
+
+	int i;
+	for(i = 0; i < numNodes; i++){
+		nodes[i].module = module;
 	}
 }
-VyNumber** GetNumberData(VyParseTree* tree){
-	if(tree->type == TREE_NUM){
-		return tree->data->num.num; 
-	}else{
-		return NULL;	
+
+/* Give every node of a tree the module of another node, and its position where the tree has none */
+void SetTreeOrigin(VyParseTree* tree, VyParseTree* origin){
+	int numNodes;
+	VyParseTree* nodes = TreeInBlock(BlockOfTree(tree), &numNodes);
+
+	int i;
+	for(i = 0; i < numNodes; i++){
+		nodes[i].module = origin->module;
+		if(nodes[i].pos == NO_POSITION){
+			nodes[i].pos = origin->pos;
+		}
 	}
 }
 
-/* Set the position */
-void SetPosition(VyParseTree* tree, Position* pos){
-	/* Copy all the position data */
-	if(tree->pos == NULL) {
-		tree->pos = malloc(sizeof(Position));
-		tree->pos->line = pos->line;
-		tree->pos->indent = pos->indent;
-		tree->pos->character = pos->character;
+/* Push a copy of a tree (without its cached data) onto a builder */
+void PushCopy(TreeBuilder* builder, VyParseTree* tree){
+	if(tree->type == TREE_IDENT || tree->type == TREE_STR){
+		PushText(builder, tree->type, GetStrData(tree), tree->data.str.length);
+	}
+	else if(tree->type == TREE_NUM){
+		PushNumber(builder, tree->data.num);
+	}
+	else if(tree->type == TREE_ERROR){
+		PushError(builder, tree->data.message);
+	}
+	else if(tree->type == TREE_LIST){
+		int list = BeginList(builder);
+		int i;
+		for(i = 0; i < ListTreeSize(tree); i++){
+			PushCopy(builder, GetListData(tree, i));
+		}
+		EndList(builder, list);
+	}
+	else if(tree->type == TREE_REF){
+		PushCopy(builder, GetObj(tree));
+		int ref = BeginReference(builder);
+		PushCopy(builder, GetRef(tree));
+		EndReference(builder, ref);
 	}
+
+	builder->pending[builder->numPending - 1].pos = tree->pos;
+	builder->pending[builder->numPending - 1].module = tree->module;
+}
+
+/* Copy a tree, or part of one, into a tree of its own */
+VyParseTree* CopyParseTree(VyParseTree* tree){
+	TreeBuilder* builder = CreateTreeBuilder();
+	PushCopy(builder, tree);
+	VyParseTree* copy = FinishTree(builder);
+	DeleteTreeBuilder(builder);
+	return copy;
+}
+
+/* Find the block holding a tree, and its size in bytes */
+void* GetTreeBlock(VyParseTree* tree, int* size){
+	TreeBlock* block = BlockOfTree(tree);
+	*size = sizeof(TreeBlock) + sizeof(VyParseTree) * block->numNodes + block->poolSize;
+	return block;
+}
+
+/* Find the tree held in a block, and the number of nodes in it (the root is first, so they are root[0 .. n - 1]) */
+VyParseTree* TreeInBlock(void* block, int* numNodes){
+	*numNodes = ((TreeBlock*) block)->numNodes;
+	return ((TreeBlock*) block)->nodes;
 }
 
-/* Delete a parse tree */
+/* Delete a parse tree: the whole tree is one block (only the caches are separate) */
 void DeleteParseTree(VyParseTree* tree){
-	/* Make sure you aren't freeing null pointers */
 	if(tree != NULL){
-		if(tree->data != NULL){
-			/* Free all the sub-trees depending on the type */
-			int treeType = tree->type;
-
-			/* For identifiers the only associated data to free is the string data */
-			if(treeType == TREE_IDENT){
-				free(tree->data->ident.str);
-			}
-
-			/* For lists, free all the members of the list */
-			else if(treeType == TREE_LIST){
-				/* Iterate through and free all the elements */
-				int i;
-				for(i = 0; i < ListTreeSize(tree); i++){	
-					VyParseTree* next = GetListData(tree,i);
-					DeleteParseTree(next);
-				}
-
-				/* Free the used array */
-				free(tree->data->list.list);
-			}
-
-			/* For references, free both parts of the reference */
-			else if(treeType == TREE_REF){
-				DeleteParseTree(GetObj(tree));
-				DeleteParseTree(GetRef(tree));
-			}
-
-
-
-			/* Finally, free the rest of the tree and the data*/
-			free(tree->data);
-		}
-		/* Free the position data */
-		if(tree->pos != NULL){
-			free(tree->pos);
+		TreeBlock* block = BlockOfTree(tree);
+
+		int i;
+		for(i = 0; i < block->numNodes; i++){
+			FreeTreeCache(&block->nodes[i]);
 		}
-		free(tree);
+
+		free(block);
 	}
 }
-
-
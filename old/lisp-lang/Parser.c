@@ -1,219 +1,191 @@
 #include "Vyion.h"
 
-VyParseTree* Parse();
+/* The builder which all parsed trees are assembled in */
+__thread TreeBuilder* treeBuilder = NULL;
 
-/* Parse a generic list (either () or []) */
-VyParseTree* ParseListGeneric(int endTokenType){
-	/* Create a list with no items in it */
-	VyParseTree* list = MakeListTree();
+void ParseExpression();
+
+/* Parse the next expression, or push an error if the input ended before it */
+void ParseOperand(char* missing){
+	if(MoreTokensExist()){
+		ParseExpression();
+	}else{
+		PushError(treeBuilder, missing);
+	}
+}
 
+/* Parse a generic list (either () or []) */
+void ParseListGeneric(int endTokenType){
 	/* Make sure there is more to read and that the file isn't over */
 	if(!MoreTokensExist()){
-		return ParseError("Unclosed list at end of file.");	
+		PushError(treeBuilder, "Unclosed list at end of file.");
+		return;
 	}
 
-	/* While the list, isn't over add items to it */
+	/* Create a list, and while it isn't over add items to it */
+	int list = BeginList(treeBuilder);
 	VyToken* nextToken;
 	while((nextToken = GetLookAheadToken())->type != endTokenType){
-		/* Add the next element, which is recieved from Parse(), to the list */
-		VyParseTree* nextElement = Parse();
-		AddToList(list, nextElement);
-
+		/* Add the next element to the list */
+		ParseExpression();
 
 		/* If there are no more tokens, then a parenthesis is unclosed */
 		if(!MoreTokensExist()) {
-			VyParseTree* error = ParseError("Unclosed list");
-			SetPosition(error, nextToken->pos);
-			AddToList(list, error);
-			return list;
+			PushError(treeBuilder, "Unclosed list");
+			SetPendingPosition(treeBuilder, &nextToken->pos);
+			EndList(treeBuilder, list);
+			return;
 		}
 
 	}
 	GetNextToken();
 
-
-	return list;
-
+	EndList(treeBuilder, list);
 }
 
 /* Parse a list */
-VyParseTree* ParseList(){
-	return ParseListGeneric(CPAREN);
+void ParseList(){
+	ParseListGeneric(CPAREN);
+}
+
+/* Parse a list wrapped in an outer list starting with a keyword, such as (quote-substitutions (...)) */
+void ParseWrappedList(char* keyword, int endTokenType){
+	int outerList = BeginList(treeBuilder);
+	PushIdent(treeBuilder, keyword, strlen(keyword));
+	ParseListGeneric(endTokenType);
+	EndList(treeBuilder, outerList);
 }
 
 /* Parse a bracketed list as a quoted list */
-VyParseTree* ParseBracketedList(){
+void ParseBracketedList(){
 	/* Same procedure as for a normal list, but 
 	 * with CBRACKET as the end condition instead of CPAREN */
-	VyParseTree* list = ParseListGeneric(CBRACKET);
-
-	/* Put it in an outer list containting quote-substitutions */
-	VyParseTree* outerList = MakeListTree();
-	VyParseTree* symb = MakeIdent();
-	SetStrData(symb, "quote-substitutions");
-	AddToList(outerList, symb);
-	AddToList(outerList, list);
-
-	return outerList;
+	ParseWrappedList("quote-substitutions", CBRACKET);
 }
 
 /* Parse a list enclosed in {braces} as an infix list */
-VyParseTree* ParseCurlyList(){
-	VyParseTree* list = ParseListGeneric(CCURLY);
-
-	/* Put it in an outer list containting quote-substitutions */
-	VyParseTree* outerList = MakeListTree();
-	VyParseTree* symb = MakeIdent();
-	SetStrData(symb, "infix");
-	AddToList(outerList, symb);
-	AddToList(outerList, list);
-
-	return outerList;
-}
-
-/* Parse an item preceeded by a quote mark ' */
-VyParseTree* ParseQuoted(){
-	/* Parse it normally and put it in a quote */
-	return Quote(Parse());
-}
-
-/* Parse a substitution (an item preceeded by a dollar sign) */
-VyParseTree* ParseSubstitution(){
-	/* Parse the next item and  put it in a substitution node */
-	return Substitution(Parse(), 0);
+void ParseCurlyList(){
+	ParseWrappedList("infix", CCURLY);
 }
 
-/* Parse a splicing subsitution */
-VyParseTree* ParseSpliceSubstitution(){
-	/* Parse the next item and  put it in a substitution node */
-	return Substitution(Parse(), 1);
+/* Parse an item preceded by a prefix (such as ' or $), putting it in a list with the given keyword */
+void ParsePrefixed(char* keyword){
+	int list = BeginList(treeBuilder);
+	PushIdent(treeBuilder, keyword, strlen(keyword));
+	ParseOperand("Missing expression after prefix.");
+	EndList(treeBuilder, list);
 }
 
 /* Parse a number from a token */
-VyParseTree* ParseNumberFromToken(VyToken* tok){
-	char* numData = tok->data;
-	VyNumber** num = ParseNumber(numData);
+void ParseNumberFromToken(VyToken* tok){
+	VyNumber** num = ParseNumber(TokenText(tok), tok->length);
 
 	/* Check for errors in the parsing */
 	char* error = GetLastNumberParsingError();
 	if(error != NULL){
-		return ParseError(error);	
+		PushError(treeBuilder, error);
 	}
 
-	/* If no errors, return the parsing result */
+	/* If no errors, push the parsing result */
 	else{
-		VyParseTree* tree = MakeNum();
-		SetNumberData(tree, num);
-		return tree;
+		PushNumber(treeBuilder, num);
 	}
 }
 
-/* Parse the next expression */
-VyParseTree* Parse(){
-	/* Check that we have not reached the end of the input stream; if so, return null */
-	if(!MoreTokensExist()){
-		return NULL;	
-	}
-
-
+/* Parse the next expression, pushing exactly one node onto the tree builder */
+void ParseExpression(){
 	/* Get the next token */
 	VyToken* next = GetNextToken();
 
 	/* It's type is used to determine how to continue parsing */
 	int tokType = next->type;
 
-	/* Store the result of parsing before returning it */
-	VyParseTree* expr;
-
 	/* If it starts with a parenthesis, parse it as a list */
 	if(tokType == OPAREN){
-		expr =  ParseList();
+		ParseList();
 	}
 
 	/* If it begins with a quote, then parse whatever is next and quote it */
 	else if(tokType == QUOTE){
-		expr = ParseQuoted();
+		ParsePrefixed("quote");
 	}
 
 	/* Parse a substitution */
 	else if(tokType == DOLLAR){
-		expr = ParseSubstitution();
+		ParsePrefixed("substitution");
 	}
 	/* Parse a splicing substitution */
 	else if(tokType == DOLLARAT){
-		expr = ParseSpliceSubstitution();	
+		ParsePrefixed("splicing-substitution");
 	}
 
 	/* Parse a bracketed list */
 	else if(tokType == OBRACKET){
-		expr = ParseBracketedList();
+		ParseBracketedList();
 	}
 
 	/* Parse an infix list (curly braces) */
 	else if(tokType == OCURLY){
-		expr = ParseCurlyList();	
+		ParseCurlyList();
 	}
 	/* If it is a number, identifier, or string then make a parse tree out of the token */
 	else if(tokType == IDENT){
-		VyParseTree* ident = MakeIdent();
-		SetStrData(ident, next->data);
-		expr = ident;
+		PushIdent(treeBuilder, TokenText(next), next->length);
 	}
 	else if(tokType == NUM){
-		expr = ParseNumberFromToken(next);
+		ParseNumberFromToken(next);
 	}
 	else if(tokType == STRING){
-		VyParseTree* str = MakeString();
-		SetStrData(str,next->data);
-		expr = str;
+		PushString(treeBuilder, TokenText(next), next->length);
 	}
 	/* Unexpected end of list */
 	else if(tokType == CPAREN || tokType == CBRACKET || tokType == CCURLY){
-		VyParseTree* err = ParseError("Unexpected end of list");
-		SetPosition(err, next->pos);
-		return err;
+		PushError(treeBuilder, "Unexpected end of list");
+		SetPendingPosition(treeBuilder, &next->pos);
+		return;
 	}
 
 	/* If there is no expression before a :, then the token type will be COLON
 	 * Instead of dying, add an error */
 	else if(tokType == COLON){
-		VyParseTree* error = ParseError("Reference lacking instance");
-		SetPosition(error, next->pos);  
-		return error;
+		PushError(treeBuilder, "Reference lacking instance");
+		SetPendingPosition(treeBuilder, &next->pos);
+		return;
 	}
 
+	/* Set the position of the expression just parsed (which is the obj part if it turns out to be a reference) */
+	SetPendingPosition(treeBuilder, &next->pos);
+
 	/* Handle object references: Check whether the next token is a colon.
-	 * If so, then use the previously parsed expression (expr) and another
-	 * expression  gotten from Parse() to create a reference node */
+	 * If so, then use the previously parsed expression as the obj part
+	 * and parse another expression as the ref part */
 	VyToken* lookAhead = GetNextToken();
 	if(lookAhead != NULL /* Make sure that the token list didn't end before looking at the type */
 			&& lookAhead->type == COLON){ 
-		VyParseTree* obj = expr;
-
-		VyParseTree* ref = Parse();
-
-		/* Check for validity */
-		if(ref == NULL){
-			expr = Reference(obj, ParseError("Incomplete reference."));  
-		}else{
-			expr = Reference(obj, ref);
-		}
+		int ref = BeginReference(treeBuilder);
+		ParseOperand("Incomplete reference.");
+		EndReference(treeBuilder, ref);
+		SetPendingPosition(treeBuilder, &next->pos);
 	}
 	else{
 		/* Backtrack one token to make up for the lookahead */
 		if(lookAhead != NULL) BacktrackToken();
 	}   
+}
 
-	/* Set the position of the current expression */
-	SetPosition(expr, next->pos);
+/* Parse the next expression into its own tree */
+VyParseTree* Parse(){
+	/* Check that we have not reached the end of the input stream; if so, return null */
+	if(!MoreTokensExist()){
+		return NULL;	
+	}
 
-	/* If the tree is an object reference, set the position of 
-	 * the first part (obj), because it wasn't gotten through a full Parse() call*/
-	if(expr->type == TREE_REF){
-		SetPosition(GetObj(expr), next->pos);
+	if(treeBuilder == NULL){
+		treeBuilder = CreateTreeBuilder();
 	}
 
-	return expr;
+	ParseExpression();
+	return FinishTree(treeBuilder);
 }
 
 /* Check and print errors  */
@@ -245,10 +217,13 @@ int CheckAndPrintErrors(VyParseTree* tree){
 	else if(treeType == TREE_ERROR){
 		printf("\n\n");
 		printf("------- Parsing Error -------\n");
+		Position pos;
 		printf("Position: ");
-		PrintPosition(tree->pos);
+		if(GetTreePosition(tree, &pos)){
+			PrintPosition(&pos);
+		}
 		printf("\n");
-		printf(tree->data->error.message);
+		printf(GetErrorMessage(tree));
 		printf("\n-----------------------------");
 		error = 1;
 	}
@@ -259,7 +234,7 @@ int CheckAndPrintErrors(VyParseTree* tree){
 }
 
 /* Functions to print the tree */
-int linesPrinted = 0;
+__thread int linesPrinted = 0;
 
 /* Print a string multiple times */
 void PrintMultiple(char* str, int times){
@@ -345,14 +320,13 @@ void PrintParseTree(VyParseTree* tree){
 	else if(treeType == TREE_STR){
 		printf("\"");
 		printf("%s", GetStrData(tree));
-		printf("\"");
-		printf("\"");
+		printf("\" ");
 	}
 
 	/* If it is an error, print the error */
 	else if(treeType == TREE_ERROR){
 		printf("\n---------------------------------\n");
-		printf("Error: %s", tree->data->error.message);
+		printf("Error: %s", GetErrorMessage(tree));
 		printf("\n---------------------------------\n");
 	}
 
@@ -390,16 +364,20 @@ VyParseTree* ParseFile(char* filename){
 		printf("Empty file: %s\n", filename);
 		return NULL;
 	}
+	if(treeBuilder == NULL){
+		treeBuilder = CreateTreeBuilder();
+	}
+
 	/* Parse the tokens */
-	VyParseTree* list = MakeListTree();
+	int list = BeginList(treeBuilder);
 	while(MoreTokensExist()) {
-		VyParseTree* tree = Parse();
-		AddToList(list, tree);
+		ParseExpression();
 	}
+	EndList(treeBuilder, list);
 
 	CleanLexer();
 
-	return list;
+	return FinishTree(treeBuilder);
 
 }
 
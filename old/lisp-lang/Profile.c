@@ -0,0 +1,372 @@
+#include "Vyion.h"
+
+/* The time between samples, in microseconds of CPU time */
+#define PROFILE_INTERVAL 1000
+
+/* The deepest stack kept in the shadow stack, and the most frames of it kept in a sample (the innermost ones) */
+#define SHADOW_STACK_SIZE (64*1024)
+#define MAX_SAMPLE_FRAMES 128
+
+/* The number of entries in the sample buffer (it is mapped without reserving memory, so only what is used costs) */
+#define SAMPLE_BUFFER_SIZE (16*1024*1024)
+
+/* Stands in for the outer frames of a sample whose stack was too deep to keep */
+#define TRUNCATED_FRAME ((void*) 1)
+
+/* How many functions the table at exit shows */
+#define TOP_FUNCTIONS 20
+
+/* Whether the profiler is on, and the file the folded stacks go to */
+int profiling = 0;
+char* profileFile = NULL;
+
+/* The shadow stack: each frame is the code of a native function, or the C function of a builtin. Frames deeper
+ * than the stack only count towards the depth. */
+void* shadowStack[SHADOW_STACK_SIZE];
+volatile int shadowDepth = 0;
+
+/* The samples: each is the number of frames kept, followed by the frames (outermost first) */
+void** samples = NULL;
+volatile long samplesUsed = 0;
+volatile long samplesDropped = 0;
+
+/* Push the frame of a function call */
+void PushProfileFrame(VyFunction** func){
+	if(!profiling){
+		return;
+	}
+
+	/* The frame is written before the depth says it is there, in case a sample is taken in between */
+	if(shadowDepth < SHADOW_STACK_SIZE){
+		shadowStack[shadowDepth] = FunctionKey(func);
+		__asm__ __volatile__("" ::: "memory");
+	}
+	shadowDepth++;
+}
+
+/* Pop the frame of a function call */
+void PopProfileFrame(){
+	if(profiling){
+		shadowDepth--;
+	}
+}
+
+/* Take a sample of the shadow stack (this is the signal handler, so it only copies) */
+void TakeSample(int signal){
+	int fullDepth = shadowDepth;
+	int depth = fullDepth;
+	if(depth > SHADOW_STACK_SIZE){
+		depth = SHADOW_STACK_SIZE;
+	}
+
+	int kept = (depth > MAX_SAMPLE_FRAMES) ? MAX_SAMPLE_FRAMES : depth;
+	if(samplesUsed + kept + 1 > SAMPLE_BUFFER_SIZE){
+		samplesDropped++;
+		return;
+	}
+
+	void** sample = samples + samplesUsed;
+	sample[0] = (void*)(long) kept;
+	memcpy(sample + 1, shadowStack + depth - kept, sizeof(void*) * kept);
+	if(kept < fullDepth){
+		sample[1] = TRUNCATED_FRAME;
+	}
+	samplesUsed += kept + 1;
+}
+
+/***** Reporting *****/
+
+/* A function found in the samples, with its name and counts */
+typedef struct {
+	void* key;
+	char* name;
+	long self;
+	long total;
+
+	/* The last sample the function was counted in, so that recursion counts once towards the total */
+	long lastSample;
+} ProfiledFunction;
+
+/* The functions, in an open addressed table (its size is a power of two) */
+ProfiledFunction* profiled = NULL;
+int profiledCapacity = 0;
+int numProfiled = 0;
+
+/* Find the name of a variable the function or macro with some code is bound to in a scope (or NULL) */
+char* FindNameOfCode(Scope* scope, VyParseTree* code){
+	int i;
+	for(i = 0; i < scope->size; i++){
+		VyObject val = scope->values[i];
+		if(val >= 0 && ObjType(val) == VALFUNC && ((VyFunction**) ObjData(val))[0]->code == code){
+			return scope->names[i];
+		}
+		if(val >= 0 && ObjType(val) == VALMAC && ((VyMacro**) ObjData(val))[0]->code == code){
+			return scope->names[i];
+		}
+	}
+	return NULL;
+}
+
+/* Find what identifies a function in a frame */
+void* FunctionKey(VyFunction** func){
+	return (func[0]->code != NULL) ? (void*) func[0]->code : (void*) func[0]->EvalFunction;
+}
+
+/* Find a function's name: builtins after their entry in the table, and native functions (or macros) after a
+ * variable they are bound to (in the global scope or a module), followed by the file and line of their code (so
+ * that functions of the same name, or lambdas on the same line, in different files are told apart) */
+char* FindFunctionName(void* key){
+	int builtin = FindBuiltin((VyObject (*)(VyFunction**, VyObject*, int)) key);
+	if(builtin >= 0){
+		return strdup(GetBuiltin(builtin)->name);
+	}
+
+	VyParseTree* code = key;
+	char* name = FindNameOfCode(GetGlobalScope(), code);
+
+	int numModules;
+	Module* modules = GetModules(&numModules);
+	int i;
+	for(i = 0; i < numModules && name == NULL; i++){
+		name = FindNameOfCode(modules[i].scope, code);
+	}
+
+	if(name == NULL){
+		name = "lambda";
+	}
+
+	Position pos;
+	if(!GetTreePosition(code, &pos)){
+		return strdup(name);
+	}
+
+	char* file = TreeModuleName(code);
+	char* named = malloc(strlen(name) + ((file != NULL) ? strlen(file) : 0) + 16);
+	if(file != NULL){
+		sprintf(named, "%s:%s:%d", name, file, pos.line + 1);
+	}else{
+		sprintf(named, "%s:%d", name, pos.line + 1);
+	}
+	return named;
+}
+
+/* The names found so far, in an open addressed table (its size is a power of two) */
+typedef struct {
+	void* key;
+	char* name;
+} FunctionName;
+
+FunctionName* functionNames = NULL;
+int functionNameCapacity = 0;
+int numFunctionNames = 0;
+
+/* Find the slot of a key in the table of names */
+int FunctionNameSlot(FunctionName* names, int capacity, void* key){
+	int slot = ((unsigned long) key >> 3) & (capacity - 1);
+	while(names[slot].key != NULL && names[slot].key != key){
+		slot = (slot + 1) & (capacity - 1);
+	}
+	return slot;
+}
+
+/* Name a function, finding the name only the first time */
+char* NameFunction(void* key){
+	if(2 * (numFunctionNames + 1) > functionNameCapacity){
+		int newCapacity = (functionNameCapacity == 0) ? 64 : functionNameCapacity * 2;
+		FunctionName* names = calloc(newCapacity, sizeof(FunctionName));
+
+		int i;
+		for(i = 0; i < functionNameCapacity; i++){
+			if(functionNames[i].key != NULL){
+				names[FunctionNameSlot(names, newCapacity, functionNames[i].key)] = functionNames[i];
+			}
+		}
+		free(functionNames);
+		functionNames = names;
+		functionNameCapacity = newCapacity;
+	}
+
+	int slot = FunctionNameSlot(functionNames, functionNameCapacity, key);
+	if(functionNames[slot].key == NULL){
+		functionNames[slot].key = key;
+		functionNames[slot].name = FindFunctionName(key);
+		numFunctionNames++;
+	}
+	return functionNames[slot].name;
+}
+
+/* Find a function in the table, adding it if it isn't there */
+ProfiledFunction* FindProfiled(void* key){
+	if(2 * (numProfiled + 1) > profiledCapacity){
+		ProfiledFunction* old = profiled;
+		int oldCapacity = profiledCapacity;
+
+		profiledCapacity = (profiledCapacity == 0) ? 64 : profiledCapacity * 2;
+		profiled = calloc(profiledCapacity, sizeof(ProfiledFunction));
+
+		int i;
+		for(i = 0; i < oldCapacity; i++){
+			if(old[i].key != NULL){
+				int slot = ((unsigned long) old[i].key >> 3) & (profiledCapacity - 1);
+				while(profiled[slot].key != NULL){
+					slot = (slot + 1) & (profiledCapacity - 1);
+				}
+				profiled[slot] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	int slot = ((unsigned long) key >> 3) & (profiledCapacity - 1);
+	while(profiled[slot].key != NULL && profiled[slot].key != key){
+		slot = (slot + 1) & (profiledCapacity - 1);
+	}
+
+	if(profiled[slot].key == NULL){
+		profiled[slot].key = key;
+		profiled[slot].name = (key == TRUNCATED_FRAME) ? "[truncated]" : NameFunction(key);
+		profiled[slot].lastSample = -1;
+		numProfiled++;
+	}
+	return &profiled[slot];
+}
+
+/* Compare folded stacks, and functions by their self counts (most first) */
+int CompareStrings(const void* a, const void* b){
+	return strcmp(*(char**) a, *(char**) b);
+}
+int CompareSelf(const void* a, const void* b){
+	long diff = ((ProfiledFunction*) b)->self - ((ProfiledFunction*) a)->self;
+	return (diff > 0) - (diff < 0);
+}
+
+/* Stop profiling, write the folded stacks, and print the table */
+void StopProfiler(){
+	if(!profiling){
+		return;
+	}
+
+	/* Stop the timer first, so that the samples don't change under the report */
+	struct itimerval timer;
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	profiling = 0;
+
+	/* Count the functions in each sample, and make its folded stack */
+	long numSamples = 0;
+	long pos;
+	for(pos = 0; pos < samplesUsed; pos += (long) samples[pos] + 1){
+		numSamples++;
+	}
+	char** folded = malloc(sizeof(char*) * (numSamples + 1));
+
+	long sample = 0;
+	for(pos = 0; pos < samplesUsed; pos += (long) samples[pos] + 1, sample++){
+		int numFrames = (long) samples[pos];
+		void** frames = samples + pos + 1;
+
+		CharList* stack = MakeCharList();
+		char* root = "toplevel";
+		while(*root != '\0'){
+			Add(stack, *root++);
+		}
+
+		int i;
+		for(i = 0; i < numFrames; i++){
+			ProfiledFunction* func = FindProfiled(frames[i]);
+			if(func->lastSample != sample){
+				func->total++;
+				func->lastSample = sample;
+			}
+			if(i == numFrames - 1){
+				func->self++;
+			}
+
+			Add(stack, ';');
+			char* name;
+			for(name = func->name; *name != '\0'; name++){
+				Add(stack, *name);
+			}
+		}
+
+		folded[sample] = strndup(stack->chars, Size(stack));
+		Delete(stack);
+	}
+
+	/* Identical stacks end up next to each other once sorted, so each run is one line */
+	qsort(folded, numSamples, sizeof(char*), &CompareStrings);
+
+	FILE* file = fopen(profileFile, "w");
+	if(file == NULL){
+		fprintf(stderr, "Couldn't write the profile to \"%s\".\n", profileFile);
+	}
+
+	long i;
+	for(i = 0; i < numSamples; ){
+		long run = i;
+		while(run < numSamples && strcmp(folded[run], folded[i]) == 0){
+			run++;
+		}
+		if(file != NULL){
+			fprintf(file, "%s %ld\n", folded[i], run - i);
+		}
+		i = run;
+	}
+	if(file != NULL){
+		fclose(file);
+	}
+
+	for(i = 0; i < numSamples; i++){
+		free(folded[i]);
+	}
+	free(folded);
+
+	/* The table of the functions with the most self samples */
+	ProfiledFunction* functions = malloc(sizeof(ProfiledFunction) * (numProfiled + 1));
+	int numFunctions = 0;
+	for(i = 0; i < profiledCapacity; i++){
+		if(profiled[i].key != NULL){
+			functions[numFunctions++] = profiled[i];
+		}
+	}
+	qsort(functions, numFunctions, sizeof(ProfiledFunction), &CompareSelf);
+
+	fprintf(stderr, "\n--- Profile: %ld samples (%ld dropped), %d us apart ---\n", numSamples, (long) samplesDropped, PROFILE_INTERVAL);
+	fprintf(stderr, "%10s %7s %10s %7s  %s\n", "self", "self%", "total", "total%", "function");
+	for(i = 0; i < numFunctions && i < TOP_FUNCTIONS; i++){
+		double scale = (numSamples > 0) ? 100.0 / numSamples : 0;
+		fprintf(stderr, "%10ld %6.2f%% %10ld %6.2f%%  %s\n", functions[i].self, functions[i].self * scale,
+				functions[i].total, functions[i].total * scale, functions[i].name);
+	}
+	free(functions);
+}
+
+/* Start profiling */
+void StartProfiler(char* filename){
+	samples = mmap(NULL, sizeof(void*) * SAMPLE_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(samples == MAP_FAILED){
+		fprintf(stderr, "Couldn't allocate memory for profiling.\n");
+		exit(0);
+	}
+	profileFile = filename;
+
+	/* The report is also made if the program exits early (errors exit from wherever they are handled) */
+	atexit(&StopProfiler);
+
+	/* System calls interrupted by a sample are restarted, so that reading files isn't disturbed */
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = &TakeSample;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, NULL);
+
+	profiling = 1;
+
+	struct itimerval timer;
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = PROFILE_INTERVAL;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_PROF, &timer, NULL);
+}
@@ -0,0 +1,264 @@
+#include "Vyion.h"
+
+/* The size of the blocks the file is read in */
+#define READER_BLOCK_SIZE (64*1024)
+
+/* Open a file for reading forms */
+VyReader* OpenReader(char* filename){
+	FILE* file = fopen(filename, "r");
+	if(file == NULL){
+		return NULL;	
+	}
+
+	VyReader* reader = malloc(sizeof(VyReader));
+	reader->file = file;
+	reader->eof = 0;
+	reader->capacity = READER_BLOCK_SIZE;
+	reader->buffer = malloc(reader->capacity);
+	reader->start = reader->pos = reader->end = 0;
+	reader->counted = 0;
+	reader->line = reader->character = reader->indent = 0;
+
+	return reader;
+}
+
+/* Update the file position for all the characters up to the given index (the same way the lexer counts it) */
+static void CountPosition(VyReader* reader, int upTo){
+	int i;
+	for(i = reader->counted; i < upTo; i++){
+		char c = reader->buffer[i];
+		if(c == '\n'){
+			reader->line++;
+			reader->character = 0;
+			reader->indent = 0;
+		}
+		else{
+			if(c == '\t'){
+				reader->indent++;	
+			}
+			reader->character++;
+		}
+	}
+	reader->counted = upTo;
+}
+
+/* Read more of the file into the buffer, until there are more than the given number of characters after pos.
+ * The characters before the current form are discarded to make room. Returns 0 at the end of the file. */
+static int FillBuffer(VyReader* reader, int ahead){
+	while(reader->pos + ahead >= reader->end){
+		if(reader->eof){
+			return 0;	
+		}
+
+		/* Discard everything before the form */
+		if(reader->start > 0){
+			CountPosition(reader, reader->start);
+			memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+			reader->pos -= reader->start;
+			reader->end -= reader->start;
+			reader->counted -= reader->start;
+			reader->start = 0;
+		}
+
+		/* Make sure there is room for another block */
+		if(reader->capacity - reader->end < READER_BLOCK_SIZE){
+			reader->capacity *= 2;
+			reader->buffer = realloc(reader->buffer, reader->capacity);
+		}
+
+		int read = fread(reader->buffer + reader->end, 1, reader->capacity - reader->end, reader->file);
+		if(read <= 0){
+			reader->eof = 1;
+		}
+		reader->end += read;
+	}
+
+	return 1;
+}
+
+/* Look at the character a given number (0 or 1) of characters ahead without reading it */
+static inline int PeekChar(VyReader* reader, int ahead){
+	if(reader->pos + ahead >= reader->end && !FillBuffer(reader, ahead)){
+		return EOF;	
+	}
+
+	return (unsigned char)(reader->buffer[reader->pos + ahead]);
+}
+
+/* Read the next character */
+static inline int NextChar(VyReader* reader){
+	int c = PeekChar(reader, 0);
+	if(c != EOF){
+		reader->pos++;	
+	}
+	return c;
+}
+
+/* The characters which end an identifier or number (the same ones as in the lexer) */
+static const unsigned char atomEnds[256] = {
+	['\0'] = 1, [' '] = 1, ['\r'] = 1, ['\t'] = 1, ['\n'] = 1, ['('] = 1, [')'] = 1, ['['] = 1, [']'] = 1,
+	['{'] = 1, ['}'] = 1, [':'] = 1, ['$'] = 1, ['\''] = 1
+};
+
+/* Whether a character ends an identifier or number */
+static inline int EndsAtom(int c){
+	return c == EOF || atomEnds[c];
+}
+
+/* Skip whitespace and comments */
+void SkipAtmosphere(VyReader* reader){
+	while(1){
+		int c = PeekChar(reader, 0);
+
+		if(c != EOF && (isWhitespace(c) || c == '\0')){
+			NextChar(reader);	
+		}
+
+		/* Single line comments */
+		else if(c == ';'){
+			while(c != EOF && c != '\n'){
+				c = NextChar(reader);
+			}
+		}
+
+		/* Nested |{ comments }| */
+		else if(c == '|' && PeekChar(reader, 1) == '{'){
+			NextChar(reader);
+			NextChar(reader);
+
+			int commentLevel = 1;
+			while(commentLevel > 0 && PeekChar(reader, 0) != EOF){
+				c = NextChar(reader);
+				if(c == '}' && PeekChar(reader, 0) == '|'){
+					NextChar(reader);
+					commentLevel--;
+				}
+				else if(c == '|' && PeekChar(reader, 0) == '{'){
+					NextChar(reader);
+					commentLevel++;
+				}
+			}
+		}
+
+		/* A # comments out the identifier after it */
+		else if(c == '#'){
+			NextChar(reader);
+			while(!EndsAtom(PeekChar(reader, 0))){
+				NextChar(reader);	
+			}
+		}
+
+		else {
+			return;	
+		}
+	}
+}
+
+/* Read a single datum, with any quotes or substitutions before it and any references after it */
+void ReadDatum(VyReader* reader){
+	int c = NextChar(reader);
+
+	/* Lists of any kind: read data until any closing delimiter. A mismatched delimiter ends the list
+	 * here too; the parser will find it and report it. */
+	if(c == '(' || c == '[' || c == '{'){
+		while(1){
+			SkipAtmosphere(reader);
+
+			int next = PeekChar(reader, 0);
+			if(next == EOF){
+				return;	
+			}
+			if(next == ')' || next == ']' || next == '}'){
+				NextChar(reader);
+				break;
+			}
+
+			ReadDatum(reader);
+		}
+	}
+
+	/* Quotes and substitutions apply to the next datum */
+	else if(c == '\'' || c == '$'){
+		if(c == '$' && PeekChar(reader, 0) == '@'){
+			NextChar(reader);	
+		}
+
+		SkipAtmosphere(reader);
+		if(PeekChar(reader, 0) != EOF){
+			ReadDatum(reader);	
+		}
+		return;
+	}
+
+	/* Strings end at a quote not preceeded by a backslash */
+	else if(c == '"'){
+		int prev = c;
+		while(1){
+			c = NextChar(reader);
+			if(c == EOF || (c == '"' && prev != '\\')){
+				break;	
+			}
+			prev = c;
+		}
+	}
+
+	/* Stray closing delimiters and colons are a datum by themselves (which the parser reports as an error) */
+	else if(c == ')' || c == ']' || c == '}' || c == ':'){
+		return;	
+	}
+
+	/* Otherwise, it's an identifier or number */
+	else{
+		while(!EndsAtom(PeekChar(reader, 0))){
+			NextChar(reader);	
+		}
+	}
+
+	/* Any datum may be followed by a colon and another datum, making a reference */
+	SkipAtmosphere(reader);
+	if(PeekChar(reader, 0) == ':'){
+		NextChar(reader);
+		SkipAtmosphere(reader);
+		if(PeekChar(reader, 0) != EOF){
+			ReadDatum(reader);	
+		}
+	}
+}
+
+/* Read the next top-level form */
+int ReadForm(VyReader* reader){
+	/* Whitespace and comments between forms aren't part of any form */
+	reader->start = reader->pos;
+	SkipAtmosphere(reader);
+	reader->start = reader->pos;
+	if(PeekChar(reader, 0) == EOF){
+		return 0;	
+	}
+
+	CountPosition(reader, reader->pos);
+	reader->formPosition.line = reader->line;
+	reader->formPosition.character = reader->character;
+	reader->formPosition.indent = reader->indent;
+
+	ReadDatum(reader);
+
+	return 1;
+}
+
+/* Retrieve the last form */
+char* FormText(VyReader* reader){
+	return reader->buffer + reader->start;
+}
+int FormLength(VyReader* reader){
+	return reader->pos - reader->start;
+}
+Position* FormPosition(VyReader* reader){
+	return &reader->formPosition;
+}
+
+/* Close the reader */
+void CloseReader(VyReader* reader){
+	fclose(reader->file);
+	free(reader->buffer);
+	free(reader);
+}
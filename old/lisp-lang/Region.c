@@ -0,0 +1,156 @@
+#include "Vyion.h"
+
+/* The size of a normal chunk; larger allocations get a chunk of their own */
+#define REGION_CHUNK_SIZE (64*1024)
+
+/* Everything in a region is aligned to this many bytes */
+#define REGION_ALIGN 8
+
+/* Get a chunk with room for at least a certain number of bytes, reusing a spare one if possible */
+RegionChunk* GetChunk(VyRegion* region, int size){
+	if(size <= REGION_CHUNK_SIZE && region->spare != NULL){
+		RegionChunk* chunk = region->spare;
+		region->spare = chunk->next;
+		return chunk;
+	}
+
+	if(size < REGION_CHUNK_SIZE){
+		size = REGION_CHUNK_SIZE;
+	}
+	RegionChunk* chunk = malloc(sizeof(RegionChunk) + size);
+	chunk->limit = chunk->data + size;
+	return chunk;
+}
+
+/* Put a chunk with room for at least a certain number of bytes on top of the region */
+void PushChunk(VyRegion* region, int size){
+	RegionChunk* chunk = GetChunk(region, size);
+	chunk->next = region->chunk;
+	region->chunk = chunk;
+	region->top = chunk->data;
+}
+
+/* Take the top chunk off the region, keeping it as a spare if it is a normal sized one */
+void PopChunk(VyRegion* region){
+	RegionChunk* chunk = region->chunk;
+	region->chunk = chunk->next;
+
+	if(chunk->limit - chunk->data == REGION_CHUNK_SIZE){
+		chunk->next = region->spare;
+		region->spare = chunk;
+	}else{
+		free(chunk);
+	}
+}
+
+/* Create an empty region */
+VyRegion* CreateRegion(){
+	VyRegion* region = malloc(sizeof(VyRegion));
+	region->chunk = NULL;
+	region->spare = NULL;
+	PushChunk(region, REGION_CHUNK_SIZE);
+	return region;
+}
+
+/* Free a list of chunks */
+void FreeChunks(RegionChunk* chunk){
+	while(chunk != NULL){
+		RegionChunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+}
+
+/* Delete a region and all its memory */
+void DeleteRegion(VyRegion* region){
+	FreeChunks(region->chunk);
+	FreeChunks(region->spare);
+	free(region);
+}
+
+/* Allocate memory by bumping the top of the region */
+void* RegionAlloc(VyRegion* region, int size){
+	size = (size + REGION_ALIGN - 1) & ~(REGION_ALIGN - 1);
+	if(size > region->chunk->limit - region->top){
+		PushChunk(region, size);
+	}
+
+	void* mem = region->top;
+	region->top += size;
+	return mem;
+}
+
+/* Copy a string into a region */
+char* RegionStrndup(VyRegion* region, char* str, int length){
+	char* copy = RegionAlloc(region, length + 1);
+	memcpy(copy, str, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+/* Format a string into a region */
+char* RegionPrintf(VyRegion* region, char* format, ...){
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	char* str = RegionAlloc(region, length + 1);
+	va_start(args, format);
+	vsnprintf(str, length + 1, format, args);
+	va_end(args);
+	return str;
+}
+
+/* Remember the current top of the region */
+RegionMark MarkRegion(VyRegion* region){
+	RegionMark mark;
+	mark.chunk = region->chunk;
+	mark.top = region->top;
+	return mark;
+}
+
+/* Free everything allocated since the mark */
+void ReleaseRegion(VyRegion* region, RegionMark mark){
+	while(region->chunk != mark.chunk){
+		PopChunk(region);
+	}
+	region->top = mark.top;
+}
+
+/* Free everything in the region (the bottom chunk stays) */
+void ResetRegion(VyRegion* region){
+	while(region->chunk->next != NULL){
+		PopChunk(region);
+	}
+	region->top = region->chunk->data;
+}
+
+/* Start the region over, without freeing the memory in use */
+void AbandonRegion(VyRegion* region){
+	/* If nothing was allocated, there is nothing to give up */
+	if(region->chunk->next == NULL && region->top == region->chunk->data){
+		return;
+	}
+
+	region->chunk = NULL;
+	PushChunk(region, REGION_CHUNK_SIZE);
+}
+
+/* The interpreter's regions */
+__thread VyRegion* scratchRegion = NULL;
+__thread VyRegion* formRegion = NULL;
+
+/* Create the regions */
+void InitRegions(){
+	scratchRegion = CreateRegion();
+	formRegion = CreateRegion();
+}
+
+/* Get the regions */
+VyRegion* GetScratchRegion(){
+	return scratchRegion;
+}
+VyRegion* GetFormRegion(){
+	return formRegion;
+}
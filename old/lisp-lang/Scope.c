@@ -1,73 +1,139 @@
 #include "Vyion.h"
 
+/* The number of slots in the frame stack */
+#define FRAME_STACK_SIZE (1024*1024)
+
+/* A boxed slot holds the index of its cell, encoded below -1 so that it can't be mistaken for an object or unbound */
+#define IS_BOXED(val) ((val) <= -2)
+#define BOX_OF(cell) (-2 - (cell))
+#define CELL_OF(val) (-2 - (val))
+
+/* The cells of boxed variables; like objects, they are never freed */
+__thread VyObject* cells = NULL;
+__thread int numCells = 0;
+__thread int cellCapacity = 0;
+
+/* Create a cell holding a value, and return its index */
+int CreateCell(VyObject val){
+	if(numCells == cellCapacity){
+		cellCapacity = (cellCapacity == 0) ? 64 : cellCapacity * 2;
+		cells = realloc(cells, sizeof(VyObject) * cellCapacity);
+	}
+	cells[numCells] = val;
+	return numCells++;
+}
+
+/* Get the cells, or replace them with a copy of the given ones (for heap images) */
+VyObject* GetCells(int* num){
+	*num = numCells;
+	return cells;
+}
+void SetCells(VyObject* values, int num){
+	cells = realloc(cells, sizeof(VyObject) * num);
+	memcpy(cells, values, sizeof(VyObject) * num);
+	numCells = cellCapacity = num;
+}
+
 /***** Dealing with the scope data structure *****/
 
 /* Create an empty scope */
 Scope* CreateScope(){
 	Scope* scp = malloc(sizeof(Scope));
-	scp->vars = NULL;
+	scp->names = NULL;
+	scp->values = NULL;
 	scp->size = 0;
+	scp->capacity = 0;
+	scp->kind = SCOPE_ORDINARY;
+	scp->overflow = NULL;
+	scp->parent = NULL;
 
 	return scp;
 }
 
+/* Find the index of a variable in a scope (bound or not), or -1 */
+int FindSlot(Scope* scp, char* varName){
+	int i;
+	for(i = 0; i < scp->size; i++){
+		if(strcmp(varName, scp->names[i]) == 0){
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Read or write the value in a slot, going through its cell if it is boxed */
+VyObject SlotValue(Scope* scp, int slot){
+	VyObject val = scp->values[slot];
+	return IS_BOXED(val) ? cells[CELL_OF(val)] : val;
+}
+void StoreSlot(Scope* scp, int slot, VyObject val){
+	if(IS_BOXED(scp->values[slot])){
+		cells[CELL_OF(scp->values[slot])] = val;
+	}else{
+		scp->values[slot] = val;
+	}
+}
+
 /* Find a variable value */
 VyObject FindValue(Scope* scp, char* varName){
 	/* If scope is null, return null */
 	if(scp == NULL){
-		return -1;	
+		return -1;
 	}
 
-	/* Iterate through all the variables and compare their names */
-	int i;  
-	for(i = 0; i < scp->size; i++){
-		/* Retrieve the variable and name at that index */
-		VarBinding* var = scp->vars[i];
-		char* currentVarName = GetVarName(var);
-
-		/* Compare names */
-		if(strcmp(varName, currentVarName) == 0){
-			/* If they are the same, return the value */
-			return GetVarValue(var);	
+	/* Look in the scope's own variables, and then in the overflow */
+	int slot = FindSlot(scp, varName);
+	if(slot >= 0){
+		VyObject val = SlotValue(scp, slot);
+		if(val >= 0){
+			return val;
 		}
 	}
+	if(scp->overflow != NULL){
+		return FindValue(scp->overflow, varName);
+	}
 
 	/* If the variable wasn't found, return < 0 */
 	return -1;
 }
 
-/* Add a variable to a scope */
-void AddVariable(Scope* scp, VarBinding* var){
-	/* Allocate more memory for the new variable */
-	int scopeSize = scp->size;
-	scp->vars = realloc(scp->vars, sizeof(VarBinding*) * (scopeSize + 1));
+/* Add a variable to an ordinary scope */
+void AddVariable(Scope* scp, char* varName, VyObject val){
+	WatchBinding(varName, val);
+
+	/* Allocate more memory for the new variable (doubling the space, starting with room for a few) */
+	if(scp->size == scp->capacity){
+		scp->capacity = (scp->capacity == 0) ? 4 : scp->capacity * 2;
+		scp->names = realloc(scp->names, sizeof(char*) * scp->capacity);
+		scp->values = realloc(scp->values, sizeof(VyObject) * scp->capacity);
+	}
 
-	/* Add the variable and increment size */
-	scp->vars[scopeSize] = var;
+	/* Add the variable (with its own copy of the name, since the code it came from may be deleted) */
+	scp->names[scp->size] = strdup(varName);
+	scp->values[scp->size] = val;
 	scp->size++;
 }
 
-/* Set a variable value (independent of whether it already exists or not( */
+/* Set a variable value (independent of whether it already exists or not) */
 void SetVariable(Scope* scp, char* varName, VyObject val){
-	/* If the variable doesn't exist yet, then add it, otherwise, update it */
-	if(FindValue(scp, varName) < 0){
-		AddVariable(scp, CreateVariable(varName, val));
-	}else{
-		/* Iterate through all the variables and compare their names */
-		int i;  
-		for(i = 0; i < scp->size; i++){
-			/* Retrieve the variable and name at that index */
-			VarBinding* var = scp->vars[i];
-			char* currentVarName = GetVarName(var);
-
-			/* Compare names */
-			if(strcmp(varName, currentVarName) == 0){
-				/* If they are the same, update the value and exit */
-				var->val = val;
-				return;	
-			}
+	/* If the variable has a slot, update it */
+	int slot = FindSlot(scp, varName);
+	if(slot >= 0){
+		WatchBinding(varName, val);
+		StoreSlot(scp, slot, val);
+		return;
+	}
+
+	/* Otherwise, add it; frames can't grow, so their extra variables go in the overflow scope (closures are
+	 * only ever set through the variables they captured, so they never get here) */
+	if(scp->kind == SCOPE_FRAME){
+		if(scp->overflow == NULL){
+			scp->overflow = CreateScope();
 		}
-	}	
+		SetVariable(scp->overflow, varName, val);
+	}else if(scp->kind == SCOPE_ORDINARY){
+		AddVariable(scp, varName, val);
+	}
 }
 
 /* Print the contents of a scope to stdout */
@@ -76,62 +142,243 @@ void PrintScopeContents(Scope* scp){
 	int i;
 	printf("\n--- Scope Contents ---\n");
 	if(scp->size == 0) {
-		printf("No values in scope.");  
+		printf("No values in scope.");
 	}
 	else{
 		for(i = 0; i < scp->size; i++){
-			printf("Variable: %s - %d\n", scp->vars[i]->name, ObjType(scp->vars[i]->val));
+			if(SlotValue(scp, i) >= 0){
+				printf("Variable: %s - %d\n", scp->names[i], ObjType(SlotValue(scp, i)));
+			}
 		}
 	}
 }
 
-/* Merge two scopes (both old scopes are unchanged) */
-Scope* MergeScopes(Scope* one, Scope* two){
-	Scope* new = CreateScope();
+/* Destroy an ordinary scope and free used memory */
+void DeleteScope(Scope* scp){
+	if(scp != NULL){
+		/* Free the names */
+		int i;
+		for(i = 0; i < scp->size; i++){
+			free(scp->names[i]);
+		}
 
-	int i;
+		/* Free the arrays and the scope itself */
+		free(scp->names);
+		free(scp->values);
+		free(scp);
+	}
+}
+
+/***** Function frames *****/
 
-	/* Add the variables from scope one */
-	if(one != NULL){
-		for(i = 0; i < one->size; i++){
-			AddVariable(new, one->vars[i]); 
+/* Add a name to a list of names if it isn't there yet */
+void AddUniqueName(char*** names, int* numNames, int* capacity, char* name){
+	int i;
+	for(i = 0; i < *numNames; i++){
+		if(strcmp((*names)[i], name) == 0){
+			return;
 		}
 	}
 
-	/* And variables from scope two */
-	if(two != NULL){
-		for(i = 0; i < two->size; i++){
-			AddVariable(new, two->vars[i]); 
+	if(*numNames == *capacity){
+		*capacity = (*capacity == 0) ? 8 : *capacity * 2;
+		*names = realloc(*names, sizeof(char*) * *capacity);
+	}
+	(*names)[(*numNames)++] = name;
+}
+
+/* Find the variables which some code sets (not counting code in nested functions or quotes, which isn't run by this function) */
+void CollectSetTargets(VyParseTree* tree, char*** names, int* numNames, int* capacity){
+	if(tree->type != TREE_LIST || ListTreeSize(tree) == 0){
+		return;
+	}
+
+	int i = 0;
+	VyParseTree* head = GetListData(tree, 0);
+	if(head->type == TREE_IDENT){
+		char* keyword = GetStrData(head);
+		if(StrEquals(keyword, "lambda") || StrEquals(keyword, "mambda")
+				|| StrEquals(keyword, "quote") || StrEquals(keyword, "quote-substitutions")){
+			return;
+		}
+
+		/* Record the target of a set (or the variable of a loop), then look through the rest */
+		if((StrEquals(keyword, "set") || StrEquals(keyword, "for-range") || StrEquals(keyword, "for-each"))
+				&& ListTreeSize(tree) > 1 && GetListData(tree, 1)->type == TREE_IDENT){
+			AddUniqueName(names, numNames, capacity, GetStrData(GetListData(tree, 1)));
+			i = 2;
 		}
 	}
 
-	return new;
+	for(; i < ListTreeSize(tree); i++){
+		CollectSetTargets(GetListData(tree, i), names, numNames, capacity);
+	}
 }
 
-/* Destroy the scope and free used memory */
-void DeleteScope(Scope* scp){
-	if(scp != NULL){
-		/* Delete all the variables */
+/* Find every identifier in some code, including code in nested functions and quotes (which may need to be captured) */
+void CollectIdentifiers(VyParseTree* tree, char*** names, int* numNames, int* capacity){
+	if(tree->type == TREE_IDENT){
+		AddUniqueName(names, numNames, capacity, GetStrData(tree));
+	}
+	else if(tree->type == TREE_LIST){
 		int i;
-		for(i = 0; i < scp->size; i++){
-			DeleteVariable(scp->vars[i]);   
+		for(i = 0; i < ListTreeSize(tree); i++){
+			CollectIdentifiers(GetListData(tree, i), names, numNames, capacity);
 		}
+	}
+	else if(tree->type == TREE_REF){
+		CollectIdentifiers(GetObj(tree), names, numNames, capacity);
+		CollectIdentifiers(GetRef(tree), names, numNames, capacity);
+	}
+}
 
-		/* Free the array of variables */
-		free(scp->vars);
+/* Find a function's frame layout, computing it the first time and caching it on the function's code */
+FrameLayout* GetFrameLayout(VyParseTree* code, Argument** args, int numArgs){
+	FrameLayout* layout = GetTreeCache(code);
+	if(layout != NULL){
+		return layout;
+	}
 
-		/* Delete the scope itself */
-		free(scp);
+	/* The parameters come first, in the same order as the arguments (their names are already distinct) */
+	int capacity = numArgs + 8;
+	char** names = malloc(sizeof(char*) * capacity);
+	int numNames = 0;
+	int i;
+	for(i = 0; i < numArgs; i++){
+		names[numNames++] = (args[i]->name != NULL) ? args[i]->name : "";
+	}
+
+	/* Then the variables set in the body */
+	for(i = 2; i < ListTreeSize(code); i++){
+		CollectSetTargets(GetListData(code, i), &names, &numNames, &capacity);
+	}
+
+	/* The free names are all the identifiers in the body except the parameters (the variables it sets may still
+	 * be read from outside before they are set) */
+	char** identifiers = NULL;
+	int numIdentifiers = 0;
+	int identifierCapacity = 0;
+	for(i = 2; i < ListTreeSize(code); i++){
+		CollectIdentifiers(GetListData(code, i), &identifiers, &numIdentifiers, &identifierCapacity);
+	}
+
+	/* A slot named like an inline builtin shadows it */
+	for(i = 0; i < numNames; i++){
+		WatchBinding(names[i], -1);
+	}
+
+	layout = malloc(sizeof(FrameLayout) + sizeof(char*) * (numNames + numIdentifiers));
+	layout->numSlots = numNames;
+	layout->numFree = 0;
+	memcpy(layout->names, names, sizeof(char*) * numNames);
+	for(i = 0; i < numIdentifiers; i++){
+		int param;
+		for(param = 0; param < numArgs; param++){
+			if(strcmp(identifiers[i], names[param]) == 0){
+				break;
+			}
+		}
+		if(param == numArgs){
+			layout->names[numNames + layout->numFree++] = identifiers[i];
+		}
 	}
+	free(identifiers);
+	free(names);
 
+	SetTreeCache(code, layout);
+	return layout;
 }
 
-/***** Dealing with program scopes *****/
-Scope* globalScope;
-Scope* currentFunctionScope;
-Scope* localScope;
+/* The frame stack, and the index of its first free slot */
+__thread VyObject* frameStack;
+__thread int frameStackTop = 0;
+
+/* Set up a frame with all its variables unbound */
+int PushFrame(Scope* frame, FrameLayout* layout, Scope* parent){
+	if(frameStackTop + layout->numSlots > FRAME_STACK_SIZE){
+		return 0;
+	}
+
+	frame->names = layout->names;
+	frame->values = frameStack + frameStackTop;
+	frame->size = frame->capacity = layout->numSlots;
+	frame->kind = SCOPE_FRAME;
+	frame->overflow = NULL;
+	frame->parent = parent;
+	frameStackTop += layout->numSlots;
+
+	int i;
+	for(i = 0; i < layout->numSlots; i++){
+		frame->values[i] = -1;
+	}
+
+	return 1;
+}
+
+/* Give the frame's slots back to the stack (captured variables live on in their cells) */
+void PopFrame(Scope* frame){
+	DeleteScope(frame->overflow);
+	frameStackTop = frame->values - frameStack;
+}
 
-ScopeStack* functionScopes;
+/* Copy the values in the frames of the calls in progress, reading boxed slots from their cells */
+VyObject* GetFrameValues(int* numValues){
+	VyObject* values = malloc(sizeof(VyObject) * (frameStackTop + 1));
+	int i;
+	for(i = 0; i < frameStackTop; i++){
+		values[i] = IS_BOXED(frameStack[i]) ? cells[CELL_OF(frameStack[i])] : frameStack[i];
+	}
+	*numValues = frameStackTop;
+	return values;
+}
+
+/***** Closures *****/
+
+/* Box the variable in a slot (if it isn't boxed yet), so that the slot and the closures capturing it share a cell */
+VyObject BoxSlot(Scope* scp, int slot){
+	if(!IS_BOXED(scp->values[slot])){
+		scp->values[slot] = BOX_OF(CreateCell(scp->values[slot]));
+	}
+	return scp->values[slot];
+}
+
+/* Find the variable a closure created in a frame would see under a name, and return its box (or -1 if the name
+ * isn't a variable of the frame or of its closure). A slot the frame hasn't set yet is captured only if no bound
+ * variable is found, so that a function can still refer to itself through a variable set after it is created. */
+VyObject CaptureVariable(Scope* frame, char* name){
+	Scope* scopes[] = {frame, frame->overflow, frame->parent};
+	Scope* unboundScope = NULL;
+	int unboundSlot = -1;
+
+	int i;
+	for(i = 0; i < 3; i++){
+		if(scopes[i] == NULL){
+			continue;
+		}
+
+		int slot = FindSlot(scopes[i], name);
+		if(slot < 0){
+			continue;
+		}
+
+		if(SlotValue(scopes[i], slot) >= 0){
+			return BoxSlot(scopes[i], slot);
+		}
+		if(unboundScope == NULL){
+			unboundScope = scopes[i];
+			unboundSlot = slot;
+		}
+	}
+
+	if(unboundScope != NULL){
+		return BoxSlot(unboundScope, unboundSlot);
+	}
+	return -1;
+}
+
+/***** Dealing with program scopes *****/
+__thread Scope* globalScope;
+__thread Scope* localScope;
 
 /* Inititialize all the scopes */
 void InitScopes(){
@@ -141,67 +388,119 @@ void InitScopes(){
 	/* Before any functions are called, the global scope IS the local scope */
 	localScope = globalScope;
 
-	/* Create a scope stack for the functions */
-	functionScopes = CreateScopeStack();
-
+	/* Create the frame stack */
+	frameStack = malloc(sizeof(VyObject) * FRAME_STACK_SIZE);
 }
 
 /* Return the global scope */
 Scope* GetGlobalScope(){
-	return globalScope; 
-}
-
-/* Manipulate the scope stack */
-void PushScope(Scope* scp){
-	Push(functionScopes, scp);  
-}
-
-Scope* PopScope(){
-	return Pop(functionScopes);
+	return globalScope;
 }
 
 /* Return the local scope */
 Scope* GetLocalScope(){
-	return localScope;  
-}
-
-/* Return the current function scope */
-Scope* GetCurrentFunctionScope(){
-	return currentFunctionScope;	
-}
-
-/* Set the current function scope */
-void SetCurrentFunctionScope(Scope* scp){
-	currentFunctionScope = scp; 
+	return localScope;
 }
 
 /* Set the local scope */
 void SetLocalScope(Scope* scp){
-	localScope = scp;   
+	localScope = scp;
 }
 
-/* Find a variable in the currently accessible scopes - that is, local, global, and closure scope */
-VyObject FindObjAllScopes(char* name){
-	/* Try looking for the object in the local scope */
-	VyObject obj = FindValue(GetLocalScope(), name);
-	if(obj >= 0){
-		return obj; 
+/* Create the closure of a function created in the local scope: a record of the variables it uses from the local
+ * frame (top level functions, and functions which capture nothing, have no closure) */
+Scope* CaptureClosure(FrameLayout* layout){
+	if(localScope == globalScope || layout->numFree == 0){
+		return NULL;
 	}
 
-	/* If not found, try function scope */
-	obj = FindValue(GetCurrentFunctionScope(), name);
-	if(obj >= 0){
-		return obj; 
+	/* Find the captured variables in the scratch region first, since most free names are usually global */
+	VyRegion* scratch = GetScratchRegion();
+	RegionMark mark = MarkRegion(scratch);
+	char** names = RegionAlloc(scratch, sizeof(char*) * layout->numFree);
+	VyObject* boxes = RegionAlloc(scratch, sizeof(VyObject) * layout->numFree);
+	int numCaptured = 0;
+
+	int i;
+	for(i = 0; i < layout->numFree; i++){
+		char* name = layout->names[layout->numSlots + i];
+		VyObject box = CaptureVariable(localScope, name);
+		if(box != -1){
+			names[numCaptured] = name;
+			boxes[numCaptured] = box;
+			numCaptured++;
+		}
 	}
 
-	/* If still not found, try global scope */
-	obj = FindValue(GetGlobalScope(), name);
-	if(obj >= 0){
-		return obj; 
+	/* Then copy them into a single block (the names belong to the function's layout) */
+	Scope* closure = NULL;
+	if(numCaptured > 0){
+		closure = malloc(sizeof(Scope) + (sizeof(char*) + sizeof(VyObject)) * numCaptured);
+		closure->names = (char**)(closure + 1);
+		closure->values = (VyObject*)(closure->names + numCaptured);
+		memcpy(closure->names, names, sizeof(char*) * numCaptured);
+		memcpy(closure->values, boxes, sizeof(VyObject) * numCaptured);
+		closure->size = closure->capacity = numCaptured;
+		closure->kind = SCOPE_CLOSURE;
+		closure->overflow = NULL;
+		closure->parent = NULL;
 	}
 
-	/* If it wasn't found at all, return NULL */
-	return -1;
+	ReleaseRegion(scratch, mark);
+	return closure;
+}
 
+/* Find the global scope or module scope a variable is bound in */
+Scope* FindGlobalScope(char* name){
+	if(FindValue(GetGlobalScope(), name) >= 0){
+		return GetGlobalScope();
+	}
+	return FindModuleScope(name);
 }
 
+/* Find the scope a variable is bound in - that is, the local frame, the closure of its function, the namespace of
+ * the module the code is from (if it has one), the global scope, or another module scope */
+Scope* FindVariableScope(char* name, Scope* own){
+	Scope* scp;
+	if(GetLocalScope() != GetGlobalScope()){
+		for(scp = GetLocalScope(); scp != NULL; scp = scp->parent){
+			if(FindValue(scp, name) >= 0){
+				return scp;
+			}
+		}
+	}
+
+	if(own != NULL && FindValue(own, name) >= 0){
+		return own;
+	}
+	return FindGlobalScope(name);
+}
+
+/* Find a variable in the currently accessible scopes */
+VyObject FindObjAllScopes(char* name, Scope* own){
+	/* Try looking for the object in the local frame and the closure of its function (unless the global scope is
+	 * the local scope, since a module's own names come before the global ones) */
+	Scope* scp;
+	if(GetLocalScope() != GetGlobalScope()){
+		for(scp = GetLocalScope(); scp != NULL; scp = scp->parent){
+			VyObject obj = FindValue(scp, name);
+			if(obj >= 0){
+				return obj;
+			}
+		}
+	}
+
+	/* If still not found, try the namespace of the module the code is from, the global scope, and then the
+	 * other modules */
+	if(own != NULL){
+		VyObject obj = FindValue(own, name);
+		if(obj >= 0){
+			return obj;
+		}
+	}
+	VyObject obj = FindValue(GetGlobalScope(), name);
+	if(obj >= 0){
+		return obj;
+	}
+	return FindValue(FindModuleScope(name), name);
+}
@@ -0,0 +1,112 @@
+#include "Vyion.h"
+
+/* Get the time */
+long MonotonicNanoseconds(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/* Write the allocation counters */
+int WriteMemoryStats(char* filename){
+	FILE* file = fopen(filename, "w");
+	if(file == NULL){
+		return 0;
+	}
+
+	VyMemHeap* heap = GetMemoryHeap();
+	fprintf(file, "{\"objects\": %ld, \"bytes\": %ld, \"collections\": %ld}\n",
+			heap->objectsAllocated, heap->bytesAllocated, heap->collections);
+	return fclose(file) == 0;
+}
+
+/* Time an expression */
+VyObject EvalTime(VyParseTree* tr){
+	if(ListTreeSize(tr) != 2){
+		return ToObject(CreateError("Time takes one expression.", tr));
+	}
+
+	VyMemHeap* heap = GetMemoryHeap();
+	long objects = heap->objectsAllocated;
+	long bytes = heap->bytesAllocated;
+	long collections = heap->collections;
+	long start = MonotonicNanoseconds();
+
+	VyObject val = Eval(GetListData(tr, 1));
+
+	long elapsed = MonotonicNanoseconds() - start;
+	if(ObjType(val) == VALERROR){
+		return val;
+	}
+
+	/* (The heap may have moved, but the heap structure doesn't) */
+	fprintf(stderr, "time: %ld ns, %ld objects (%ld bytes), %ld collections\n", elapsed,
+			heap->objectsAllocated - objects, heap->bytesAllocated - bytes, heap->collections - collections);
+	return val;
+}
+
+/* Compare times */
+int CompareTimes(const void* a, const void* b){
+	long diff = *(long*) a - *(long*) b;
+	return (diff > 0) - (diff < 0);
+}
+
+/* Benchmark an expression */
+VyObject EvalBench(VyParseTree* tr){
+	if(ListTreeSize(tr) != 3){
+		return ToObject(CreateError("Bench takes an expression and a number of iterations.", tr));
+	}
+
+	VyObject count = Eval(GetListData(tr, 2));
+	if(ObjType(count) == VALERROR){
+		return count;
+	}
+	VyNumber** num = (ObjType(count) == VALNUM) ? ObjData(count) : NULL;
+	if(num == NULL || num[0]->type != INT || GetInt(num) <= 0){
+		return ToObject(CreateError("The number of iterations must be a positive integer.", GetListData(tr, 2)));
+	}
+
+	int iterations = GetInt(num);
+	int warmup = (iterations / 10 > 0) ? iterations / 10 : 1;
+	VyParseTree* expr = GetListData(tr, 1);
+
+	int i;
+	for(i = 0; i < warmup; i++){
+		VyObject val = Eval(expr);
+		if(ObjType(val) == VALERROR){
+			return val;
+		}
+	}
+
+	VyMemHeap* heap = GetMemoryHeap();
+	long objects = heap->objectsAllocated;
+	long bytes = heap->bytesAllocated;
+	long collections = heap->collections;
+
+	long* times = malloc(sizeof(long) * iterations);
+	long total = 0;
+	for(i = 0; i < iterations; i++){
+		long start = MonotonicNanoseconds();
+		VyObject val = Eval(expr);
+		times[i] = MonotonicNanoseconds() - start;
+		total += times[i];
+
+		if(ObjType(val) == VALERROR){
+			free(times);
+			return val;
+		}
+	}
+
+	qsort(times, iterations, sizeof(long), &CompareTimes);
+	long mean = total / iterations;
+	long median = (iterations % 2 == 1) ? times[iterations / 2] : (times[iterations / 2 - 1] + times[iterations / 2]) / 2;
+	long p99 = times[(iterations * 99 + 99) / 100 - 1];
+	free(times);
+
+	fprintf(stderr, "bench: %d iterations (after %d to warm up): mean %ld ns, median %ld ns, p99 %ld ns; "
+			"per iteration %.1f objects (%.1f bytes), %.3f collections\n", iterations, warmup, mean, median, p99,
+			(double)(heap->objectsAllocated - objects) / iterations, (double)(heap->bytesAllocated - bytes) / iterations,
+			(double)(heap->collections - collections) / iterations);
+
+	return ToObject(CreateInteger(mean));
+}
@@ -0,0 +1,173 @@
+#include "Vyion.h"
+
+/* The number of events each thread's ring buffer holds */
+#define TRACE_BUFFER_SIZE (1024*1024)
+
+/* An event */
+typedef struct {
+	int kind;
+	void* subject;
+	long number;
+
+	/* In nanoseconds */
+	long start;
+	long duration;
+} TraceEvent;
+
+/* A thread's ring buffer: the next event is written at (written % TRACE_BUFFER_SIZE) */
+typedef struct TraceBuffer {
+	int thread;
+	long written;
+	TraceEvent* events;
+
+	/* The next buffer, in the list of all of them */
+	struct TraceBuffer* next;
+} TraceBuffer;
+
+/* Whether the tracer is on, and the file the events go to */
+int tracing = 0;
+char* traceFile = NULL;
+
+/* The buffers of all threads (added to without locks), and the number of the next thread to get one */
+TraceBuffer* traceBuffers = NULL;
+int nextTraceThread = 0;
+
+/* The buffer of this thread */
+__thread TraceBuffer* traceBuffer = NULL;
+
+/* Give this thread its buffer */
+TraceBuffer* CreateTraceBuffer(){
+	TraceBuffer* buffer = malloc(sizeof(TraceBuffer));
+	buffer->thread = __atomic_fetch_add(&nextTraceThread, 1, __ATOMIC_RELAXED);
+	buffer->written = 0;
+	buffer->events = malloc(sizeof(TraceEvent) * TRACE_BUFFER_SIZE);
+
+	buffer->next = __atomic_load_n(&traceBuffers, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&traceBuffers, &buffer->next, buffer, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)){
+	}
+	return buffer;
+}
+
+/* Get the start time of a span */
+long TraceStart(){
+	return tracing ? MonotonicNanoseconds() : 0;
+}
+
+/* Record a span which has ended */
+void TraceEnd(int kind, void* subject, long number, long start){
+	if(!tracing){
+		return;
+	}
+
+	long end = MonotonicNanoseconds();
+	if(traceBuffer == NULL){
+		traceBuffer = CreateTraceBuffer();
+	}
+
+	TraceEvent* event = &traceBuffer->events[traceBuffer->written % TRACE_BUFFER_SIZE];
+	event->kind = kind;
+	event->subject = subject;
+	event->number = number;
+	event->start = start;
+	event->duration = end - start;
+	traceBuffer->written++;
+}
+
+/***** Writing the trace *****/
+
+/* The categories of the kinds of events */
+char* traceCategories[] = {"call", "macro", "gc", "form", "file"};
+
+/* Write a string as a JSON string */
+void WriteJSONString(FILE* file, char* str){
+	fputc('"', file);
+	for(; *str != '\0'; str++){
+		if(*str == '"' || *str == '\\'){
+			fputc('\\', file);
+			fputc(*str, file);
+		}
+		else if((unsigned char) *str < ' '){
+			fprintf(file, "\\u%04x", *str);
+		}
+		else{
+			fputc(*str, file);
+		}
+	}
+	fputc('"', file);
+}
+
+/* Write an event (times are in microseconds, relative to the first event) */
+void WriteTraceEvent(FILE* file, TraceEvent* event, int thread, long origin){
+	char* name;
+	char* argument = NULL;
+	if(event->kind == TRACE_CALL || event->kind == TRACE_MACRO){
+		name = NameFunction(event->subject);
+	}else if(event->kind == TRACE_FILE){
+		name = event->subject;
+	}else if(event->kind == TRACE_GC){
+		name = "collect";
+		argument = "heapSize";
+	}else{
+		name = "form";
+		argument = "line";
+	}
+
+	fprintf(file, "{\"name\":");
+	WriteJSONString(file, name);
+	fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+			traceCategories[event->kind], (event->start - origin) / 1000.0, event->duration / 1000.0, thread);
+	if(argument != NULL){
+		fprintf(file, ",\"args\":{\"%s\":%ld}", argument, event->number);
+	}
+	fprintf(file, "}");
+}
+
+/* Stop tracing, and write the events of all threads, oldest first */
+void StopTracer(){
+	if(!tracing){
+		return;
+	}
+	tracing = 0;
+
+	FILE* file = fopen(traceFile, "w");
+	if(file == NULL){
+		fprintf(stderr, "Couldn't write the trace to \"%s\".\n", traceFile);
+		return;
+	}
+
+	/* The first event is the one which started first (the events are in order of when they ended) */
+	long origin = LONG_MAX;
+	TraceBuffer* buffer;
+	long i;
+	for(buffer = traceBuffers; buffer != NULL; buffer = buffer->next){
+		long first = (buffer->written > TRACE_BUFFER_SIZE) ? buffer->written - TRACE_BUFFER_SIZE : 0;
+		for(i = first; i < buffer->written; i++){
+			long start = buffer->events[i % TRACE_BUFFER_SIZE].start;
+			origin = (start < origin) ? start : origin;
+		}
+	}
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	int firstEvent = 1;
+	for(buffer = traceBuffers; buffer != NULL; buffer = buffer->next){
+		long first = (buffer->written > TRACE_BUFFER_SIZE) ? buffer->written - TRACE_BUFFER_SIZE : 0;
+		for(i = first; i < buffer->written; i++){
+			if(!firstEvent){
+				fprintf(file, ",\n");
+			}
+			firstEvent = 0;
+			WriteTraceEvent(file, &buffer->events[i % TRACE_BUFFER_SIZE], buffer->thread, origin);
+		}
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(file);
+}
+
+/* Start tracing */
+void StartTracer(char* filename){
+	traceFile = filename;
+	tracing = 1;
+
+	/* The events are also written if the program exits early */
+	atexit(&StopTracer);
+}
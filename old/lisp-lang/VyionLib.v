@@ -12,34 +12,14 @@
 (function append (list &(body)) [$@list $@body])
 (function front (list &(body)) [$@body $@list])
 
-|{ Define a temporary infix system, which, although simple, can still be useful }|
-(macro infix (expr) [$(nth expr 1) $(nth expr 0) $(nth expr 2)])
+|{ Infix expressions in {braces} are rewritten by the interpreter, which knows the operators = != < > <= >= + - * / **
+   and any defined with (def-operator 'symbol precedence); anything else in operator position is just called }|
 
 |{ Increment and decrement macros }|
 (macro inc(n) [set $n {$n + 1}])
 (macro dec(n) [set $n {$n - 1}])
 
-|{ Implement the looping macros while and for }|
-(macro while(condition &(body))
-	(set symb (unique))
-	[tagbody ($symb (if $condition ($@body (go $symb))))])
-
-(macro for-each(var-name lst &(body))
-	(set i (unique))
-	(set eval-list (unique))
-	(set size (unique))
-
-	[
-	(set $eval-list $lst)
-	(set $size (len $eval-list))
-	(set $i 0)
-	(while {$i < $size}
-		(set $var-name (nth $eval-list $i))
-		$@body
-		(inc $i)
-	)
-	]
-)
+|{ The loops while, loop, for-range and for-each are built into the interpreter }|
 
 
 |{ Define the short circuiting boolean operators }|
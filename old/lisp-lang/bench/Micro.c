@@ -0,0 +1,355 @@
+#include "Vyion.h"
+#include <math.h>
+
+/* The microbenchmarks time the interpreter's primitives on their own, linked directly against its object files:
+ *     microbench [-t ms] [-o output.json] [-l label] [name...]
+ *
+ * Each primitive is timed at a range of sizes (the size of the allocation, the number of variables in the scope,
+ * the length of the list, and so on), and reported in nanoseconds per operation. The scaling is the slope of
+ * log(ns/op) against log(size): about 0 means the time doesn't depend on the size, about 1 means it is linear,
+ * and about 2 quadratic. Given names, only the benchmarks whose names contain one of them are run.
+ *
+ * Each measurement starts from a fresh heap (so that what earlier measurements allocated isn't copied by the
+ * collections in later ones). The number of iterations is doubled until a run takes at least the target time
+ * (or until a benchmark's limit on the work it may do, which keeps the ones that allocate from filling memory),
+ * and the result is the fastest of a few runs of that many iterations.
+ */
+
+/* A benchmark: the work it does per iteration is proportional to the size, and is at most workLimit
+ * (size * iterations) in a run, if that isn't 0 */
+typedef struct {
+	char* name;
+	char* sizeName;
+	int sizes[12];
+	long workLimit;
+	void (*setup)(int);
+	void (*run)(int, long);
+} MicroBenchmark;
+
+/* The result of timing a benchmark at a size */
+typedef struct {
+	int size;
+	long iterations;
+	double nsPerOp;
+} MicroResult;
+
+/* Results are added here, so that the compiler can't leave out the work */
+volatile long sink;
+
+/* Start from a fresh heap */
+void FreshHeap(){
+	FreeHeap(GetMemoryHeap());
+	InitMem();
+}
+
+/***** The benchmarks *****/
+
+/* VyMallocate() of a number of bytes */
+void RunMallocate(int size, long iterations){
+	VyMemHeap* heap = GetMemoryHeap();
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += (long) VyMallocate(size, heap);
+	}
+}
+
+/* CreateObj(), with a number of objects already on the heap (for the collections to copy) */
+void SetupCreateObj(int size){
+	int i;
+	for(i = 0; i < size; i++){
+		CreateObj(VALNUM);
+	}
+}
+void RunCreateObj(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += CreateObj(VALNUM);
+	}
+}
+
+/* ObjType() and ObjData() on a number of objects in turn */
+void RunObjTypeData(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		VyObject obj = i % size;
+		sink += ObjType(obj) + (long) ObjData(obj);
+	}
+}
+
+/* The scope the FindValue() benchmarks look in, with the names of its variables */
+Scope* benchScope = NULL;
+char benchNames[4096][24];
+
+/* A scope with a number of variables */
+void SetupScope(int size){
+	DeleteScope(benchScope);
+	benchScope = CreateScope();
+
+	int i;
+	for(i = 0; i < size; i++){
+		snprintf(benchNames[i], sizeof(benchNames[i]), "variable-%d", i);
+		AddVariable(benchScope, benchNames[i], ToObject(CreateInt(i)));
+	}
+}
+
+/* FindValue() of the last variable in the scope, and of a variable that isn't there */
+void RunFindValueHit(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += FindValue(benchScope, benchNames[size - 1]);
+	}
+}
+void RunFindValueMiss(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += FindValue(benchScope, "not-a-variable");
+	}
+}
+
+/* The list the list benchmarks work on */
+VyList** benchList = NULL;
+
+/* A list of a number of elements */
+void SetupList(int size){
+	benchList = CreateList();
+	VyList** last = benchList;
+	int i;
+	for(i = 0; i < size; i++){
+		last = ListBuildAppend(last, ToObject(CreateInt(i)));
+	}
+}
+
+/* ListAppend() to the list, ListGet() of its last element, and ListSize() */
+void RunListAppend(int size, long iterations){
+	VyObject element = ToObject(CreateInt(0));
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += (long) ListAppend(benchList, element);
+	}
+}
+void RunListGet(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += ListGet(benchList, size - 1);
+	}
+}
+void RunListSize(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += ListSize(benchList);
+	}
+}
+
+/* The source the lexer benchmark lexes */
+char* benchSource = NULL;
+
+/* Source made of a number of copies of a small definition */
+void SetupSource(int size){
+	char* form = "(defun fact (n) (if (< n 2) 1 {n * (fact {n - 1})})) ; a comment\n\"a string\" 'quoted 3.25 ";
+	int length = strlen(form);
+
+	free(benchSource);
+	benchSource = malloc(length * size + 1);
+	int i;
+	for(i = 0; i < size; i++){
+		memcpy(benchSource + i * length, form, length);
+	}
+	benchSource[length * size] = '\0';
+}
+
+/* Lex() the source (and clean up after it) */
+void RunLex(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		Lex(benchSource);
+		sink += GetNumTokens();
+		CleanLexer();
+	}
+}
+
+/* The number the number parsing benchmark parses */
+char benchDigits[1025];
+
+/* A number with a number of digits */
+void SetupDigits(int size){
+	int i;
+	for(i = 0; i < size; i++){
+		benchDigits[i] = '1' + i % 9;
+	}
+	benchDigits[size] = '\0';
+}
+
+/* ParseNumber() of the digits */
+void RunParseNumber(int size, long iterations){
+	long i;
+	for(i = 0; i < iterations; i++){
+		sink += (long) ParseNumber(benchDigits, size);
+	}
+}
+
+MicroBenchmark benchmarks[] = {
+	{"vymallocate", "bytes", {8, 32, 128, 512, 2048}, 64L << 20, NULL, &RunMallocate},
+	{"createobj", "live objects", {1, 1024, 16384, 262144}, 0, &SetupCreateObj, &RunCreateObj},
+	{"objtype-objdata", "objects", {16, 1024, 65536, 262144}, 0, &SetupCreateObj, &RunObjTypeData},
+	{"findvalue-hit", "variables", {1, 4, 16, 64, 256, 1024, 4096}, 0, &SetupScope, &RunFindValueHit},
+	{"findvalue-miss", "variables", {1, 4, 16, 64, 256, 1024, 4096}, 0, &SetupScope, &RunFindValueMiss},
+	{"listappend", "elements", {1, 4, 16, 64, 256, 1024, 4096}, 1L << 20, &SetupList, &RunListAppend},
+	{"listget", "elements", {1, 4, 16, 64, 256, 1024, 4096}, 0, &SetupList, &RunListGet},
+	{"listsize", "elements", {1, 4, 16, 64, 256, 1024, 4096}, 0, &SetupList, &RunListSize},
+	{"lex", "forms", {1, 4, 16, 64, 256, 1024}, 0, &SetupSource, &RunLex},
+	{"parsenumber", "digits", {1, 4, 16, 64, 256, 1024}, 16L << 20, &SetupDigits, &RunParseNumber},
+	{NULL}
+};
+
+/***** Timing *****/
+
+/* Time a run of a benchmark at a size, from a fresh heap, in nanoseconds */
+long TimeRun(MicroBenchmark* bench, int size, long iterations){
+	FreshHeap();
+	if(bench->setup != NULL){
+		bench->setup(size);
+	}
+
+	long start = MonotonicNanoseconds();
+	bench->run(size, iterations);
+	return MonotonicNanoseconds() - start;
+}
+
+/* Time a benchmark at a size */
+MicroResult Measure(MicroBenchmark* bench, int size, long targetNs){
+	long maxIterations = (bench->workLimit > 0) ? bench->workLimit / size : -1;
+	if(maxIterations == 0){
+		maxIterations = 1;
+	}
+
+	/* Find how many iterations take long enough */
+	long iterations = 1;
+	while(TimeRun(bench, size, iterations) < targetNs && iterations != maxIterations){
+		iterations *= 2;
+		if(maxIterations > 0 && iterations > maxIterations){
+			iterations = maxIterations;
+		}
+	}
+
+	/* Then take the fastest of a few runs */
+	long best = -1;
+	int run;
+	for(run = 0; run < 3; run++){
+		long ns = TimeRun(bench, size, iterations);
+		if(best < 0 || ns < best){
+			best = ns;
+		}
+	}
+
+	MicroResult result = {size, iterations, (double) best / iterations};
+	return result;
+}
+
+/* The slope of the log of the time against the log of the size (a least squares fit) */
+double Scaling(MicroResult* results, int numResults){
+	double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+	int i;
+	for(i = 0; i < numResults; i++){
+		double x = log(results[i].size);
+		double y = log(results[i].nsPerOp > 0 ? results[i].nsPerOp : 1e-3);
+		sumX += x;
+		sumY += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+
+	double denominator = numResults * sumXX - sumX * sumX;
+	return (denominator != 0) ? (numResults * sumXY - sumX * sumY) / denominator : 0;
+}
+
+/* Whether a benchmark was asked for */
+int Selected(MicroBenchmark* bench, char** names, int numNames){
+	int i;
+	for(i = 0; i < numNames; i++){
+		if(strstr(bench->name, names[i]) != NULL){
+			return 1;
+		}
+	}
+	return numNames == 0;
+}
+
+int main(int argc, char** argv){
+	double targetMs = 20;
+	char* output = NULL;
+	char* label = "";
+
+	int arg = 1;
+	while(arg + 1 < argc && argv[arg][0] == '-'){
+		if(StrEquals(argv[arg], "-t")){
+			targetMs = atof(argv[arg + 1]);
+		}else if(StrEquals(argv[arg], "-o")){
+			output = argv[arg + 1];
+		}else if(StrEquals(argv[arg], "-l")){
+			label = argv[arg + 1];
+		}else{
+			break;
+		}
+		arg += 2;
+	}
+	if(arg < argc && argv[arg][0] == '-'){
+		fprintf(stderr, "Usage: %s [-t ms] [-o output.json] [-l label] [name...]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* file = NULL;
+	if(output != NULL){
+		file = fopen(output, "w");
+		if(file == NULL){
+			fprintf(stderr, "Couldn't write the results to \"%s\".\n", output);
+			return 1;
+		}
+		fprintf(file, "{\n  \"label\": ");
+		WriteJSONString(file, label);
+		fprintf(file, ",\n  \"benchmarks\": [");
+	}
+
+	InitEvaluator();
+
+	printf("%-16s %-21s %12s %12s\n", "benchmark", "size", "ns/op", "iterations");
+	int numWritten = 0;
+	MicroBenchmark* bench;
+	for(bench = benchmarks; bench->name != NULL; bench++){
+		if(!Selected(bench, argv + arg, argc - arg)){
+			continue;
+		}
+
+		MicroResult results[12];
+		int numResults;
+		for(numResults = 0; numResults < 12 && bench->sizes[numResults] > 0; numResults++){
+			results[numResults] = Measure(bench, bench->sizes[numResults], (long) (targetMs * 1000000));
+			printf("%-16s %8d %-12s %12.1f %12ld\n", bench->name, results[numResults].size, bench->sizeName,
+					results[numResults].nsPerOp, results[numResults].iterations);
+			fflush(stdout);
+		}
+		double scaling = Scaling(results, numResults);
+		printf("%-16s scaling with %s: n^%.2f\n\n", bench->name, bench->sizeName, scaling);
+
+		if(file != NULL){
+			fprintf(file, "%s\n    {\"name\": ", (numWritten > 0) ? "," : "");
+			WriteJSONString(file, bench->name);
+			fprintf(file, ", \"size\": ");
+			WriteJSONString(file, bench->sizeName);
+			fprintf(file, ", \"scaling\": %.3f, \"points\": [", scaling);
+			int i;
+			for(i = 0; i < numResults; i++){
+				fprintf(file, "%s{\"size\": %d, \"ns_per_op\": %.2f, \"iterations\": %ld}", (i > 0) ? ", " : "",
+						results[i].size, results[i].nsPerOp, results[i].iterations);
+			}
+			fprintf(file, "]}");
+			numWritten++;
+		}
+	}
+
+	if(file != NULL){
+		fprintf(file, "\n  ]\n}\n");
+		fclose(file);
+		fprintf(stderr, "Results written to %s\n", output);
+	}
+
+	return 0;
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/* The benchmark runner runs each benchmark program several times with the interpreter, and reports, as JSON,
+ * the median wall time, the peak resident set size (the largest of any run), and the allocation counters
+ * (which the interpreter writes with --stats, and which are the same on every run):
+ *     runner [-n runs] [-o output.json] [-l label] vyion program.v...
+ *
+ * The label (the commit, say) is copied into the output, so that results from different builds can be told apart.
+ * A benchmark which doesn't finish (the interpreter only writes its counters if the program ran to the end) is
+ * reported with "ok": false. A table of the results is also printed to stderr.
+ */
+
+/* The results of a benchmark */
+typedef struct {
+	char* name;
+	int ok;
+	double medianMs;
+	double minMs;
+	double maxMs;
+	long peakRssKb;
+	long objects;
+	long bytes;
+	long collections;
+} BenchResult;
+
+/* Get the time, in milliseconds */
+double NowMs(){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/* Run a program once with the interpreter, with its output thrown away. Returns 0 if it didn't finish. */
+int RunOnce(char* interpreter, char* program, char* statsFile, double* ms, long* rssKb){
+	unlink(statsFile);
+
+	double start = NowMs();
+	pid_t child = fork();
+	if(child < 0){
+		return 0;
+	}
+	if(child == 0){
+		int devNull = open("/dev/null", O_WRONLY);
+		dup2(devNull, 1);
+		execl(interpreter, interpreter, "--stats", statsFile, program, (char*) NULL);
+		_exit(127);
+	}
+
+	int status;
+	struct rusage usage;
+	if(wait4(child, &status, 0, &usage) < 0){
+		return 0;
+	}
+	*ms = NowMs() - start;
+	*rssKb = usage.ru_maxrss;
+
+	return access(statsFile, R_OK) == 0;
+}
+
+/* Read the allocation counters the interpreter wrote */
+int ReadStats(char* statsFile, BenchResult* result){
+	FILE* file = fopen(statsFile, "r");
+	if(file == NULL){
+		return 0;
+	}
+	int read = fscanf(file, " {\"objects\": %ld, \"bytes\": %ld, \"collections\": %ld}",
+			&result->objects, &result->bytes, &result->collections);
+	fclose(file);
+	return read == 3;
+}
+
+/* Compare times */
+int CompareMs(const void* a, const void* b){
+	double diff = *(double*) a - *(double*) b;
+	return (diff > 0) - (diff < 0);
+}
+
+/* Run a benchmark the given number of times */
+BenchResult RunBenchmark(char* interpreter, char* program, int runs, char* statsFile){
+	BenchResult result;
+	memset(&result, 0, sizeof(result));
+
+	/* The name is the file's name without its directory or extension */
+	char* base = strrchr(program, '/');
+	result.name = strdup(base != NULL ? base + 1 : program);
+	char* extension = strrchr(result.name, '.');
+	if(extension != NULL){
+		*extension = '\0';
+	}
+
+	double* times = malloc(sizeof(double) * runs);
+	result.ok = 1;
+	int i;
+	for(i = 0; i < runs && result.ok; i++){
+		long rssKb = 0;
+		result.ok = RunOnce(interpreter, program, statsFile, &times[i], &rssKb) && ReadStats(statsFile, &result);
+		if(rssKb > result.peakRssKb){
+			result.peakRssKb = rssKb;
+		}
+	}
+
+	if(result.ok){
+		qsort(times, runs, sizeof(double), &CompareMs);
+		result.minMs = times[0];
+		result.maxMs = times[runs - 1];
+		result.medianMs = (runs % 2 == 1) ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+	}
+	free(times);
+	return result;
+}
+
+/* Write a string as a JSON string */
+void WriteJSONString(FILE* file, char* str){
+	fputc('"', file);
+	for(; *str != '\0'; str++){
+		if(*str == '"' || *str == '\\'){
+			fputc('\\', file);
+		}
+		fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+/* Write the results */
+void WriteResults(FILE* file, char* label, int runs, BenchResult* results, int numResults){
+	fprintf(file, "{\n  \"label\": ");
+	WriteJSONString(file, label);
+	fprintf(file, ",\n  \"runs\": %d,\n  \"benchmarks\": [\n", runs);
+
+	int i;
+	for(i = 0; i < numResults; i++){
+		BenchResult* r = &results[i];
+		fprintf(file, "    {\"name\": ");
+		WriteJSONString(file, r->name);
+		fprintf(file, ", \"ok\": %s, \"median_ms\": %.3f, \"min_ms\": %.3f, \"max_ms\": %.3f, \"peak_rss_kb\": %ld, "
+				"\"objects\": %ld, \"bytes\": %ld, \"collections\": %ld}%s\n", r->ok ? "true" : "false",
+				r->medianMs, r->minMs, r->maxMs, r->peakRssKb, r->objects, r->bytes, r->collections,
+				(i + 1 < numResults) ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char** argv){
+	int runs = 5;
+	char* output = NULL;
+	char* label = "";
+
+	int arg = 1;
+	while(arg + 1 < argc && argv[arg][0] == '-'){
+		if(strcmp(argv[arg], "-n") == 0){
+			runs = atoi(argv[arg + 1]);
+		}else if(strcmp(argv[arg], "-o") == 0){
+			output = argv[arg + 1];
+		}else if(strcmp(argv[arg], "-l") == 0){
+			label = argv[arg + 1];
+		}else{
+			break;
+		}
+		arg += 2;
+	}
+
+	if(arg + 1 >= argc || runs <= 0){
+		fprintf(stderr, "Usage: %s [-n runs] [-o output.json] [-l label] interpreter program.v...\n", argv[0]);
+		return 1;
+	}
+	char* interpreter = argv[arg++];
+
+	char statsFile[] = "/tmp/vyion-bench-XXXXXX";
+	int statsFd = mkstemp(statsFile);
+	if(statsFd < 0){
+		fprintf(stderr, "Couldn't create a temporary file.\n");
+		return 1;
+	}
+	close(statsFd);
+
+	int numResults = argc - arg;
+	BenchResult* results = malloc(sizeof(BenchResult) * numResults);
+	int failed = 0;
+
+	fprintf(stderr, "%-16s %10s %10s %10s %12s %12s %6s\n", "benchmark", "median ms", "min ms", "rss kb", "objects", "bytes", "gcs");
+	int i;
+	for(i = 0; i < numResults; i++){
+		results[i] = RunBenchmark(interpreter, argv[arg + i], runs, statsFile);
+		BenchResult* r = &results[i];
+		if(r->ok){
+			fprintf(stderr, "%-16s %10.1f %10.1f %10ld %12ld %12ld %6ld\n", r->name, r->medianMs, r->minMs,
+					r->peakRssKb, r->objects, r->bytes, r->collections);
+		}else{
+			fprintf(stderr, "%-16s did not finish\n", r->name);
+			failed = 1;
+		}
+	}
+	unlink(statsFile);
+
+	FILE* file = (output != NULL) ? fopen(output, "w") : stdout;
+	if(file == NULL){
+		fprintf(stderr, "Couldn't write the results to \"%s\".\n", output);
+		return 1;
+	}
+	WriteResults(file, label, runs, results, numResults);
+	if(file != stdout){
+		fclose(file);
+		fprintf(stderr, "Results written to %s\n", output);
+	}
+
+	return failed;
+}
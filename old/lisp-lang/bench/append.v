@@ -0,0 +1,13 @@
+|{ Building lists by appending to them, which copies the list each time }|
+(include 'VyionLib.v)
+
+(function build (n)
+	(set result [])
+	(for-range i 0 n
+		(set result (append result i)))
+	result)
+
+(set total 0)
+(for-range round 0 5
+	(set total (+ total (len (build 600)))))
+(print-line total)
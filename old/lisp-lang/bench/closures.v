@@ -0,0 +1,21 @@
+|{ Creating closures over local variables, and calling them }|
+(include 'VyionLib.v)
+
+(function make-adder (n)
+	(lambda (x) (+ x n)))
+
+(function make-counter ()
+	(set count 0)
+	(lambda () (set count (+ count 1)) count))
+
+(set total 0)
+(for-range i 0 10000
+	(set add (make-adder i))
+	(set total (add total)))
+
+(set counter (make-counter))
+(for-range i 0 10000
+	(counter))
+
+(print-line total)
+(print-line (counter))
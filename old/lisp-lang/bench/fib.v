@@ -0,0 +1,9 @@
+|{ Doubly recursive Fibonacci: function calls and small integer arithmetic }|
+(include 'VyionLib.v)
+
+(function fib (n)
+	(if (< n 2)
+		n
+		(+ (fib (- n 1)) (fib (- n 2)))))
+
+(print-line (fib 23))
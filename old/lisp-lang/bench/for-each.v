@@ -0,0 +1,17 @@
+|{ Walking a large list many times with for-each }|
+(include 'VyionLib.v)
+
+(set numbers [])
+(for-range i 0 2000
+	(set numbers (insert numbers i 0)))
+
+(function sum (l)
+	(set s 0)
+	(for-each x l
+		(set s (+ s x)))
+	s)
+
+(set total 0)
+(for-range round 0 100
+	(set total (+ total (sum numbers))))
+(print-line total)
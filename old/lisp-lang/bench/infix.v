@@ -0,0 +1,7 @@
+|{ Arithmetic written as infix expressions, which are rewritten into calls by precedence }|
+(include 'VyionLib.v)
+
+(set acc 0)
+(for-range i 0 20000
+	(set acc {i * i + {i - 1} * 2 - acc + 7 - i}))
+(print-line acc)
@@ -0,0 +1,22 @@
+|{ While loops whose bodies are mostly macros, which are expanded each time they run }|
+(include 'VyionLib.v)
+
+(macro when (condition &(body))
+	[if $condition (tagbody (start $@body)) false!])
+
+(macro unless (condition &(body))
+	[if $condition false! (tagbody (start $@body))])
+
+(set i 0)
+(set j 10000)
+(set hits 0)
+(set misses 0)
+(while (< i 10000)
+	(when (< i j)
+		(inc hits))
+	(unless (< i j)
+		(inc misses))
+	(inc i)
+	(dec j))
+(print-line hits)
+(print-line misses)
@@ -0,0 +1,11 @@
+|{ The Takeuchi function: deep recursion with three arguments }|
+(include 'VyionLib.v)
+
+(function tak (x y z)
+	(if (not (< y x))
+		z
+		(tak (tak (- x 1) y z)
+		     (tak (- y 1) z x)
+		     (tak (- z 1) x y))))
+
+(print-line (tak 20 14 8))
@@ -0,0 +1,422 @@
+#include "Vyion.h"
+
+/* The heap analyzer reads a heap dump (see HeapDump.h), and shows what keeps the memory alive:
+ *     heapanalyzer [-n top] dump.vyheap
+ *
+ * An object dominates another if every path from the roots to the other goes through it, so the objects an
+ * object dominates are the ones which would go away with it: its retained size is theirs added up (its own
+ * included). The dominators are found with the iterative algorithm of Cooper, Harvey and Kennedy, over a graph
+ * with a root of its own which refers to all of the dump's roots.
+ *
+ * The report has the totals, the objects of each type, and the biggest retainers: the objects which only the
+ * root dominates (roots themselves, or objects shared by several roots), by retained size, each with the names
+ * of the roots holding it and what it retains by type. Objects which nothing refers to are counted separately,
+ * since the collector keeps every object it has, reachable or not.
+ */
+
+/* The names of the types of objects */
+char* typeNames[] = {"number", "function", "list", "symbol", "boolean", "macro", "error", "flow"};
+#define NUM_TYPES ((int) (sizeof(typeNames) / sizeof(char*)))
+
+/* The dump: the objects, with their references (those of object i are refs[refStart[i] .. refStart[i + 1] - 1]),
+ * and the roots. The extra node numObjects is the root of the graph, and refers to the roots. */
+typedef struct {
+	int numObjects;
+	unsigned char* types;
+	long* sizes;
+	long* refStart;
+	int* refs;
+
+	int numRoots;
+	int* rootObjects;
+	char** rootNames;
+} HeapGraph;
+
+/* Read a varint, returning 0 if the data ends first */
+int ReadVarint(unsigned char** data, unsigned char* end, unsigned long* num){
+	*num = 0;
+	int shift = 0;
+	while(*data < end && shift < 64){
+		unsigned char byte = *(*data)++;
+		*num |= (unsigned long) (byte & 0x7F) << shift;
+		if(!(byte & 0x80)){
+			return 1;
+		}
+		shift += 7;
+	}
+	return 0;
+}
+
+/* Read a dump into a graph, returning 0 if it isn't a dump this analyzer can read */
+int ReadHeapGraph(unsigned char* data, long length, HeapGraph* graph){
+	unsigned char* end = data + length;
+	char magic[8] = HEAP_DUMP_MAGIC;
+	if(length < 8 || memcmp(data, magic, 8) != 0){
+		return 0;
+	}
+	data += 8;
+
+	unsigned long version, numObjects, numRoots;
+	if(!ReadVarint(&data, end, &version) || version != HEAP_DUMP_VERSION || !ReadVarint(&data, end, &numObjects) ||
+			!ReadVarint(&data, end, &numRoots) || numObjects > INT_MAX || numRoots > INT_MAX){
+		return 0;
+	}
+	graph->numObjects = numObjects;
+	graph->numRoots = numRoots;
+
+	/* Each reference takes at least a byte of the dump, so there can't be more of them than bytes */
+	graph->types = malloc(numObjects + 1);
+	graph->sizes = malloc(sizeof(long) * (numObjects + 1));
+	graph->refStart = malloc(sizeof(long) * (numObjects + 2));
+	graph->refs = malloc(sizeof(int) * (length + numRoots + 1));
+
+	long numRefs = 0;
+	unsigned long i;
+	for(i = 0; i < numObjects; i++){
+		unsigned long size, numObjectRefs;
+		if(data >= end || *data >= NUM_TYPES){
+			return 0;
+		}
+		graph->types[i] = *data++;
+		if(!ReadVarint(&data, end, &size) || !ReadVarint(&data, end, &numObjectRefs) || numObjectRefs > end - data){
+			return 0;
+		}
+		graph->sizes[i] = size;
+		graph->refStart[i] = numRefs;
+
+		unsigned long j;
+		for(j = 0; j < numObjectRefs; j++){
+			unsigned long ref;
+			if(!ReadVarint(&data, end, &ref) || ref >= numObjects){
+				return 0;
+			}
+			graph->refs[numRefs++] = ref;
+		}
+	}
+
+	/* The root of the graph comes last, referring to the roots */
+	graph->refStart[numObjects] = numRefs;
+	graph->rootObjects = malloc(sizeof(int) * (numRoots + 1));
+	graph->rootNames = malloc(sizeof(char*) * (numRoots + 1));
+	for(i = 0; i < numRoots; i++){
+		unsigned long obj, nameLength;
+		if(!ReadVarint(&data, end, &obj) || obj >= numObjects || !ReadVarint(&data, end, &nameLength) ||
+				nameLength > end - data){
+			return 0;
+		}
+		graph->rootObjects[i] = obj;
+		graph->rootNames[i] = strndup((char*) data, nameLength);
+		data += nameLength;
+		graph->refs[numRefs++] = obj;
+	}
+	graph->refStart[numObjects + 1] = numRefs;
+
+	return 1;
+}
+
+/* Number the nodes reachable from the root in reverse postorder (order[i] is the ith node, and place[node] is
+ * its number, or -1 if it isn't reachable), returning how many there are */
+int OrderNodes(HeapGraph* graph, int* order, int* place){
+	int numNodes = graph->numObjects + 1;
+	int root = graph->numObjects;
+
+	/* An explicit stack of nodes and how far through their references the search is */
+	int* stack = malloc(sizeof(int) * numNodes);
+	long* next = malloc(sizeof(long) * numNodes);
+	char* seen = calloc(numNodes, 1);
+
+	int numOrdered = 0;
+	int depth = 0;
+	stack[depth] = root;
+	next[depth] = graph->refStart[root];
+	seen[root] = 1;
+
+	while(depth >= 0){
+		int node = stack[depth];
+		if(next[depth] < graph->refStart[node + 1]){
+			int ref = graph->refs[next[depth]++];
+			if(!seen[ref]){
+				seen[ref] = 1;
+				depth++;
+				stack[depth] = ref;
+				next[depth] = graph->refStart[ref];
+			}
+		}else{
+			/* Done with the node: it goes after everything it reaches */
+			order[numOrdered++] = node;
+			depth--;
+		}
+	}
+
+	/* Reverse the postorder */
+	int i;
+	for(i = 0; i < numOrdered / 2; i++){
+		int swap = order[i];
+		order[i] = order[numOrdered - 1 - i];
+		order[numOrdered - 1 - i] = swap;
+	}
+
+	for(i = 0; i < numNodes; i++){
+		place[i] = -1;
+	}
+	for(i = 0; i < numOrdered; i++){
+		place[order[i]] = i;
+	}
+
+	free(stack);
+	free(next);
+	free(seen);
+	return numOrdered;
+}
+
+/* Find the immediate dominator of each reachable node (the root is its own) */
+void FindDominators(HeapGraph* graph, int* order, int* place, int numOrdered, int* idom){
+	int numNodes = graph->numObjects + 1;
+
+	/* The references the other way around, between reachable nodes */
+	long* predStart = calloc(numNodes + 1, sizeof(long));
+	int node;
+	for(node = 0; node < numNodes; node++){
+		long i;
+		for(i = graph->refStart[node]; i < graph->refStart[node + 1] && place[node] >= 0; i++){
+			predStart[graph->refs[i] + 1]++;
+		}
+	}
+	for(node = 0; node < numNodes; node++){
+		predStart[node + 1] += predStart[node];
+	}
+
+	int* preds = malloc(sizeof(int) * (predStart[numNodes] + 1));
+	long* filled = malloc(sizeof(long) * numNodes);
+	memcpy(filled, predStart, sizeof(long) * numNodes);
+	for(node = 0; node < numNodes; node++){
+		long i;
+		for(i = graph->refStart[node]; i < graph->refStart[node + 1] && place[node] >= 0; i++){
+			preds[filled[graph->refs[i]]++] = node;
+		}
+	}
+	free(filled);
+
+	for(node = 0; node < numNodes; node++){
+		idom[node] = -1;
+	}
+	idom[order[0]] = order[0];
+
+	/* Improve the dominators until they stop changing, going through the nodes in reverse postorder */
+	int changed = 1;
+	while(changed){
+		changed = 0;
+
+		int i;
+		for(i = 1; i < numOrdered; i++){
+			int node = order[i];
+			int newIdom = -1;
+
+			long p;
+			for(p = predStart[node]; p < predStart[node + 1]; p++){
+				int pred = preds[p];
+				if(idom[pred] < 0){
+					continue;
+				}
+				if(newIdom < 0){
+					newIdom = pred;
+					continue;
+				}
+
+				/* Walk up from both to where their dominators meet */
+				int a = pred;
+				int b = newIdom;
+				while(a != b){
+					while(place[a] > place[b]){
+						a = idom[a];
+					}
+					while(place[b] > place[a]){
+						b = idom[b];
+					}
+				}
+				newIdom = a;
+			}
+
+			if(idom[node] != newIdom){
+				idom[node] = newIdom;
+				changed = 1;
+			}
+		}
+	}
+
+	free(predStart);
+	free(preds);
+}
+
+/* A retainer in the report */
+typedef struct {
+	int object;
+	long retained;
+	long retainedObjects;
+} Retainer;
+
+/* Compare retainers by their retained size (most first) */
+int CompareRetained(const void* a, const void* b){
+	long diff = ((Retainer*) b)->retained - ((Retainer*) a)->retained;
+	return (diff > 0) - (diff < 0);
+}
+
+int main(int argc, char** argv){
+	int top = 20;
+	int arg = 1;
+	if(arg + 1 < argc && strcmp(argv[arg], "-n") == 0){
+		top = atoi(argv[arg + 1]);
+		arg += 2;
+	}
+	if(arg + 1 != argc){
+		fprintf(stderr, "Usage: %s [-n top] dump.vyheap\n", argv[0]);
+		return 1;
+	}
+
+	/* Read the dump */
+	FILE* file = fopen(argv[arg], "rb");
+	if(file == NULL){
+		fprintf(stderr, "Couldn't open \"%s\".\n", argv[arg]);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char* data = malloc(length + 1);
+	if(fread(data, 1, length, file) != length){
+		fprintf(stderr, "Couldn't read \"%s\".\n", argv[arg]);
+		return 1;
+	}
+	fclose(file);
+
+	HeapGraph graph;
+	if(!ReadHeapGraph(data, length, &graph)){
+		fprintf(stderr, "\"%s\" is not a heap dump this analyzer can read.\n", argv[arg]);
+		return 1;
+	}
+	free(data);
+
+	int numObjects = graph.numObjects;
+	int root = numObjects;
+
+	/* Find the dominators, and add up what each node retains (children come after their dominators in reverse
+	 * postorder, so going backwards, each is done before it is added to its dominator) */
+	int* order = malloc(sizeof(int) * (numObjects + 1));
+	int* place = malloc(sizeof(int) * (numObjects + 1));
+	int numOrdered = OrderNodes(&graph, order, place);
+
+	int* idom = malloc(sizeof(int) * (numObjects + 1));
+	FindDominators(&graph, order, place, numOrdered, idom);
+
+	long* retained = calloc(numObjects + 1, sizeof(long));
+	long* retainedObjects = calloc(numObjects + 1, sizeof(long));
+	int i;
+	for(i = numOrdered - 1; i > 0; i--){
+		int node = order[i];
+		retained[node] += graph.sizes[node];
+		retainedObjects[node]++;
+		retained[idom[node]] += retained[node];
+		retainedObjects[idom[node]] += retainedObjects[node];
+	}
+
+	/* The totals, by type */
+	long typeObjects[NUM_TYPES] = {0};
+	long typeBytes[NUM_TYPES] = {0};
+	long totalBytes = 0;
+	long unreachableObjects = 0;
+	long unreachableBytes = 0;
+	for(i = 0; i < numObjects; i++){
+		typeObjects[graph.types[i]]++;
+		typeBytes[graph.types[i]] += graph.sizes[i];
+		totalBytes += graph.sizes[i];
+		if(place[i] < 0){
+			unreachableObjects++;
+			unreachableBytes += graph.sizes[i];
+		}
+	}
+
+	printf("Heap dump: %d objects, %ld bytes, %d roots\n", numObjects, totalBytes, graph.numRoots);
+	printf("Reachable: %ld objects, %ld bytes\n", retainedObjects[root], retained[root]);
+	printf("Unreachable (still on the heap): %ld objects, %ld bytes\n\n", unreachableObjects, unreachableBytes);
+
+	printf("%-10s %12s %14s\n", "type", "objects", "bytes");
+	int type;
+	for(type = 0; type < NUM_TYPES; type++){
+		if(typeObjects[type] > 0){
+			printf("%-10s %12ld %14ld\n", typeNames[type], typeObjects[type], typeBytes[type]);
+		}
+	}
+
+	/* The biggest retainers: the objects only the root dominates */
+	Retainer* retainers = malloc(sizeof(Retainer) * (numObjects + 1));
+	int numRetainers = 0;
+	for(i = 1; i < numOrdered; i++){
+		int node = order[i];
+		if(idom[node] == root){
+			retainers[numRetainers].object = node;
+			retainers[numRetainers].retained = retained[node];
+			retainers[numRetainers].retainedObjects = retainedObjects[node];
+			numRetainers++;
+		}
+	}
+	qsort(retainers, numRetainers, sizeof(Retainer), &CompareRetained);
+	if(numRetainers > top){
+		numRetainers = top;
+	}
+
+	/* Find which of them each reachable object is retained by (dominators come first in reverse postorder), and
+	 * count what each of them retains by type */
+	int* retainerOf = malloc(sizeof(int) * (numObjects + 1));
+	for(i = 0; i <= numObjects; i++){
+		retainerOf[i] = -1;
+	}
+	for(i = 0; i < numRetainers; i++){
+		retainerOf[retainers[i].object] = i;
+	}
+	long* retainedByType = calloc((long) (numRetainers + 1) * NUM_TYPES, sizeof(long));
+	for(i = 1; i < numOrdered; i++){
+		int node = order[i];
+		if(retainerOf[node] < 0 && idom[node] != root){
+			retainerOf[node] = retainerOf[idom[node]];
+		}
+		if(retainerOf[node] >= 0){
+			retainedByType[retainerOf[node] * NUM_TYPES + graph.types[node]]++;
+		}
+	}
+
+	printf("\nBiggest retainers:\n");
+	printf("%14s %7s %12s %10s  %-9s %s\n", "retained", "bytes%", "objects", "id", "type", "held by");
+	for(i = 0; i < numRetainers; i++){
+		Retainer* r = &retainers[i];
+		printf("%14ld %6.2f%% %12ld %10d  %-9s ", r->retained, 100.0 * r->retained / (totalBytes > 0 ? totalBytes : 1),
+				r->retainedObjects, r->object, typeNames[graph.types[r->object]]);
+
+		/* The roots holding it (or, if it isn't one, the fact that it is shared) */
+		int named = 0;
+		int j;
+		for(j = 0; j < graph.numRoots; j++){
+			if(graph.rootObjects[j] == r->object){
+				if(named < 3){
+					printf("%s%s", (named > 0) ? ", " : "", graph.rootNames[j]);
+				}
+				named++;
+			}
+		}
+		if(named > 3){
+			printf(" and %d more", named - 3);
+		}
+		if(named == 0){
+			printf("[shared by several roots]");
+		}
+
+		printf("\n%14s retains:", "");
+		for(type = 0; type < NUM_TYPES; type++){
+			if(retainedByType[i * NUM_TYPES + type] > 0){
+				printf(" %s %ld", typeNames[type], retainedByType[i * NUM_TYPES + type]);
+			}
+		}
+		printf("\n");
+	}
+
+	return 0;
+}